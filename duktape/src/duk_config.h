@@ -2968,7 +2968,12 @@ typedef struct duk_hthread duk_context;
 #undef DUK_USE_EXPLICIT_NULL_INIT
 #undef DUK_USE_EXTSTR_FREE
 #undef DUK_USE_EXTSTR_INTERN_CHECK
+/* Enabled by building dukpp-03 with DUKPP03_FASTINT */
+#if defined(DUKPP03_FASTINT)
+#define DUK_USE_FASTINT
+#else
 #undef DUK_USE_FASTINT
+#endif
 #define DUK_USE_FAST_REFCOUNT_DEFAULT
 #undef DUK_USE_FATAL_HANDLER
 #define DUK_USE_FATAL_MAXLEN 128
@@ -3015,7 +3020,7 @@ typedef struct duk_hthread duk_context;
 #define DUK_USE_JSON_EATWHITE_FASTPATH
 #define DUK_USE_JSON_ENC_RECLIMIT 1000
 #define DUK_USE_JSON_QUOTESTRING_FASTPATH
-#undef DUK_USE_JSON_STRINGIFY_FASTPATH
+#define DUK_USE_JSON_STRINGIFY_FASTPATH
 #define DUK_USE_JSON_SUPPORT
 #define DUK_USE_JX
 #define DUK_USE_LEXER_SLIDING_WINDOW
@@ -4,21 +4,79 @@
  */
 #pragma once
 #include "errorcodes.h"
+#include "pinnedvalue.h"
+#include "scriptcache.h"
+#include "bundle.h"
+#include "allocator.h"
+#include "watchdog.h"
+#include "cancellationtoken.h"
+#include "overloadcache.h"
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+
+/*! A property, where located pointer to callable in wrapper
+ */
+#define DUKPP03_NATIVE_FUNCTION_SIGNATURE_PROPERTY "\1_____native_signature\1"
+/*! A property name for an object, which must have this property set to a handle of variant in registry of context.
+    It's a hidden symbol, so scripts could not read or overwrite it
+ */
+#define DUKPP03_VARIANT_PROPERTY_SIGNATURE DUK_HIDDEN_SYMBOL("dukpp03::Variant")
+/*! A property name for an object, which contains pointer to dukpp03::JSObject
+ */
+#define DUKPP03_JSOBJECT_POINTER_SIGNATURE "\1dukpp03::JSObject<_Context>\1"
+/*! A property name for an ArrayBuffer, which contains pointer to dukpp03::ExternalBuffer, owned by heap
+ */
+#define DUKPP03_EXTERNAL_BUFFER_SIGNATURE DUK_HIDDEN_SYMBOL("dukpp03::ExternalBuffer")
 
 namespace dukpp03
 {
 
 class AbstractCallable;
+class ExternalBuffer;
 
 /*! A wapper for basic context for data
  */
 class AbstractContext
 {
 public:
+    /*! An amount of bytecode instructions, executed by Duktape between checks of timeout. Budget
+        in instructions is checked with this granularity
+     */
+    static const unsigned long long InstructionsPerCheck = 256 * 1024;
+    /*! A handle of property key, interned in heap of context
+     */
+    typedef size_t PropertyKey;
+    /*! An identifier of set of keys, cached in context for owner, like class binding. Identifiers are never
+        reused, so set of destroyed or changed owner is never returned for other owner
+     */
+    typedef unsigned long long KeySetId;
+    /*! An identifier of cache of overloads for state of multi-method. Identifiers are never reused, so
+        cache of destroyed or changed multi-method is never returned for other multi-method
+     */
+    typedef unsigned long long OverloadCacheId;
+    /*! A key for DUKPP03_NATIVE_FUNCTION_SIGNATURE_PROPERTY
+     */
+    static const PropertyKey NativeFunctionKey = 0;
+    /*! A key for DUKPP03_VARIANT_PROPERTY_SIGNATURE
+     */
+    static const PropertyKey VariantKey = 1;
+    /*! A key for DUKPP03_JSOBJECT_POINTER_SIGNATURE
+     */
+    static const PropertyKey JSObjectKey = 2;
+    /*! A key for DUKPP03_EXTERNAL_BUFFER_SIGNATURE
+     */
+    static const PropertyKey ExternalBufferKey = 3;
+    /*! A maximal amount of callables in table of context. Index of callable in table is stored in magic
+        of native function, which is 16-bit, so callables, pushed after table is full, are stored in property
+     */
+    static const size_t MaximalCallableTableSize = 32767;
     /*! Constructs new basic context
+        \param[in] allocator an allocator for heap. If nullptr, default Duktape allocation is used.
+                   Allocator is not owned by context and must outlive it
      */
-    AbstractContext();
+    AbstractContext(dukpp03::Allocator* allocator = nullptr);
     /*! Can be inherited
      */
     virtual ~AbstractContext();
@@ -27,6 +85,11 @@ public:
         \return context
      */
     static dukpp03::AbstractContext* getContext(duk_context* ctx);
+    /*! Returns true, if Duktape is built with fast integers (DUK_USE_FASTINT), i.e. library is
+        configured with DUKPP03_FASTINT option
+        \return whether fast integers are used
+     */
+    static bool usesFastIntegers();
     /*! Evals string, with code in it. If no error occured, result is not popped
         out from stack, since we still may need it
         \param[in] string a string
@@ -36,7 +99,8 @@ public:
      */
     bool eval(const std::string& string, bool clean_heap = true,std::string* error = nullptr);
     /*! Evals string, with code in it. If no error occured, result is not popped
-        out from stack, since we still may need it
+        out from stack, since we still may need it. Compiled code is cached in script cache,
+        so evaluating the same code with the same file name again will not compile it
         \param[in] string a string
 		\param[in] filename a file name
         \param[in] clean_heap whether heap should be cleaned after execution. If provided, result is popped from stack
@@ -44,6 +108,28 @@ public:
         \return true if no error
      */
     bool eval(const std::string& string, const std::string& filename, bool clean_heap = true,std::string* error = nullptr);	
+    /*! Loads bundle of precompiled scripts, running all scripts from it in order. Since scripts are
+        not parsed, this is faster than evaluating sources. See dukpp03::Bundle for details on format
+        \param[in] path a path to bundle
+        \param[out] error a string, where error should be written
+        \return true if no error
+     */
+    bool loadBundle(const std::string& path, std::string* error = nullptr);
+    /*! Runs precompiled program, using global object as this. See dukpp03::Bundle::compile for compiling programs
+        \param[in] bytecode a bytecode of program
+        \param[in] name a name of program, used in error messages
+        \param[out] error a string, where error should be written
+        \return true if no error
+     */
+    bool runBytecode(const std::vector<unsigned char>& bytecode, const std::string& name, std::string* error = nullptr);
+    /*! Calls function with arguments on stack in protected mode, like duk_pcall, but within budget
+        of context (maximal execution time, maximal amount of instructions and cancellation token).
+        If context is not already evaluating, budget is started for this call, otherwise call is
+        bounded by budget of outer evaluation
+        \param[in] nargs amount of arguments on stack, placed after function
+        \return DUK_EXEC_SUCCESS, if call succeeded, DUK_EXEC_ERROR otherwise. Result or error is left on stack
+     */
+    duk_int_t pcall(duk_idx_t nargs);
     /*! Throws error from a context
         \param[in] error_string string data for error
         \param[in] code error codes
@@ -61,10 +147,38 @@ public:
         \return context data
      */
     virtual duk_context* context();
-    /*! Checks, whether timeout is reached for context. Called, while
-        evaluating value
+    /*! Checks, whether timeout is reached for context or evaluation is cancelled. Called, while
+        evaluating value. If watchdog is set, only reads flag, raised by watchdog,
+        otherwise reads timer of context
      */
     bool timeoutReached() const;
+    /*! Sets maximal amount of bytecode instructions for each evaluation or call. Amount is
+        checked every InstructionsPerCheck instructions, so it's rounded up to multiple of it
+        \param[in] count amount of instructions. Zero means no limit
+     */
+    void setMaximumInstructions(unsigned long long count);
+    /*! Returns maximal amount of bytecode instructions for each evaluation or call
+        \return amount of instructions or zero if there is no limit
+     */
+    unsigned long long maximumInstructions() const;
+    /*! Sets token, which could be used to cancel evaluations of context from other threads
+        \param[in] token a token. Token is not owned by context and must outlive it. If nullptr, evaluations could not be cancelled
+     */
+    void setCancellationToken(dukpp03::CancellationToken* token);
+    /*! Returns token, used to cancel evaluations of context
+        \return token or nullptr
+     */
+    dukpp03::CancellationToken* cancellationToken() const;
+    /*! Sets watchdog, which tracks maximal execution time instead of timer of context, so checking
+        for timeout becomes much cheaper. Must not be changed, while evaluating
+        \param[in] watchdog a watchdog, e.g. dukpp03::Watchdog::shared(). If nullptr, timer is used.
+                   Watchdog is not owned by context and must outlive it
+     */
+    void setWatchdog(dukpp03::Watchdog* watchdog);
+    /*! Returns watchdog, used for tracking maximal execution time
+        \return watchdog or nullptr, if timer of context is used
+     */
+    dukpp03::Watchdog* watchdog() const;
     /*! Sets maximal execution time for a script
         \param[in] time maximal execution time
      */
@@ -112,16 +226,186 @@ public:
         \param[in] as_attribute push as attribute getter (adds additional pop in wrapper)
      */
     void pushCallable(dukpp03::AbstractCallable* callable, bool own = true, bool as_attribute = false);
+    /*! Returns callable of currently running native function, pushed via pushCallable
+        \param[in] ctx context or thread of context
+        \return callable
+     */
+    void* currentCallable(duk_context* ctx);
+    /*! Returns amount of callables in table of context
+        \return amount of callables
+     */
+    size_t callableTableSize() const;
+    /*! Removes callable from table of context, so it could be destroyed. Slot of callable is not reused,
+        so native functions, which still refer to it, throw an error instead of calling other callable.
+        Must be called for callables, not owned by context, when they are destroyed before context
+        \param[in] callable a callable
+     */
+    void forgetCallable(dukpp03::AbstractCallable* callable);
+    /*! Sets currently called function as prototype for object on top of stack, unless it's already
+        in prototype chain of object (e.g. object was wrapped with shared prototype of class binding).
+        Used in constructors
+     */
+    void setCurrentFunctionAsPrototype();
+    /*! Stores value at specified position of stack in heap stash, so it won't be collected,
+        and returns handle for it. Caller owns one reference to handle and must release it via delRef
+        \param[in] pos a position of value on stack
+        \return handle for value
+     */
+    dukpp03::PinnedValue* pin(duk_idx_t pos);
+    /*! Detaches released handle from context. Called by handle with dukpp03::PinnedValue::mutex locked,
+        so it could be called from any thread. Value is removed from heap stash on next pin or evaluation
+        \param[in] v handle
+     */
+    void unpin(dukpp03::PinnedValue* v);
+    /*! Saves current state of global object, so it could be restored via restoreGlobalState.
+        Only descriptors of own properties of global object are saved, objects, referenced by them are not copied
+     */
+    void saveGlobalState();
+    /*! Restores own properties of global object to state, saved by saveGlobalState. Properties, which were added
+        after saving, are removed, changed properties get their saved values and attributes, removed properties
+        are added back. Only descriptors are compared, so accessors are never invoked, and restoring runs within
+        budget of context. Fails, if Object.prototype defines fields of descriptors, since Duktape would invoke them
+        \param[out] error a string, where error should be written
+        \return true if no error
+     */
+    bool restoreGlobalState(std::string* error = nullptr);
+    /*! Returns allocator, used by heap of context
+        \return allocator or nullptr, if default Duktape allocation is used
+     */
+    dukpp03::Allocator* allocator() const;
+    /*! Returns cache of compiled scripts, used by eval with file name
+        \return script cache
+     */
+    dukpp03::ScriptCache& scriptCache();
+    /*! Interns property key in heap of context, pinning it in heap stash. Key is interned again, when heap
+        is recreated by reset, so handle stays valid for lifetime of context. Interning the same name twice
+        returns the same handle. Owners, which intern several names on every use, should cache them via internKeySet
+        \param[in] name a name of property
+        \return handle of key
+     */
+    dukpp03::AbstractContext::PropertyKey internKey(const std::string& name);
+    /*! Returns new identifier for set of keys. Could be called from any thread
+        \return identifier, which is never returned again
+     */
+    static dukpp03::AbstractContext::KeySetId newKeySet();
+    /*! Returns set of keys, cached in context
+        \param[in] id an identifier of set
+        \return keys or nullptr if set is not cached yet
+     */
+    const std::vector<dukpp03::AbstractContext::PropertyKey>* keySet(dukpp03::AbstractContext::KeySetId id) const;
+    /*! Interns names and caches handles as set of keys. Sets live as long as context, like keys
+        \param[in] id an identifier of set
+        \param[in] names names of keys
+        \return keys in order of names
+     */
+    const std::vector<dukpp03::AbstractContext::PropertyKey>& internKeySet(dukpp03::AbstractContext::KeySetId id, const std::vector<std::string>& names);
+    /*! Returns new identifier for cache of overloads. Could be called from any thread
+        \return identifier, which is never returned again
+     */
+    static dukpp03::AbstractContext::OverloadCacheId newOverloadCache();
+    /*! Returns cache of overloads, kept in context, creating it if needed. Caches are dropped, when heap is recreated
+        \param[in] id an identifier of cache
+        \return cache
+     */
+    dukpp03::OverloadCache& overloadCache(dukpp03::AbstractContext::OverloadCacheId id);
+    /*! Returns amount of interned keys
+        \return amount of keys
+     */
+    size_t keyCount() const;
+    /*! Pushes interned key on stack
+        \param[in] key a handle of key
+     */
+    void pushKey(dukpp03::AbstractContext::PropertyKey key) const;
+    /*! Pushes value of property of object on stack
+        \param[in] ctx context or thread of context
+        \param[in] obj an index of object on stack
+        \param[in] key a handle of key
+        \return whether property exists. If not, undefined is pushed
+     */
+    bool getProperty(duk_context* ctx, duk_idx_t obj, dukpp03::AbstractContext::PropertyKey key) const;
+    /*! Sets property of object to value on top of stack, popping value
+        \param[in] obj an index of object on stack
+        \param[in] key a handle of key
+     */
+    void putProperty(duk_idx_t obj, dukpp03::AbstractContext::PropertyKey key) const;
+    /*! Sets property of object to value on top of stack, popping value
+        \param[in] ctx context or thread of context
+        \param[in] obj an index of object on stack
+        \param[in] key a handle of key
+     */
+    void putProperty(duk_context* ctx, duk_idx_t obj, dukpp03::AbstractContext::PropertyKey key) const;
+    /*! Pushes memory block, owned by C++ code, as ArrayBuffer or view of it without copying. Heap takes ownership
+        of buffer and deletes it, when ArrayBuffer and all views of it are collected
+        \param[in] buffer a buffer
+        \param[in] type a type of pushed object, one of DUK_BUFOBJ_* constants. Size of buffer must be
+                   multiple of size of element
+     */
+    void pushExternalBuffer(dukpp03::ExternalBuffer* buffer, duk_uint_t type = DUK_BUFOBJ_UINT8ARRAY);
+    /*! Decodes JSON text with native decoder of Duktape and pushes result on stack
+        \param[in] data a text
+        \param[in] size a size of text
+        \param[out] error an error, if decoding failed
+        \return true on success. On failure nothing is pushed
+     */
+    bool decodeJSON(const char* data, size_t size, std::string* error = nullptr);
+    /*! Decodes CBOR data with native decoder of Duktape and pushes result on stack. Data is read in place
+        \param[in] data a data
+        \param[in] size a size of data
+        \param[out] error an error, if decoding failed
+        \return true on success. On failure nothing is pushed
+     */
+    bool decodeCBOR(const unsigned char* data, size_t size, std::string* error = nullptr);
+    /*! Encodes value on stack as JSON with native encoder of Duktape. Stack is left intact
+        \param[in] pos a position of value on stack
+        \param[out] result a text
+        \param[out] error an error, if encoding failed or value could not be represented as JSON
+        \return true on success
+     */
+    bool encodeJSON(duk_idx_t pos, std::string& result, std::string* error = nullptr);
+    /*! Encodes value on stack as CBOR with native encoder of Duktape. Stack is left intact
+        \param[in] pos a position of value on stack
+        \param[out] result a data
+        \param[out] error an error, if encoding failed
+        \return true on success
+     */
+    bool encodeCBOR(duk_idx_t pos, std::vector<unsigned char>& result, std::string* error = nullptr);
+    /*! Returns whether value of argument, not only it's type, affected conversion since flag was reset.
+        Multi-methods use it to decide, whether overload, resolved for types of arguments, could be cached
+        \return whether conversion depended on value
+     */
+    bool valueDependentMatch() const;
+    /*! Sets flag, telling whether value of argument affected conversion. Conversions, which accept only
+        some values of type, like characters, read from strings of length 1, raise it
+        \param[in] value a value of flag
+     */
+    void setValueDependentMatch(bool value);
 protected:
+    /*! Detaches all handles of pinned values. Must be called before heap is destroyed
+     */
+    void detachPinnedValues();
     /*! Registers callable as property of global object
         \param[in] callable_name name of property of global object
         \param[in] callable a callable object
         \param[in] own whether context will own callable
      */
     void registerCallable(const std::string& callable_name, dukpp03::AbstractCallable* callable, bool own = true);    
+    /*! Creates new heap for context, using allocator of context, and interns keys in it
+     */
+    void createHeap();
+    /*! Marks context as running and starts budget of evaluation, unless context is already running
+     */
+    void beginEvaluation();
+    /*! Marks context as not running and stops budget of evaluation, when outermost evaluation ends
+     */
+    void endEvaluation();
     /*! Inits context for evaluating
      */
     virtual void initContextBeforeAccessing();
+    /*! Creates new prototype object for native function on top of stack, which inherits Function.prototype,
+        and sets it as prototype and "prototype" property of function. Prototype is unique for each function,
+        so extending prototype of one function does not affect others
+     */
+    void initFunctionPrototype();
     /*! Starts evaluating object, needed for data
      */
     virtual void startEvaluating() = 0;
@@ -141,7 +425,79 @@ protected:
     /*! Whether execution is running
      */ 
     bool m_running;
+    /*! A depth of nested evaluations and calls
+     */
+    int m_evaluation_depth;
+    /*! A maximal amount of instructions for evaluation
+     */
+    unsigned long long m_maximal_instructions;
+    /*! An amount of checks of timeout, performed since start of evaluation
+     */
+    mutable unsigned long long m_timeout_checks;
+    /*! A token for cancelling evaluations
+     */
+    dukpp03::CancellationToken* m_cancellation_token;
+    /*! Handles for values, pinned in heap stash
+     */
+    std::vector<dukpp03::PinnedValue*> m_pinned_values;
+    /*! An index for next pinned value in heap stash
+     */
+    duk_uarridx_t m_pinned_value_index;
+    /*! Indexes of values in heap stash, whose handles were released, but values were not removed yet
+     */
+    std::vector<duk_uarridx_t> m_released_pinned_values;
+    /*! Whether there are values, which should be removed from heap stash
+     */
+    std::atomic<bool> m_has_released_pinned_values;
+    /*! A cache of compiled scripts
+     */
+    dukpp03::ScriptCache m_script_cache;
+    /*! An allocator for heap
+     */
+    dukpp03::Allocator* m_allocator;
+    /*! A watchdog for tracking maximal execution time
+     */
+    dukpp03::Watchdog* m_watchdog;
+    /*! A flag, raised by watchdog, when maximal execution time is exceeded
+     */
+    std::atomic<bool> m_deadline_expired;
+    /*! Names of interned keys
+     */
+    std::vector<std::string> m_key_names;
+    /*! Interned keys as heap pointers to strings, pinned in heap stash
+     */
+    std::vector<void*> m_keys;
+    /*! Handles of interned keys by names
+     */
+    std::unordered_map<std::string, dukpp03::AbstractContext::PropertyKey> m_key_indexes;
+    /*! Sets of keys, cached for owners
+     */
+    std::unordered_map<dukpp03::AbstractContext::KeySetId, std::vector<dukpp03::AbstractContext::PropertyKey> > m_key_sets;
+    /*! A table of callables, pushed to heap. Native functions refer to callables by index in table, stored in magic
+     */
+    std::vector<dukpp03::AbstractCallable*> m_callables;
+    /*! Indexes of callables in table plus one, used to push same callable again without adding it to table
+     */
+    std::unordered_map<dukpp03::AbstractCallable*, duk_int_t> m_callable_magics;
+    /*! Caches of overloads, resolved by multi-methods, called in context
+     */
+    std::unordered_map<dukpp03::AbstractContext::OverloadCacheId, dukpp03::OverloadCache> m_overload_caches;
+    /*! Whether value of argument affected conversion since flag was reset
+     */
+    bool m_value_dependent_match;
 private:
+    /*! Returns magic of native function for callable, adding callable to table of context if needed
+        \param[in] callable a callable
+        \return index of callable in table plus one or zero if table is full
+     */
+    duk_int_t callableMagic(dukpp03::AbstractCallable* callable);
+    /*! Interns key in current heap, storing it in heap stash
+        \param[in] key a handle of key
+     */
+    void internKeyInHeap(dukpp03::AbstractContext::PropertyKey key);
+    /*! Removes values of released handles from heap stash
+     */
+    void removeReleasedPinnedValues();
     /*! This object is non-copyable
         \param[in] p context
      */
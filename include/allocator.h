@@ -0,0 +1,267 @@
+/*! \file allocator.h
+
+    Defines allocators, which could be used by context for allocating memory for Duktape heap
+ */
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <atomic>
+
+namespace dukpp03
+{
+
+/*! An allocator for Duktape heap. Pass it into constructor of context to replace default
+    malloc-based allocation. Allocator must outlive all contexts, which use it, and must not be
+    shared between contexts, used in different threads at the same time, unless it's thread-safe
+ */
+class Allocator
+{
+public:
+    /*! Allocates memory
+        \param[in] size a size of memory block
+        \return memory block or nullptr on failure
+     */
+    virtual void* allocate(size_t size) = 0;
+    /*! Reallocates memory block, preserving it's content
+        \param[in] ptr memory block or nullptr, in which case memory is allocated
+        \param[in] size a new size of memory block. If zero, block is freed and nullptr is returned
+        \return memory block or nullptr on failure, in which case old block is left intact
+     */
+    virtual void* reallocate(void* ptr, size_t size) = 0;
+    /*! Frees memory block
+        \param[in] ptr memory block or nullptr
+     */
+    virtual void free(void* ptr) = 0;
+    /*! Could be inherited
+     */
+    virtual ~Allocator();
+};
+
+/*! An allocator, which serves small blocks from free lists of fixed size classes, allocated in slabs.
+    Slabs are allocated on demand, so pool grows with heap and never runs out, and are freed only when
+    allocator is destroyed. Blocks bigger, than largest size class are allocated via malloc.
+
+    Allocator is not thread-safe and is intended to be used by single context, so heap allocations never
+    contend with other threads on global malloc lock. Since context could be moved between threads
+    (see dukpp03::ContextPool and dukpp03::ScriptExecutor), pool belongs to context, not to thread.
+ */
+class PoolAllocator: public dukpp03::Allocator
+{
+public:
+    /*! A default size of slab
+     */
+    static const size_t DefaultSlabSize = 64 * 1024;
+    /*! An amount of size classes
+     */
+    static const size_t ClassCount = 12;
+    /*! A size of largest class. Bigger blocks are allocated via malloc
+     */
+    static const size_t MaximalClassSize = 1024;
+    /*! Constructs new pool
+        \param[in] slab_size a size of slab, allocated when size class runs out of free blocks
+     */
+    PoolAllocator(size_t slab_size = dukpp03::PoolAllocator::DefaultSlabSize);
+    /*! Frees all slabs
+     */
+    virtual ~PoolAllocator() override;
+    /*! Allocates memory
+        \param[in] size a size of memory block
+        \return memory block or nullptr on failure
+     */
+    virtual void* allocate(size_t size) override;
+    /*! Reallocates memory block, preserving it's content
+        \param[in] ptr memory block or nullptr, in which case memory is allocated
+        \param[in] size a new size of memory block. If zero, block is freed and nullptr is returned
+        \return memory block or nullptr on failure, in which case old block is left intact
+     */
+    virtual void* reallocate(void* ptr, size_t size) override;
+    /*! Frees memory block
+        \param[in] ptr memory block or nullptr
+     */
+    virtual void free(void* ptr) override;
+    /*! Returns amount of allocated slabs
+        \return amount of slabs
+     */
+    size_t slabCount() const;
+    /*! Returns size of slab
+        \return size of slab
+     */
+    size_t slabSize() const;
+private:
+    /*! A pool is non-copyable
+        \param[in] o other pool
+     */
+    PoolAllocator(const dukpp03::PoolAllocator& o);
+    /*! A pool is non-copyable
+        \param[in] o other pool
+        \return self-reference
+     */
+    dukpp03::PoolAllocator& operator=(const dukpp03::PoolAllocator& o);
+    /*! Returns size class for size of block
+        \param[in] size a size of block
+        \return index of class or ClassCount if block should be allocated via malloc
+     */
+    static size_t sizeClass(size_t size);
+    /*! Returns usable size of block
+        \param[in] ptr block
+        \return size of block
+     */
+    static size_t usableSize(void* ptr);
+    /*! Allocates new slab for size class and puts it's blocks into free list
+        \param[in] index an index of class
+        \return true on success
+     */
+    bool grow(size_t index);
+    /*! A size of slab
+     */
+    size_t m_slab_size;
+    /*! Heads of free lists for each size class
+     */
+    void* m_free[dukpp03::PoolAllocator::ClassCount];
+    /*! Allocated slabs
+     */
+    std::vector<void*> m_slabs;
+};
+
+/*! An allocator, which tracks memory usage of heap and enforces limits on it. Wraps other allocator
+    or malloc, if none given. Use one accounting allocator per context to get per-context counters.
+
+    When allocation would exceed hard limit, it fails, so Duktape collects garbage, retries it and throws
+    error, if memory still could not be allocated. When allocation would exceed soft limit, it fails once,
+    so Duktape runs mark-and-sweep before retrying it. Soft limit is rearmed, when usage drops below it again.
+
+    Counters are updated only by thread, running context, but could be read from any thread, e.g. for
+    exporting metrics.
+ */
+class AccountingAllocator: public dukpp03::Allocator
+{
+public:
+    /*! A size of header of each block, containing size of block
+     */
+    static const size_t HeaderSize = 16;
+    /*! Constructs new allocator without limits
+        \param[in] allocator an underlying allocator. If nullptr, malloc is used. Not owned by allocator
+     */
+    AccountingAllocator(dukpp03::Allocator* allocator = nullptr);
+    /*! Could be inherited
+     */
+    virtual ~AccountingAllocator() override;
+    /*! Allocates memory
+        \param[in] size a size of memory block
+        \return memory block or nullptr on failure or if limit is reached
+     */
+    virtual void* allocate(size_t size) override;
+    /*! Reallocates memory block, preserving it's content
+        \param[in] ptr memory block or nullptr, in which case memory is allocated
+        \param[in] size a new size of memory block. If zero, block is freed and nullptr is returned
+        \return memory block or nullptr on failure or if limit is reached, in which case old block is left intact
+     */
+    virtual void* reallocate(void* ptr, size_t size) override;
+    /*! Frees memory block
+        \param[in] ptr memory block or nullptr
+     */
+    virtual void free(void* ptr) override;
+    /*! Sets hard limit for memory usage
+        \param[in] limit a limit in bytes. Zero means no limit
+     */
+    void setHardLimit(size_t limit);
+    /*! Returns hard limit for memory usage
+        \return limit in bytes or zero if there is no limit
+     */
+    size_t hardLimit() const;
+    /*! Sets soft limit for memory usage, which triggers garbage collection
+        \param[in] limit a limit in bytes. Zero means no limit
+     */
+    void setSoftLimit(size_t limit);
+    /*! Returns soft limit for memory usage
+        \return limit in bytes or zero if there is no limit
+     */
+    size_t softLimit() const;
+    /*! Returns amount of bytes, currently allocated by heap, not including headers of blocks
+        \return amount of bytes
+     */
+    size_t liveBytes() const;
+    /*! Returns maximal amount of bytes, allocated by heap since creation of allocator or last call of resetPeak
+        \return amount of bytes
+     */
+    size_t peakBytes() const;
+    /*! Resets peak amount of bytes to current amount
+     */
+    void resetPeak();
+    /*! Returns total amount of bytes, requested by allocations and growing reallocations since creation
+        of allocator. Never decreases, so difference between two readings is allocation volume between them
+        \return amount of bytes
+     */
+    unsigned long long allocatedBytes() const;
+    /*! Returns amount of currently allocated blocks
+        \return amount of blocks
+     */
+    size_t liveBlocks() const;
+    /*! Returns total amount of successful allocations, including reallocations
+        \return amount of allocations
+     */
+    unsigned long long allocations() const;
+    /*! Returns amount of allocations, failed because of hard limit or underlying allocator
+        \return amount of failures
+     */
+    unsigned long long failures() const;
+    /*! Returns amount of garbage collections, triggered by soft limit
+        \return amount of collections
+     */
+    unsigned long long softCollections() const;
+private:
+    /*! An allocator is non-copyable
+        \param[in] o other allocator
+     */
+    AccountingAllocator(const dukpp03::AccountingAllocator& o);
+    /*! An allocator is non-copyable
+        \param[in] o other allocator
+        \return self-reference
+     */
+    dukpp03::AccountingAllocator& operator=(const dukpp03::AccountingAllocator& o);
+    /*! Checks, whether usage could grow by specified amount of bytes
+        \param[in] growth an amount of bytes
+        \return true if allocation should proceed
+     */
+    bool admit(size_t growth);
+    /*! Sets amount of live bytes, updating peak
+        \param[in] live new amount of live bytes
+     */
+    void setLive(size_t live);
+    /*! An underlying allocator
+     */
+    dukpp03::Allocator* m_allocator;
+    /*! A hard limit
+     */
+    std::atomic<size_t> m_hard_limit;
+    /*! A soft limit
+     */
+    std::atomic<size_t> m_soft_limit;
+    /*! Whether soft limit will trigger collection, when exceeded. Rearmed only by allocation, which
+        fits into soft limit, so retry of allocation after collection never triggers it again
+     */
+    bool m_soft_armed;
+    /*! An amount of live bytes
+     */
+    std::atomic<size_t> m_live_bytes;
+    /*! A peak amount of live bytes
+     */
+    std::atomic<size_t> m_peak_bytes;
+    /*! A total amount of allocated bytes
+     */
+    std::atomic<unsigned long long> m_allocated_bytes;
+    /*! An amount of live blocks
+     */
+    std::atomic<size_t> m_live_blocks;
+    /*! An amount of allocations
+     */
+    std::atomic<unsigned long long> m_allocations;
+    /*! An amount of failed allocations
+     */
+    std::atomic<unsigned long long> m_failures;
+    /*! An amount of collections, triggered by soft limit
+     */
+    std::atomic<unsigned long long> m_soft_collections;
+};
+
+}
@@ -0,0 +1,279 @@
+/*! \file bufferview.h
+
+    Defines a view of binary data of ArrayBuffer, typed array or plain buffer, which could be
+    taken as argument of function without copying data
+ */
+#pragma once
+#include "duk_custom.h"
+#include "../duktape/src/duktape.h"
+#include "maybe.h"
+#include "externalbuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace dukpp03
+{
+
+template<
+    typename _Value,
+    typename _Context
+>
+class PushValue;
+
+template<
+    typename _Value,
+    typename _Context
+>
+class GetValue;
+
+/*! A type of typed array, which is pushed for elements of specified type
+ */
+template<
+    typename _Element
+>
+struct TypedArrayType
+{
+
+};
+
+/*! Bytes are pushed as Uint8Array
+ */
+template<>
+struct TypedArrayType<char>
+{
+    /*! A type of array as DUK_BUFOBJ_* constant
+     */
+    static const duk_uint_t Type = DUK_BUFOBJ_UINT8ARRAY;
+};
+
+template<>
+struct TypedArrayType<unsigned char>
+{
+    static const duk_uint_t Type = DUK_BUFOBJ_UINT8ARRAY;
+};
+
+template<>
+struct TypedArrayType<signed char>
+{
+    static const duk_uint_t Type = DUK_BUFOBJ_INT8ARRAY;
+};
+
+template<>
+struct TypedArrayType<short>
+{
+    static const duk_uint_t Type = DUK_BUFOBJ_INT16ARRAY;
+};
+
+template<>
+struct TypedArrayType<unsigned short>
+{
+    static const duk_uint_t Type = DUK_BUFOBJ_UINT16ARRAY;
+};
+
+template<>
+struct TypedArrayType<int>
+{
+    static const duk_uint_t Type = DUK_BUFOBJ_INT32ARRAY;
+};
+
+template<>
+struct TypedArrayType<unsigned int>
+{
+    static const duk_uint_t Type = DUK_BUFOBJ_UINT32ARRAY;
+};
+
+template<>
+struct TypedArrayType<float>
+{
+    static const duk_uint_t Type = DUK_BUFOBJ_FLOAT32ARRAY;
+};
+
+template<>
+struct TypedArrayType<double>
+{
+    static const duk_uint_t Type = DUK_BUFOBJ_FLOAT64ARRAY;
+};
+
+/*! A non-owning view of binary data as array of elements. When taken as argument of bound function,
+    it points directly into data of ArrayBuffer, typed array, DataView or plain buffer, so changes are
+    visible to script and nothing is copied. Any of them could be viewed with any type of elements, if
+    size and alignment of data fit it. View is valid only while function is called and must not be stored.
+
+    When returned from function, elements are copied into new typed array. Use
+    dukpp03::AbstractContext::pushExternalBuffer or return dukpp03::VectorBuffer to pass data without copying.
+ */
+template<
+    typename _Element
+>
+class BufferView
+{
+public:
+    /*! Constructs empty view
+     */
+    BufferView() : m_data(nullptr), m_count(0)
+    {
+
+    }
+    /*! Constructs view of elements
+        \param[in] data elements
+        \param[in] count amount of elements
+     */
+    BufferView(_Element* data, size_t count) : m_data(data), m_count(count)
+    {
+
+    }
+    /*! Returns elements
+        \return elements
+     */
+    _Element* data() const
+    {
+        return m_data;
+    }
+    /*! Returns amount of elements
+        \return amount of elements
+     */
+    size_t size() const
+    {
+        return m_count;
+    }
+    /*! Returns size of data in bytes
+        \return size of data
+     */
+    size_t bytes() const
+    {
+        return m_count * sizeof(_Element);
+    }
+    /*! Returns true, if view is empty
+        \return whether view is empty
+     */
+    bool empty() const
+    {
+        return m_count == 0;
+    }
+    /*! Returns element
+        \param[in] i an index of element, which must be less than size
+        \return element
+     */
+    _Element& operator[](size_t i) const
+    {
+        return m_data[i];
+    }
+    /*! Returns pointer to first element
+        \return first element
+     */
+    _Element* begin() const
+    {
+        return m_data;
+    }
+    /*! Returns pointer past last element
+        \return end of elements
+     */
+    _Element* end() const
+    {
+        return m_data + m_count;
+    }
+private:
+    /*! Elements
+     */
+    _Element* m_data;
+    /*! Amount of elements
+     */
+    size_t m_count;
+};
+
+/*! Makes possible to take views of binary data as arguments of functions
+ */
+template<
+    typename _Element,
+    typename _Context
+>
+class GetValue<dukpp03::BufferView<_Element>, _Context>
+{
+public:
+    /*! Performs getting value from stack. Fails, if value is not a buffer or it's size or alignment
+        does not fit type of elements
+        \param[in] ctx context
+        \param[in] pos index for stack
+        \return a value if it exists, otherwise empty maybe
+     */
+    static dukpp03::Maybe<dukpp03::BufferView<_Element> > perform(_Context* ctx, duk_idx_t pos)
+    {
+        dukpp03::Maybe<dukpp03::BufferView<_Element> > result;
+        duk_context* c = ctx->context();
+        duk_size_t size = 0;
+        void* data = duk_get_buffer_data(c, pos, &size);
+        if (data)
+        {
+            if ((size % sizeof(_Element)) == 0 && (reinterpret_cast<uintptr_t>(data) % alignof(_Element)) == 0)
+            {
+                result.setValue(dukpp03::BufferView<_Element>(static_cast<_Element*>(data), size / sizeof(_Element)));
+            }
+        }
+        else
+        {
+            // Data of empty buffer is null, so it's distinguished from other values only by type
+            if (duk_is_buffer_data(c, pos))
+            {
+                result.setValue(dukpp03::BufferView<_Element>());
+            }
+        }
+        return result;
+    }
+};
+
+/*! Makes possible to return views of binary data from functions. Elements are copied into new typed array
+ */
+template<
+    typename _Element,
+    typename _Context
+>
+class PushValue<dukpp03::BufferView<_Element>, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value
+     */
+    static void perform(_Context* ctx, const dukpp03::BufferView<_Element>& v)
+    {
+        duk_context* c = ctx->context();
+        void* data = duk_push_fixed_buffer(c, v.bytes());
+        if (v.bytes())
+        {
+            memcpy(data, v.data(), v.bytes());
+        }
+        duk_push_buffer_object(c, -1, 0, v.bytes(), dukpp03::TypedArrayType<typename std::remove_const<_Element>::type>::Type);
+        duk_remove(c, -2);
+    }
+};
+
+/*! Makes possible to return buffers from functions without copying them. Heap takes ownership of buffer,
+    which is pushed as typed array of matching type
+ */
+template<
+    typename _Element,
+    typename _Context
+>
+class PushValue<dukpp03::VectorBuffer<_Element>*, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value. If nullptr, null is pushed
+     */
+    static void perform(_Context* ctx, dukpp03::VectorBuffer<_Element>* v)
+    {
+        if (v)
+        {
+            ctx->pushExternalBuffer(v, dukpp03::TypedArrayType<_Element>::Type);
+        }
+        else
+        {
+            duk_push_null(ctx->context());
+        }
+    }
+};
+
+}
@@ -0,0 +1,79 @@
+/*! \file bundle.h
+    
+    Defines a bundle of precompiled scripts, which could be loaded into context without parsing sources
+ */
+#pragma once
+#include "duk_custom.h"
+#include "../duktape/src/duktape.h"
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace dukpp03
+{
+
+/*! A bundle of precompiled scripts. A bundle is a file, which consists of header and list of entries.
+    Header contains magic, format version, Duktape version, flags of Duktape configuration, 
+    which affect bytecode, amount of entries, size of entries and their checksum. 
+    Each entry contains name and bytecode of script, dumped via duk_dump_function.
+    All numbers are stored as little-endian.
+
+    Bundles could be produced by dukpp03-bundle tool (see tools/dukpp03-bundle) or 
+    dukpp03::Bundle::write, and loaded via dukpp03::AbstractContext::loadBundle
+ */
+class Bundle
+{
+public:
+    /*! A source for bundle as pair of name and source code
+     */
+    typedef std::pair<std::string, std::string> Source;
+    /*! A current version of format of bundle
+     */
+    static const unsigned int FormatVersion = 1;
+    /*! A size of bundle header in bytes
+     */
+    static const size_t HeaderSize = 40;
+    /*! Compiles sources and writes them into bundle. Sources are compiled as programs
+        \param[in] path a path to bundle
+        \param[in] sources a list of sources
+        \param[out] error an error, if any
+        \return true on success
+     */
+    static bool write(const std::string& path, const std::vector<dukpp03::Bundle::Source>& sources, std::string* error = nullptr);
+    /*! Compiles source as program and dumps it's bytecode
+        \param[in] source a source
+        \param[out] bytecode a bytecode of compiled source
+        \param[out] error an error, if any
+        \return true on success
+     */
+    static bool compile(const dukpp03::Bundle::Source& source, std::vector<unsigned char>& bytecode, std::string* error = nullptr);
+    /*! Loads bytecode of compiled program and runs it in context, using global object as this
+        \param[in] ctx context
+        \param[in] bytecode a bytecode. Must be kept alive, while function is running
+        \param[in] size a size of bytecode
+        \param[in] name a name of program, used in error messages
+        \param[out] error an error, if any
+        \return true on success
+     */
+    static bool run(duk_context* ctx, const unsigned char* bytecode, size_t size, const std::string& name, std::string* error = nullptr);
+    /*! Loads bundle into context, running all scripts from it in order, as they were added into bundle.
+        File is mapped into memory, if platform supports it
+        \param[in] ctx context
+        \param[in] path a path to bundle
+        \param[out] error an error, if any
+        \return true on success
+     */
+    static bool load(duk_context* ctx, const std::string& path, std::string* error = nullptr);
+    /*! Returns flags of Duktape configuration, which affect compatibility of bytecode
+        \return flags
+     */
+    static unsigned int configFlags();
+    /*! Computes checksum for data in bundle
+        \param[in] data a data
+        \param[in] size a size of data
+        \return checksum
+     */
+    static unsigned long long checksum(const unsigned char* data, size_t size);
+};
+
+}
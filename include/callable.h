@@ -101,11 +101,13 @@ public:
     struct CheckArgument
     {
 
-        /*! Checks argument, passed as this, filling a if needed
+        /*! Fetches argument, passed as this, filling a if needed. On failure, reports
+            error to context and returns false, without throwing any C++ exceptions
             \param[in] c context
             \param[out] a an argument
+            \return true if argument is fetched
          */ 
-        static void passedAsThis(_Context* c, dukpp03::Maybe< typename dukpp03::Decay<_Arg>::Type >& a)
+        static bool fromThis(_Context* c, dukpp03::Maybe< typename dukpp03::Decay<_Arg>::Type >& a)
         {
             dukpp03::IsNotPODReference<_Arg>::typeMustBe();
             duk_push_this(c->context());
@@ -115,17 +117,20 @@ public:
             {
                 std::string name = _Context::template typeName< _Arg >();
                 c->throwInvalidTypeForThisError(name);
-                throw dukpp03::ArgumentException();
+                return false;
             }
+            return true;
         }
 
-        /*! Checks argument on stack, filling a if needed
+        /*! Fetches argument on stack, filling a if needed. On failure, reports
+            error to context and returns false, without throwing any C++ exceptions
             \param[in] c context
             \param[out] a an argument
             \param[in] stackValue a value index on stack
             \param[in] argnumber number of argument
+            \return true if argument is fetched
          */ 
-        static void onStack(_Context* c, dukpp03::Maybe< typename dukpp03::Decay<_Arg>::Type >& a, int stackValue, int argnumber)
+        static bool fromStack(_Context* c, dukpp03::Maybe< typename dukpp03::Decay<_Arg>::Type >& a, int stackValue, int argnumber)
         {
             dukpp03::IsNotPODReference<_Arg>::typeMustBe();
             a = dukpp03::GetValue< typename dukpp03::Decay<_Arg>::Type, _Context >::perform(c, stackValue);
@@ -133,6 +138,35 @@ public:
             {
                 std::string name = _Context::template typeName< _Arg >();
                 c->throwInvalidTypeError(argnumber, name);
+                return false;
+            }
+            return true;
+        }
+
+        /*! Checks argument, passed as this, filling a if needed. Throws dukpp03::ArgumentException
+            on failure, use fromThis for non-throwing version
+            \param[in] c context
+            \param[out] a an argument
+         */ 
+        static void passedAsThis(_Context* c, dukpp03::Maybe< typename dukpp03::Decay<_Arg>::Type >& a)
+        {
+            if (!fromThis(c, a))
+            {
+                throw dukpp03::ArgumentException();
+            }
+        }
+
+        /*! Checks argument on stack, filling a if needed. Throws dukpp03::ArgumentException
+            on failure, use fromStack for non-throwing version
+            \param[in] c context
+            \param[out] a an argument
+            \param[in] stackValue a value index on stack
+            \param[in] argnumber number of argument
+         */ 
+        static void onStack(_Context* c, dukpp03::Maybe< typename dukpp03::Decay<_Arg>::Type >& a, int stackValue, int argnumber)
+        {
+            if (!fromStack(c, a, stackValue, argnumber))
+            {
                 throw dukpp03::ArgumentException();
             }
         }
@@ -200,12 +234,12 @@ public:
 
 }
 
-/*! A macro for getting maybe value from this stack
+/*! A macro for getting maybe value from this stack. Returns from _call if value has invalid type
  */
-#define DUKPP03_MAYBE_FROM_THIS(TYPE)  dukpp03::Maybe< typename dukpp03::Decay< DUKPP03_TYPE(TYPE) >::Type > _ac; Callable<_Context>::template CheckArgument< DUKPP03_TYPE(TYPE) >::passedAsThis(c, _ac)
-/*! A macro for getting maybe value from stack
+#define DUKPP03_MAYBE_FROM_THIS(TYPE)  dukpp03::Maybe< typename dukpp03::Decay< DUKPP03_TYPE(TYPE) >::Type > _ac; if (!Callable<_Context>::template CheckArgument< DUKPP03_TYPE(TYPE) >::fromThis(c, _ac)) return 0
+/*! A macro for getting maybe value from stack. Returns from _call if value has invalid type
  */
-#define DUKPP03_MAYBE_FROM_STACK(TYPE, NAME, STACKV, NUMBER)  dukpp03::Maybe< typename dukpp03::Decay< DUKPP03_TYPE(TYPE) >::Type > _a##NAME; Callable<_Context>::template CheckArgument< DUKPP03_TYPE(TYPE) >::onStack(c, _a##NAME, STACKV, NUMBER)
+#define DUKPP03_MAYBE_FROM_STACK(TYPE, NAME, STACKV, NUMBER)  dukpp03::Maybe< typename dukpp03::Decay< DUKPP03_TYPE(TYPE) >::Type > _a##NAME; if (!Callable<_Context>::template CheckArgument< DUKPP03_TYPE(TYPE) >::fromStack(c, _a##NAME, STACKV, NUMBER)) return 0
 /*! A macro for checking arguments on stack
  */
 #define DUKPP03_CS(TYPE, STACKV) Callable<_Context>::template CheckArgument< DUKPP03_TYPE(TYPE) >::checkStack(c, STACKV);
@@ -0,0 +1,47 @@
+/*! \file cancellationtoken.h
+
+    Defines a token, which could be used to cancel evaluation from other thread
+ */
+#pragma once
+#include <atomic>
+
+namespace dukpp03
+{
+
+/*! A token for cooperative cancellation of evaluations. Token could be cancelled from any thread,
+    and every context, using it, aborts running script with timeout error on next check of timeout.
+    Token stays cancelled until it's reset, so all following evaluations are aborted too.
+    See dukpp03::AbstractContext::setCancellationToken
+ */
+class CancellationToken
+{
+public:
+    /*! Constructs token, which is not cancelled
+     */
+    CancellationToken();
+    /*! Cancels all evaluations, which use token
+     */
+    void cancel();
+    /*! Makes token not cancelled again
+     */
+    void reset();
+    /*! Returns true, if token is cancelled
+        \return whether token is cancelled
+     */
+    bool cancelled() const;
+private:
+    /*! A token is non-copyable
+        \param[in] o other token
+     */
+    CancellationToken(const dukpp03::CancellationToken& o);
+    /*! A token is non-copyable
+        \param[in] o other token
+        \return self-reference
+     */
+    dukpp03::CancellationToken& operator=(const dukpp03::CancellationToken& o);
+    /*! Whether token is cancelled
+     */
+    std::atomic<bool> m_cancelled;
+};
+
+}
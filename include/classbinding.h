@@ -6,6 +6,7 @@
 #include <map>
 #include <vector>
 #include <utility>
+#include <sstream>
 #include "callable.h"
 #include "constructor.h"
 #include "multimethod.h"
@@ -43,7 +44,7 @@ public:
     typedef std::vector<NamedAccessor> AccessorList;
     /*! Creates new empty binding
      */
-    ClassBinding()
+    ClassBinding() : m_shared_prototype(false), m_key_set(dukpp03::AbstractContext::newKeySet()), m_prototype_id(dukpp03::AbstractContext::newKeySet())
     {
     
     }
@@ -56,7 +57,7 @@ public:
     /*! Copies a class binding into current binding
         \param[in] o other binding
      */
-    ClassBinding(const ClassBinding<_Context>& o)
+    ClassBinding(const ClassBinding<_Context>& o) : m_shared_prototype(false), m_key_set(dukpp03::AbstractContext::newKeySet()), m_prototype_id(dukpp03::AbstractContext::newKeySet())
     {
         this->copy(o);
     }
@@ -464,7 +465,7 @@ public:
         }
     }
 
-    /*! Unregisters a binding in context
+    /*! Unregisters a binding in context, removing its callables from table of context
         \param[in] c context
      */
     void unregisterInContext(_Context* c)
@@ -472,26 +473,46 @@ public:
         for(size_t i = 0; i < m_constructors.size(); i++)
         {
             c->unregisterGlobal(m_constructors[i].first);
+            c->forgetCallable(m_constructors[i].second);
         }
+        for(size_t i = 0; i < m_methods.size(); i++)
+        {
+            c->forgetCallable(m_methods[i].second);
+        }
+        for(size_t i = 0; i < m_accessors.size(); i++)
+        {
+            c->forgetCallable(m_accessors[i].second.first);
+            c->forgetCallable(m_accessors[i].second.second);
+        }
+        // Prototype is removed, even if binding is no longer shared, since it could be created before
+        this->deleteSharedPrototype(c);
     }
     /*! Wraps value, setting methods for context
         \param[in] c context
      */
     virtual void wrapValue(_Context* c)
     {
+        if (m_shared_prototype)
+        {
+            this->pushSharedPrototype(c);
+            duk_set_prototype(c->context(), -2);
+            return;
+        }
+
         for (size_t i = 0; i < m_parent_bindings.size(); i++)
         {
             m_parent_bindings[i]->wrapValue(c);
         }
 
+        const std::vector<dukpp03::AbstractContext::PropertyKey>& keys = this->keys(c);
         for(size_t i = 0; i < m_methods.size(); i++)
         {
-            c->registerMutableProperty(m_methods[i].first, m_methods[i].second, false);
+            c->registerMutableProperty(keys[i], m_methods[i].second, false);
         }
         
         for(size_t i = 0; i < m_accessors.size(); i++)
         {
-            c->registerAttribute(m_accessors[i].first, m_accessors[i].second.first, false, m_accessors[i].second.second, false);
+            c->registerAttribute(keys[m_methods.size() + i], m_accessors[i].second.first, false, m_accessors[i].second.second, false);
         }
 
         if (m_prototype_function.size() != 0)
@@ -502,12 +523,106 @@ public:
         }
     }
 
+    /*! Installs methods and accessors of binding and its parent bindings as properties
+        of object on stack top. Used to fill shared prototype object
+        \param[in] c context
+     */
+    void installMembers(_Context* c)
+    {
+        for (size_t i = 0; i < m_parent_bindings.size(); i++)
+        {
+            m_parent_bindings[i]->installMembers(c);
+        }
+
+        const std::vector<dukpp03::AbstractContext::PropertyKey>& keys = this->keys(c);
+        for(size_t i = 0; i < m_methods.size(); i++)
+        {
+            c->registerMutableProperty(keys[i], m_methods[i].second, false);
+        }
+        
+        for(size_t i = 0; i < m_accessors.size(); i++)
+        {
+            c->registerAttribute(keys[m_methods.size() + i], m_accessors[i].second.first, false, m_accessors[i].second.second, false);
+        }
+    }
+
+    /*! Pushes a shared prototype object for binding on stack, creating it if it does not exist in context.
+        Prototype holds all methods and accessors of binding and its parents and inherits from
+        prototype function, or first constructor of binding, if no prototype function is set.
+        Prototype is kept in heap stash, so it's created again after reset of context
+        \param[in] c context
+     */
+    void pushSharedPrototype(_Context* c)
+    {
+        duk_context* ctx = c->context();
+        const std::vector<dukpp03::AbstractContext::PropertyKey>& keys = this->keys(c);
+        const dukpp03::AbstractContext::PropertyKey key = keys[m_methods.size() + m_accessors.size()];
+        duk_push_heap_stash(ctx);
+        if (c->getProperty(ctx, -1, key))
+        {
+            duk_remove(ctx, -2);
+            return;
+        }
+        duk_pop_2(ctx);
+
+        duk_push_object(ctx);
+        this->installMembers(c);
+        if (m_prototype_function.size() != 0)
+        {
+            const duk_bool_t result = duk_peval_string(ctx, m_prototype_function.c_str());
+            assert( result == 0);
+            duk_set_prototype(ctx, -2);
+        }
+        else
+        {
+            if (m_constructors.size() != 0)
+            {
+                duk_get_global_string(ctx, m_constructors[0].first.c_str());
+                if (duk_is_function(ctx, -1))
+                {
+                    duk_set_prototype(ctx, -2);
+                }
+                else
+                {
+                    duk_pop(ctx);
+                }
+            }
+        }
+        // Keep prototype in stash, so it won't be collected
+        duk_push_heap_stash(ctx);
+        duk_dup(ctx, -2);
+        c->putProperty(ctx, -2, key);
+        duk_pop(ctx);
+    }
+
+    /*! Sets, whether binding should create one shared prototype object per context, that holds methods and accessors,
+        instead of installing them into every wrapped value. Makes wrapping value cheap, since it does not depend
+        on amount of methods. Note, that methods and accessors will not be own properties of objects in this mode.
+        Must be set before binding is added to context. Changing methods, accessors or prototype function of binding
+        makes it replace prototype, but changes of parent bindings after binding was used in context are not
+        reflected in prototype, so parents must be filled before
+        \param[in] shared whether prototype should be shared
+     */
+    void setSharedPrototype(bool shared)
+    {
+        m_shared_prototype = shared;
+    }
+
+    /*! Returns whether binding uses shared prototype object per context
+        \return whether prototype is shared
+     */
+    bool sharedPrototype() const
+    {
+        return m_shared_prototype;
+    }
+
     /*! Sets a function, which should be used a prototype for objects, pushed on stack
         \param[in] fun a function
      */
     void setPrototypeFunction(const std::string& fun)
     {
         m_prototype_function = fun;
+        m_key_set = dukpp03::AbstractContext::newKeySet();
     }
 
     /*! Adds new parent binding to a current binding. Parent bindings are invoked sequentially when wrapping value and used only to wrap value.
@@ -534,6 +649,53 @@ public:
         }
     }
 protected:
+    /*! Returns a key, under which shared prototype is stored in heap stash. Key is stable for binding,
+        so prototype, rebuilt after binding is changed, replaces old one
+        \return key for stash
+     */
+    std::string prototypeStashKey() const
+    {
+        std::ostringstream ss;
+        ss << "\1dukpp03::ClassBinding::prototype\1" << m_prototype_id;
+        return ss.str();
+    }
+    /*! Removes shared prototype of binding from heap stash of context
+        \param[in] c context
+     */
+    void deleteSharedPrototype(_Context* c) const
+    {
+        duk_context* ctx = c->context();
+        duk_push_heap_stash(ctx);
+        duk_del_prop_string(ctx, -1, this->prototypeStashKey().c_str());
+        duk_pop(ctx);
+    }
+    /*! Returns names of methods and accessors, interned in context, interning them if needed. Keys are cached
+        by context, so binding is not changed and could be shared between contexts in different threads.
+        Since keys are interned again only after binding is changed, shared prototype, built for old state
+        of binding, is removed from context at this moment
+        \param[in] c context
+        \return keys of methods, followed by keys of accessors and key of shared prototype in heap stash
+     */
+    const std::vector<dukpp03::AbstractContext::PropertyKey>& keys(_Context* c) const
+    {
+        const std::vector<dukpp03::AbstractContext::PropertyKey>* result = c->keySet(m_key_set);
+        if (result)
+        {
+            return *result;
+        }
+        std::vector<std::string> names;
+        for(size_t i = 0; i < m_methods.size(); i++)
+        {
+            names.push_back(m_methods[i].first);
+        }
+        for(size_t i = 0; i < m_accessors.size(); i++)
+        {
+            names.push_back(m_accessors[i].first);
+        }
+        names.push_back(this->prototypeStashKey());
+        this->deleteSharedPrototype(c);
+        return c->internKeySet(m_key_set, names);
+    }
     /*! Inserts a callable into multimethod list
         \param[in] name a name of callable
         \param[in] dest a destination list
@@ -541,6 +703,7 @@ protected:
      */
     void insert(const std::string& name, MultiMethodList& dest, dukpp03::Callable<_Context>* c)
     {
+        m_key_set = dukpp03::AbstractContext::newKeySet();
         for(size_t i = 0; i < dest.size(); i++)
         {
             if (dest[i].first == name)
@@ -562,6 +725,7 @@ protected:
      */
     void insert(const std::string& name, AccessorList& dest, dukpp03::Callable<_Context>* getter, dukpp03::Callable<_Context>* setter)
     {
+        m_key_set = dukpp03::AbstractContext::newKeySet();
         for(size_t i = 0; i < dest.size(); i++)
         {
             if (dest[i].first == name)
@@ -610,6 +774,7 @@ protected:
      */
     void remove(const std::string& name, MultiMethodList& src, dukpp03::Callable<_Context>* c)
     {
+        m_key_set = dukpp03::AbstractContext::newKeySet();
         for(size_t i = 0; i < src.list(); i++)
         {
             if (src[i].first == name)
@@ -634,6 +799,7 @@ protected:
      */
     void remove(const std::string& name, AccessorList& src, dukpp03::Callable<_Context>* c)
     {
+        m_key_set = dukpp03::AbstractContext::newKeySet();
         for(size_t i = 0; i < src.list(); i++)
         {
             if (src[i].first == name)
@@ -676,6 +842,8 @@ protected:
         copy(m_accessors, m.m_accessors);
         m_parent_bindings = m.m_parent_bindings;
         m_prototype_function = m.m_prototype_function;
+        m_shared_prototype = m.m_shared_prototype;
+        m_key_set = dukpp03::AbstractContext::newKeySet();
     }
     /*! Copies source multimethod list to destination
         \param[in] dest destination
@@ -749,6 +917,16 @@ protected:
     /*! A list of parent bindings, that should be used when invoking wrapping value
      */
     std::vector<dukpp03::ClassBinding<_Context> *> m_parent_bindings;
+    /*! Whether binding should use one shared prototype object per context
+     */
+    bool m_shared_prototype;
+    /*! An identifier of names of methods and accessors, interned in contexts. Replaced, when methods, accessors
+        or prototype function are changed
+     */
+    dukpp03::AbstractContext::KeySetId m_key_set;
+    /*! An identifier of shared prototype of binding in heap stash. Unlike key set, it's never replaced
+     */
+    dukpp03::AbstractContext::KeySetId m_prototype_id;
 };
 
 
@@ -6,15 +6,25 @@
 #include "duk_custom.h"
 #include "../duktape/src/duktape.h"
 #include "callable.h"
+#include "pinnedvalue.h"
 // ReSharper disable once CppUnusedIncludeDirective
 #include "getvalue.h"
 #include "pushvalue.h"
 #include <cstring>
+#include <vector>
+#include <algorithm>
 
 namespace dukpp03
 {
 
-/*! A compiled function, that can be used to pass callbacks to other parts of code
+/*! A compiled function, that can be used to pass callbacks to other parts of code.
+
+    A function is materialized once per context and pinned in heap stash, so calls use live
+    function object. Function, taken from stack, only pins live function object. A bytecode is dumped
+    lazily from context, where function was taken, when function is cloned or pushed into another context,
+    so function must be cloned in thread of that context before passing it to other threads, and
+    does not survive destruction or reset of that context unless it was cloned or used elsewhere before.
+    Each context keeps it's own materialized function, so alternating contexts does not load bytecode again.
  */
 template<
    typename _Context
@@ -62,25 +72,50 @@ public:
      */
     virtual Callable<_Context>* clone() override
     {
+        this->dump();
         return new dukpp03::CompiledFunction<_Context>(*this);
     }
-    /*! Pushes current function on stack if can and deserializes it, otherwise pushes undefined
+    /*! Pushes current function on stack if can, otherwise pushes undefined. Function is deserialized
+        only if it was not materialized in this context before
         \param[in] ctx context
      */
-    void pushMeOnStack(_Context* ctx)
+    void pushMeOnStack(_Context* ctx) const
     {
         duk_context* c = ctx->context();
-        if (valid())
+        dukpp03::PinnedValue* pinned = this->pinnedIn(ctx);
+        if (pinned)
+        {
+            duk_push_heapptr(c, pinned->heapPointer());
+            return;
+        }
+        this->dump();
+        if (m_buffer)
         {
             void* p = duk_push_fixed_buffer(c, m_size);
             memcpy(p, m_buffer, m_size);
             duk_load_function(c);
+            m_pinned.push_back(ctx->pin(-1));
         }
         else
         {
             duk_push_undefined(c);
         }
     }
+    /*! Makes function use live function object from stack in this context, instead of deserializing
+        bytecode. Function object must be the same, as function, compiled into bytecode
+        \param[in] ctx context
+        \param[in] pos position of function on stack
+     */
+    void pinLiveFunction(_Context* ctx, duk_idx_t pos)
+    {
+        dukpp03::PinnedValue* pinned = this->pinnedIn(ctx);
+        if (pinned)
+        {
+            m_pinned.erase(std::find(m_pinned.begin(), m_pinned.end(), pinned));
+            pinned->delRef();
+        }
+        m_pinned.push_back(ctx->pin(pos));
+    }
     /*! We don't know how much arguments do we need, so return -1
         \return -1
      */
@@ -113,15 +148,13 @@ public:
         }
         const int top = ctx->getTop();
         duk_context* c = ctx->context();
-        void* p = duk_push_fixed_buffer(c, m_size);
-        memcpy(p, m_buffer, m_size);
-        duk_load_function(c);
+        this->pushMeOnStack(ctx);
         // Perform stack call 
         for(int i = 0; i < top; i++)
         {
             duk_dup(c, i);
         }
-        if (duk_pcall(c, top) == DUK_EXEC_ERROR)
+        if (ctx->pcall(top) == DUK_EXEC_ERROR)
         {
             return DUK_RET_TYPE_ERROR;
         }
@@ -143,12 +176,23 @@ public:
     {
         this->destroy();
     }
-    /*! Returns true if function buffer is set
-        \return buffer
+    /*! Returns true if function bytecode is set or function is materialized in living context
+        \return whether function could be pushed
      */
     bool valid() const 
     {
-        return m_buffer != nullptr;
+        if (m_buffer)
+        {
+            return true;
+        }
+        for(size_t i = 0; i < m_pinned.size(); i++)
+        {
+            if (m_pinned[i]->context())
+            {
+                return true;
+            }
+        }
+        return false;
     }
 protected:
     /*! Copies function state from other function
@@ -167,19 +211,81 @@ protected:
             m_buffer = nullptr;
             m_size = 0;
         }
+        // Copies share materialized functions
+        m_pinned = f.m_pinned;
+        for(size_t i = 0; i < m_pinned.size(); i++)
+        {
+            m_pinned[i]->addRef();
+        }
     }
-    /*! Destructs buffer value
+    /*! Destructs buffer value and releases materialized function
      */
-    void destroy() const
+    void destroy()
     {
         delete[] static_cast<char*>(m_buffer);
+        m_buffer = nullptr;
+        for(size_t i = 0; i < m_pinned.size(); i++)
+        {
+            m_pinned[i]->delRef();
+        }
+        m_pinned.clear();
+    }
+    /*! Dumps bytecode of function from any context, where it's materialized, unless bytecode is already set
+     */
+    void dump() const
+    {
+        for(size_t i = 0; !m_buffer && i < m_pinned.size(); i++)
+        {
+            dukpp03::AbstractContext* owner = m_pinned[i]->context();
+            if (owner)
+            {
+                duk_context* c = owner->context();
+                duk_push_heapptr(c, m_pinned[i]->heapPointer());
+                duk_dump_function(c);
+                duk_size_t size = 0;
+                void* buffer = duk_get_buffer(c, -1, &size);
+                m_size = size;
+                m_buffer = new char[m_size];
+                memcpy(m_buffer, buffer, m_size);
+                duk_pop(c);
+            }
+        }
     }
-    /*! A buffer pointer
+    /*! Returns function, materialized in context, dropping handles, detached by destroyed or reset contexts
+        \param[in] ctx context
+        \return handle or nullptr, if function is not materialized in context
      */
-    void* m_buffer;
+    dukpp03::PinnedValue* pinnedIn(_Context* ctx) const
+    {
+        dukpp03::PinnedValue* result = nullptr;
+        for(size_t i = 0; i < m_pinned.size(); )
+        {
+            dukpp03::AbstractContext* owner = m_pinned[i]->context();
+            if (!owner)
+            {
+                m_pinned[i]->delRef();
+                m_pinned.erase(m_pinned.begin() + i);
+            }
+            else
+            {
+                if (owner == ctx)
+                {
+                    result = m_pinned[i];
+                }
+                ++i;
+            }
+        }
+        return result;
+    }
+    /*! A buffer pointer, filled lazily by dump
+     */
+    mutable void* m_buffer;
     /*! A size of buffer
      */
-    duk_size_t m_size;
+    mutable duk_size_t m_size;
+    /*! Functions, materialized in contexts, one per context
+     */
+    mutable std::vector<dukpp03::PinnedValue*> m_pinned;
 };
 
 
@@ -200,12 +306,10 @@ static dukpp03::Maybe<dukpp03::CompiledFunction<_Context> > perform(_Context* ct
     duk_context* c = ctx->context();
     if (duk_is_ecmascript_function(c, pos))
     {
-        duk_size_t  size = 0;
-        duk_dup(c, pos);
-        duk_dump_function(c);
-        void* buffer = duk_get_buffer(c, -1, &size);
-        result.setValue(dukpp03::CompiledFunction<_Context>(buffer, size));
-        duk_pop(c);
+        // Bytecode is dumped only when it's needed, so checking overloads does not serialize function
+        dukpp03::CompiledFunction<_Context> f;
+        f.pinLiveFunction(ctx, pos);
+        result.setValue(f);
     }
     return result;
 }
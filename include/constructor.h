@@ -51,8 +51,7 @@ public:
         
         _ClassName  t;
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -102,8 +101,7 @@ public:
         
         _ClassName  t(_a0._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -155,8 +153,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -210,8 +207,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -267,8 +263,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -326,8 +321,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -387,8 +381,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -450,8 +443,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -515,8 +507,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -582,8 +573,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -651,8 +641,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -722,8 +711,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -795,8 +783,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._(), _a11._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -870,8 +857,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._(), _a11._(), _a12._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -947,8 +933,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._(), _a11._(), _a12._(), _a13._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -1026,8 +1011,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._(), _a11._(), _a12._(), _a13._(), _a14._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -1107,8 +1091,7 @@ public:
         
         _ClassName  t(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._(), _a11._(), _a12._(), _a13._(), _a14._(), _a15._());
         dukpp03::PushValue<_ClassName, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -57,8 +57,7 @@ public:
 
         _ReturnType t = m_callee();
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -117,8 +116,7 @@ public:
 
         _ReturnType t = m_callee(_a0._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -179,8 +177,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -243,8 +240,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -309,8 +305,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -377,8 +372,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -447,8 +441,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -519,8 +512,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -593,8 +585,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -669,8 +660,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -747,8 +737,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -827,8 +816,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -909,8 +897,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._(), _a11._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -993,8 +980,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._(), _a11._(), _a12._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -1079,8 +1065,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._(), _a11._(), _a12._(), _a13._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -1167,8 +1152,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._(), _a11._(), _a12._(), _a13._(), _a14._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -1257,8 +1241,7 @@ public:
 
         _ReturnType t = m_callee(_a0._(), _a1._(), _a2._(), _a3._(), _a4._(), _a5._(), _a6._(), _a7._(), _a8._(), _a9._(), _a10._(), _a11._(), _a12._(), _a13._(), _a14._(), _a15._());
         dukpp03::PushValue<_ReturnType, _Context>::perform(c, t);
-        duk_push_current_function(c->context());
-        duk_set_prototype(c->context(), -2);
+        c->setCurrentFunctionAsPrototype();
         return 1;
     }
     /*! Can be inherited
@@ -0,0 +1,419 @@
+/*! \file containers.h
+
+    Defines passing standard containers to functions and returning them: std::vector and std::array
+    are converted to and from arrays, std::map and std::unordered_map with string keys are converted
+    to and from plain objects
+ */
+#pragma once
+#include "duk_custom.h"
+#include "../duktape/src/duktape.h"
+#include "maybe.h"
+#include "bufferview.h"
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <iterator>
+#include <vector>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <type_traits>
+
+namespace dukpp03
+{
+
+template<
+    typename _Value,
+    typename _Context
+>
+class PushValue;
+
+template<
+    typename _Value,
+    typename _Context
+>
+class GetValue;
+
+namespace internal
+{
+
+/*! Returns data of typed array or plain buffer, if it's elements have specified type
+    \param[in] ctx context
+    \param[in] pos an index of value on stack
+    \param[in] type a type of typed array as DUK_BUFOBJ_* constant. Plain buffers match Uint8Array
+    \param[out] data data of array
+    \param[out] size size of data in bytes
+    \return whether value is typed array of specified type
+ */
+bool typedArrayData(duk_context* ctx, duk_idx_t pos, duk_uint_t type, void** data, duk_size_t* size);
+
+/*! Returns true, if value is array or typed array, whose elements could be read by index
+    \param[in] ctx context
+    \param[in] pos an index of value on stack
+    \return whether value is array-like
+ */
+bool isArrayLike(duk_context* ctx, duk_idx_t pos);
+
+/*! Determines, whether elements of specified type could be copied from typed array at once
+ */
+template<
+    typename _Element,
+    typename = void
+>
+struct HasTypedArrayType : std::false_type
+{
+
+};
+
+template<
+    typename _Element
+>
+struct HasTypedArrayType<_Element, decltype((void)dukpp03::TypedArrayType<_Element>::Type)> : std::true_type
+{
+
+};
+
+/*! Reads sequence of elements from array or typed array
+ */
+template<
+    typename _Element,
+    typename _Context
+>
+class GetSequence
+{
+public:
+    /*! Reads elements from array, appending them to result. Typed arrays with elements of the same type
+        are copied at once, other arrays are read element by element
+        \param[in] c context
+        \param[in] pos an index of array on stack
+        \param[out] result elements
+        \return whether all elements were read
+     */
+    static bool perform(_Context* c, duk_idx_t pos, std::vector<_Element>& result)
+    {
+        duk_context* ctx = c->context();
+        pos = duk_normalize_index(ctx, pos);
+        if (GetSequence<_Element, _Context>::copyTypedArray(ctx, pos, result, dukpp03::internal::HasTypedArrayType<_Element>()))
+        {
+            return true;
+        }
+        if (!dukpp03::internal::isArrayLike(ctx, pos))
+        {
+            return false;
+        }
+        const duk_size_t n = duk_get_length(ctx, pos);
+        result.reserve(result.size() + n);
+        for(duk_size_t i = 0; i < n; i++)
+        {
+            duk_get_prop_index(ctx, pos, static_cast<duk_uarridx_t>(i));
+            dukpp03::Maybe<_Element> v = dukpp03::GetValue<_Element, _Context>::perform(c, -1);
+            duk_pop(ctx);
+            if (!v.exists())
+            {
+                return false;
+            }
+            result.push_back(v.value());
+        }
+        return true;
+    }
+private:
+    /*! Copies elements of typed array with the same type of elements
+        \param[in] ctx context
+        \param[in] pos an index of array on stack
+        \param[out] result elements
+        \return whether value is typed array with the same type of elements
+     */
+    static bool copyTypedArray(duk_context* ctx, duk_idx_t pos, std::vector<_Element>& result, std::true_type)
+    {
+        void* data = nullptr;
+        duk_size_t size = 0;
+        if (!dukpp03::internal::typedArrayData(ctx, pos, dukpp03::TypedArrayType<_Element>::Type, &data, &size))
+        {
+            return false;
+        }
+        const size_t offset = result.size();
+        result.resize(offset + size / sizeof(_Element));
+        if (size)
+        {
+            memcpy(result.data() + offset, data, (size / sizeof(_Element)) * sizeof(_Element));
+        }
+        return true;
+    }
+    /*! Does nothing, since elements could not be stored in typed array
+        \return false
+     */
+    static bool copyTypedArray(duk_context*, duk_idx_t, std::vector<_Element>&, std::false_type)
+    {
+        return false;
+    }
+};
+
+/*! Reads own properties of object, converting them to values of dictionary
+ */
+template<
+    typename _Dictionary,
+    typename _Context
+>
+class GetDictionary
+{
+public:
+    /*! Reads properties of object, inserting them into dictionary
+        \param[in] c context
+        \param[in] pos an index of object on stack
+        \param[out] result dictionary
+        \return whether all properties were read
+     */
+    static bool perform(_Context* c, duk_idx_t pos, _Dictionary& result)
+    {
+        duk_context* ctx = c->context();
+        if (!duk_is_object(ctx, pos) || duk_is_function(ctx, pos))
+        {
+            return false;
+        }
+        // Result depends on properties of object, so overload, chosen for it, must not be cached
+        c->setValueDependentMatch(true);
+        duk_enum(ctx, pos, DUK_ENUM_OWN_PROPERTIES_ONLY);
+        while (duk_next(ctx, -1, 1))
+        {
+            dukpp03::Maybe<typename _Dictionary::mapped_type> v = dukpp03::GetValue<typename _Dictionary::mapped_type, _Context>::perform(c, -1);
+            if (!v.exists())
+            {
+                duk_pop_3(ctx);
+                return false;
+            }
+            duk_size_t length = 0;
+            const char* key = duk_get_lstring(ctx, -2, &length);
+            result[std::string(key, length)] = v.value();
+            duk_pop_2(ctx);
+        }
+        duk_pop(ctx);
+        return true;
+    }
+};
+
+/*! Pushes range of elements as array
+ */
+template<
+    typename _Iterator,
+    typename _Context
+>
+void pushSequence(_Context* c, _Iterator begin, _Iterator end)
+{
+    duk_context* ctx = c->context();
+    duk_require_stack(ctx, 2);
+    const duk_idx_t arr = duk_push_array(ctx);
+    duk_uarridx_t index = 0;
+    for(_Iterator it = begin; it != end; ++it, ++index)
+    {
+        dukpp03::PushValue<typename std::iterator_traits<_Iterator>::value_type, _Context>::perform(c, *it);
+        duk_put_prop_index(ctx, arr, index);
+    }
+}
+
+/*! Pushes dictionary as plain object
+ */
+template<
+    typename _Dictionary,
+    typename _Context
+>
+void pushDictionary(_Context* c, const _Dictionary& v)
+{
+    duk_context* ctx = c->context();
+    duk_require_stack(ctx, 2);
+    const duk_idx_t obj = duk_push_object(ctx);
+    for(typename _Dictionary::const_iterator it = v.begin(); it != v.end(); ++it)
+    {
+        dukpp03::PushValue<typename _Dictionary::mapped_type, _Context>::perform(c, it->second);
+        duk_put_prop_lstring(ctx, obj, it->first.c_str(), it->first.size());
+    }
+}
+
+}
+
+/*! Makes possible to take vectors as arguments of functions. Arrays and typed arrays are accepted
+ */
+template<
+    typename _Element,
+    typename _Context
+>
+class GetValue<std::vector<_Element>, _Context>
+{
+public:
+    /*! Performs getting value from stack
+        \param[in] ctx context
+        \param[in] pos index for stack
+        \return a value if it exists, otherwise empty maybe
+     */
+    static dukpp03::Maybe<std::vector<_Element> > perform(_Context* ctx, duk_idx_t pos)
+    {
+        dukpp03::Maybe<std::vector<_Element> > result;
+        result.setValue(std::vector<_Element>());
+        if (!dukpp03::internal::GetSequence<_Element, _Context>::perform(ctx, pos, result.mutableValue()))
+        {
+            result.clear();
+        }
+        return result;
+    }
+};
+
+/*! Makes possible to take fixed-size arrays as arguments of functions. Length of array must match size
+ */
+template<
+    typename _Element,
+    size_t _Size,
+    typename _Context
+>
+class GetValue<std::array<_Element, _Size>, _Context>
+{
+public:
+    /*! Performs getting value from stack
+        \param[in] ctx context
+        \param[in] pos index for stack
+        \return a value if it exists, otherwise empty maybe
+     */
+    static dukpp03::Maybe<std::array<_Element, _Size> > perform(_Context* ctx, duk_idx_t pos)
+    {
+        dukpp03::Maybe<std::array<_Element, _Size> > result;
+        std::vector<_Element> elements;
+        if (dukpp03::internal::GetSequence<_Element, _Context>::perform(ctx, pos, elements) && elements.size() == _Size)
+        {
+            result.setValue(std::array<_Element, _Size>());
+            for(size_t i = 0; i < _Size; i++)
+            {
+                result.mutableValue()[i] = elements[i];
+            }
+        }
+        return result;
+    }
+};
+
+/*! Makes possible to take maps as arguments of functions. Own properties of object become entries of map
+ */
+template<
+    typename _Element,
+    typename _Context
+>
+class GetValue<std::map<std::string, _Element>, _Context>
+{
+public:
+    /*! Performs getting value from stack
+        \param[in] ctx context
+        \param[in] pos index for stack
+        \return a value if it exists, otherwise empty maybe
+     */
+    static dukpp03::Maybe<std::map<std::string, _Element> > perform(_Context* ctx, duk_idx_t pos)
+    {
+        dukpp03::Maybe<std::map<std::string, _Element> > result;
+        result.setValue(std::map<std::string, _Element>());
+        if (!dukpp03::internal::GetDictionary<std::map<std::string, _Element>, _Context>::perform(ctx, pos, result.mutableValue()))
+        {
+            result.clear();
+        }
+        return result;
+    }
+};
+
+/*! Makes possible to take unordered maps as arguments of functions. Own properties of object become entries of map
+ */
+template<
+    typename _Element,
+    typename _Context
+>
+class GetValue<std::unordered_map<std::string, _Element>, _Context>
+{
+public:
+    /*! Performs getting value from stack
+        \param[in] ctx context
+        \param[in] pos index for stack
+        \return a value if it exists, otherwise empty maybe
+     */
+    static dukpp03::Maybe<std::unordered_map<std::string, _Element> > perform(_Context* ctx, duk_idx_t pos)
+    {
+        dukpp03::Maybe<std::unordered_map<std::string, _Element> > result;
+        result.setValue(std::unordered_map<std::string, _Element>());
+        if (!dukpp03::internal::GetDictionary<std::unordered_map<std::string, _Element>, _Context>::perform(ctx, pos, result.mutableValue()))
+        {
+            result.clear();
+        }
+        return result;
+    }
+};
+
+/*! Makes possible to return vectors from functions as arrays
+ */
+template<
+    typename _Element,
+    typename _Context
+>
+class PushValue<std::vector<_Element>, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value
+     */
+    static void perform(_Context* ctx, const std::vector<_Element>& v)
+    {
+        dukpp03::internal::pushSequence(ctx, v.begin(), v.end());
+    }
+};
+
+/*! Makes possible to return fixed-size arrays from functions as arrays
+ */
+template<
+    typename _Element,
+    size_t _Size,
+    typename _Context
+>
+class PushValue<std::array<_Element, _Size>, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value
+     */
+    static void perform(_Context* ctx, const std::array<_Element, _Size>& v)
+    {
+        dukpp03::internal::pushSequence(ctx, v.begin(), v.end());
+    }
+};
+
+/*! Makes possible to return maps from functions as plain objects
+ */
+template<
+    typename _Element,
+    typename _Context
+>
+class PushValue<std::map<std::string, _Element>, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value
+     */
+    static void perform(_Context* ctx, const std::map<std::string, _Element>& v)
+    {
+        dukpp03::internal::pushDictionary(ctx, v);
+    }
+};
+
+/*! Makes possible to return unordered maps from functions as plain objects
+ */
+template<
+    typename _Element,
+    typename _Context
+>
+class PushValue<std::unordered_map<std::string, _Element>, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value
+     */
+    static void perform(_Context* ctx, const std::unordered_map<std::string, _Element>& v)
+    {
+        dukpp03::internal::pushDictionary(ctx, v);
+    }
+};
+
+}
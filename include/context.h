@@ -22,12 +22,10 @@
 #include "errorcodes.h"
 #include "callable.h"
 #include "decay.h"
+#include "variantregistry.h"
 // ReSharper disable once CppUnusedIncludeDirective
 #include <iostream>
 
-/*! A property name for an object, which must have this property set to a string variant
- */
-#define DUKPP03_VARIANT_PROPERTY_SIGNATURE "\1dukpp03::Variant\1"
 
 namespace dukpp03
 {
@@ -63,11 +61,22 @@ struct Finalizer
         \return variant or null if nothing
      */
     static typename _Context::Variant* getVariantToFinalize(duk_context* ctx);
+    /*! Returns variant to be finalized, if it's registered in context, unregistering it. Variant
+        is returned only once, so caller becomes owner of variant and must destroy it
+        \param[in] ctx context
+        \return variant or null if nothing
+     */
+    static typename _Context::Variant* claimVariantToFinalize(duk_context* ctx);
     /*! A finalization function
         \param[in] ctx context
         \return 0
      */
     static duk_ret_t finalize(duk_context *ctx);
+    /*! A finalization function for variants, constructed in pool of context
+        \param[in] ctx context
+        \return 0
+     */
+    static duk_ret_t finalizePooled(duk_context *ctx);
 };
 
 /*! A common finalizing function for finalizer
@@ -106,7 +115,7 @@ public:
     typedef _MapInterface<std::string, ClassBinding<Self>*> ClassBindingSet;
     /*! Registered objects set for context
      */
-    typedef _MapInterface<Variant*, Variant*> RegisteredObjectSet;
+    typedef dukpp03::VariantRegistry RegisteredObjectSet;
     /*! A registered item set for context
      */
     typedef _MapInterface<void*, void*> LinkedPointerSet;
@@ -116,9 +125,19 @@ public:
     /*! An utilities for wrapping value into context
      */
     typedef  _WrapValue WrapValue;
+    /*! A size of slab in pool of variants
+     */
+    static const size_t VariantPoolSlabSize = 4 * 1024;
     /*! Creates new context
      */
-    Context()
+    Context() : m_variant_pool(VariantPoolSlabSize)
+    {
+
+    }
+    /*! Creates new context, which uses specified allocator for heap
+        \param[in] allocator an allocator for heap. Allocator is not owned by context and must outlive it
+     */
+    explicit Context(dukpp03::Allocator* allocator) : dukpp03::AbstractContext(allocator), m_variant_pool(VariantPoolSlabSize)
     {
 
     }
@@ -136,6 +155,8 @@ public:
         }
         m_class_bindings.clear();
         m_functions.clear();
+        m_script_cache.clear();
+        this->detachPinnedValues();
         if (m_context)
         {
             duk_destroy_heap(m_context);
@@ -156,8 +177,11 @@ public:
             delete it.value();
         }
         m_class_bindings.clear();
+        m_script_cache.clear();
+        this->detachPinnedValues();
         duk_destroy_heap(m_context);
-        m_context = duk_create_heap(nullptr,nullptr, nullptr, this, nullptr);
+        m_registered_objects.clear();
+        this->createHeap();
         this->initContextBeforeAccessing();
     }
     /*! Pushes variant to a pool. Note, that context becomes owner of variant, so don't push your own variants into here.
@@ -168,12 +192,8 @@ public:
     void pushVariant(Variant* v,  dukpp03::FinalizerFunction ff = dukpp03::Finalizer<Self>::finalize)
     {
 	    const duk_idx_t obj = duk_push_object(m_context);
-        // Push pointer value for variant
-        duk_push_string(m_context, DUKPP03_VARIANT_PROPERTY_SIGNATURE); 
-        duk_push_pointer(m_context, v);
-        duk_def_prop(m_context, obj, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_HAVE_WRITABLE | DUK_DEFPROP_FORCE | 0);
-
-        m_registered_objects.insert(v, v);
+        // Register variant and store handle of it in object
+        this->registerVariant(obj, v, dukpp03::VariantRegistry::typeTag<_Value>());
 
         // Set finalizer for current object
         duk_push_c_function(m_context, ff, 2);
@@ -190,6 +210,26 @@ public:
         WrapValue::perform(this, v, wrapped);
     }
 
+    /*! Pushes value as variant, constructing variant in pool of context via VariantUtils::makeAt
+        instead of allocating it on heap. Storage is returned to pool by finalizer of object
+        \param[in] v value
+     */
+    template< typename _Value >
+    void pushValueAsVariant(const _Value& v)
+    {
+        // Blocks of pool are aligned only by 8 bytes
+        static_assert(alignof(Variant) <= 8, "Variant is overaligned for pool of variants");
+        Variant* variant = _VariantInterface::template makeAt<_Value>(m_variant_pool.allocate(sizeof(Variant)), v);
+        this->template pushVariant<_Value>(variant, dukpp03::Finalizer<Self>::finalizePooled);
+    }
+    /*! Destroys variant, pushed via pushValueAsVariant, returning it's storage to pool
+        \param[in] v variant
+     */
+    void destroyPooledVariant(Variant* v)
+    {
+        _VariantInterface::destroyAt(v);
+        m_variant_pool.free(v);
+    }
     /*! DO NOT use this function, unless you know, what you're doing. This functions pushes on stack
         variant with type passed in first argument, trying to wrap it onto method. 
 
@@ -202,12 +242,8 @@ public:
     {
         const duk_idx_t obj = duk_push_object(m_context);
 
-        // Push pointer value for variant
-        duk_push_string(m_context, DUKPP03_VARIANT_PROPERTY_SIGNATURE); 
-        duk_push_pointer(m_context, v);
-        duk_def_prop(m_context, obj, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_HAVE_WRITABLE | DUK_DEFPROP_FORCE | 0);
-
-        m_registered_objects.insert(v, v);
+        // Register variant and store handle of it in object
+        this->registerVariant(obj, v);
 
         // Set finalizer for current object
         duk_push_c_function(m_context,  ff, 2);
@@ -223,7 +259,8 @@ public:
         WrapValue::perform(this, v, wrapped);       
     }
 
-    /*! Test if variant is register
+    /*! Test if variant is register. Looks through all registered variants, so prefer
+        dukpp03::Context::variantFromObject, when object is known
         \param[in] v variant
         \return if value is registered
      */
@@ -232,13 +269,73 @@ public:
         return m_registered_objects.contains(v);            
     }
 
-    /*! Unregisters variant from context
+    /*! Unregisters variant from context. Looks through all registered variants, so prefer
+        version with handle
         \param[in] v variant
      */
     void unregisterVariant(Variant* v)
     {
         m_registered_objects.remove(v);
     }
+    /*! Unregisters variant, registered with specified handle. Caller becomes owner of variant
+        \param[in] h handle, stored in object in DUKPP03_VARIANT_PROPERTY_SIGNATURE
+        \return variant or nullptr if handle is stale
+     */
+    Variant* unregisterVariant(dukpp03::VariantRegistry::Handle h)
+    {
+        return static_cast<Variant*>(m_registered_objects.take(h));
+    }
+    /*! Returns variant, registered with specified handle
+        \param[in] h handle, stored in object in DUKPP03_VARIANT_PROPERTY_SIGNATURE
+        \return variant or nullptr if handle is stale
+     */
+    Variant* registeredVariant(dukpp03::VariantRegistry::Handle h)
+    {
+        return static_cast<Variant*>(m_registered_objects.find(h));
+    }
+    /*! Returns variant, owned by object on stack
+        \param[in] pos an index of object on stack
+        \return variant or nullptr if value is not an object, which owns variant
+     */
+    Variant* variantFromObject(duk_idx_t pos)
+    {
+        return this->registeredVariant(this->variantHandle(m_context, pos));
+    }
+    /*! Returns handle of variant, owned by object on stack
+        \param[in] ctx context or thread of context
+        \param[in] pos an index of object on stack
+        \return handle or dukpp03::VariantRegistry::InvalidHandle if value is not an object, which owns variant
+     */
+    dukpp03::VariantRegistry::Handle variantHandle(duk_context* ctx, duk_idx_t pos)
+    {
+        dukpp03::VariantRegistry::Handle result = dukpp03::VariantRegistry::InvalidHandle;
+        if (duk_is_object(ctx, pos))
+        {
+            if (this->getProperty(ctx, pos, dukpp03::AbstractContext::VariantKey))
+            {
+                result = static_cast<dukpp03::VariantRegistry::Handle>(duk_get_number_default(ctx, -1, 0));
+            }
+            duk_pop(ctx);
+        }
+        return result;
+    }
+    /*! Returns tag of type of variant, owned by object on stack. Variants, pushed via pushVariant
+        with the same type, have the same tag, so conversions of their objects have the same results
+        \param[in] ctx context or thread of context
+        \param[in] pos an index of object on stack
+        \return tag or nullptr if value is not an object, which owns variant, or type of variant is unknown
+     */
+    const void* variantType(duk_context* ctx, duk_idx_t pos)
+    {
+        return m_registered_objects.type(this->variantHandle(ctx, pos));
+    }
+    /*! Returns amount of variants, owned by objects of context
+        \return amount of variants
+     */
+    size_t registeredVariantCount() const
+    {
+        return m_registered_objects.size();
+    }
     
     /*! Registers variable as property of global object, pushing it into a persistent stack. Replaces existing property.
         \param[in] property_name name of new property of global object
@@ -398,6 +495,17 @@ public:
         this->pushCallable(callable, own);
         duk_def_prop(m_context, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_HAVE_WRITABLE | DUK_DEFPROP_FORCE | 0);
     }
+    /*! Sets immutable callable property for value on stack top.
+        \param[in] key an interned property key
+        \param[in] callable a callable object
+        \param[in] own whether we would own callable
+     */
+    void registerImmutableProperty(dukpp03::AbstractContext::PropertyKey key, LocalCallable* callable, bool own = true)
+    {
+        this->pushKey(key);
+        this->pushCallable(callable, own);
+        duk_def_prop(m_context, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_HAVE_WRITABLE | DUK_DEFPROP_FORCE | 0);
+    }
     /*! Sets mutable callable property  for value on stack top. 
         \param[in] property_name a property name
         \param[in] callable a callable object 
@@ -409,6 +517,17 @@ public:
         this->pushCallable(callable, own);
         duk_put_prop(m_context, -3);
     }
+    /*! Sets mutable callable property for value on stack top
+        \param[in] key an interned property key
+        \param[in] callable a callable object
+        \param[in] own whether we would own callable
+      */
+    void registerMutableProperty(dukpp03::AbstractContext::PropertyKey key, LocalCallable* callable, bool own = true)
+    {
+        this->pushKey(key);
+        this->pushCallable(callable, own);
+        duk_put_prop(m_context, -3);
+    }
     /*! Registers new attribute property for value on stack top
         \param[in] property_name a property name
         \param[in] getter a getter
@@ -430,22 +549,29 @@ public:
             return;
         }
         duk_push_string(m_context, property_name.c_str());
-        duk_idx_t obj = -2;
-        duk_uint_t flags = DUK_DEFPROP_HAVE_CONFIGURABLE | DUK_DEFPROP_HAVE_ENUMERABLE | DUK_DEFPROP_ENUMERABLE | DUK_DEFPROP_FORCE;
-        if (getter)
-        {
-            flags = flags | DUK_DEFPROP_HAVE_GETTER;
-            this->dukpp03::AbstractContext::pushCallable(getter, should_own_getter, true);
-            obj -= 1;
-        }
-        
-        if (setter)
+        this->defineAttribute(getter, should_own_getter, setter, should_own_setter);
+    }
+    /*! Registers new attribute property for value on stack top
+        \param[in] key an interned property key
+        \param[in] getter a getter
+        \param[in] should_own_getter whether context should own getter
+        \param[in] setter a setter
+        \param[in] should_own_setter whether context should own setter
+     */
+    void registerAttribute(
+        dukpp03::AbstractContext::PropertyKey key,
+        LocalCallable* getter,
+        bool should_own_getter,
+        LocalCallable* setter,
+        bool should_own_setter
+    )
+    {
+        if (!getter && !setter)
         {
-            flags = flags | DUK_DEFPROP_HAVE_SETTER;
-            this->dukpp03::AbstractContext::pushCallable(setter, should_own_setter, true);
-            obj -= 1;
+            return;
         }
-        duk_def_prop(m_context, obj, flags);
+        this->pushKey(key);
+        this->defineAttribute(getter, should_own_getter, setter, should_own_setter);
     }
     /*! Get global object from value
         \param[in] property_name a property for global object
@@ -561,6 +687,30 @@ public:
         }
         return nullptr;
     }
+    /*! Returns all class bindings of context
+        \return list of bindings
+     */
+    std::vector<dukpp03::ClassBinding<Self>*> classBindings() const
+    {
+        std::vector<dukpp03::ClassBinding<Self>*> result;
+        for(typename ClassBindingSet::iterator it = m_class_bindings.begin(); it.end() == false; it.next())
+        {
+            result.push_back(it.value());
+        }
+        return result;
+    }
+    /*! Returns amount of callables, owned by context
+        \return amount of callables
+     */
+    size_t ownedCallableCount() const
+    {
+        size_t result = 0;
+        for(typename CallbackSet::iterator it = m_functions.begin(); it.end() == false; it.next())
+        {
+            ++result;
+        }
+        return result;
+    }
 
     /*! Inserts linked pointer to context, storing it 
         \param[in] ptr pointer
@@ -598,7 +748,11 @@ public:
     {
         duk_context* ctx = this->context();
         duk_get_global_string(ctx, function);
-        duk_call(ctx, 0);
+        // Errors are rethrown, so they propagate as with duk_call, but call is bounded by budget of context
+        if (this->pcall(0) != DUK_EXEC_SUCCESS)
+        {
+            duk_throw(ctx);
+        }
     }
     /*! Calls global function
         \param[in] function a function
@@ -610,7 +764,10 @@ public:
         duk_context* ctx = this->context();
         duk_get_global_string(ctx, function);
         dukpp03::PushValue<_T1, Self>::perform(this, v1);
-        duk_call(ctx, 1);
+        if (this->pcall(1) != DUK_EXEC_SUCCESS)
+        {
+            duk_throw(ctx);
+        }
     }
     /*! Calls global function
         \param[in] function a function
@@ -624,7 +781,10 @@ public:
         duk_get_global_string(ctx, function);
         dukpp03::PushValue<_T1, Self>::perform(this, v1);
         dukpp03::PushValue<_T2, Self>::perform(this, v2);
-        duk_call(ctx, 2);
+        if (this->pcall(2) != DUK_EXEC_SUCCESS)
+        {
+            duk_throw(ctx);
+        }
     }
     /*! Calls global function
         \param[in] function a function
@@ -640,7 +800,10 @@ public:
         dukpp03::PushValue<_T1, Self>::perform(this, v1);
         dukpp03::PushValue<_T2, Self>::perform(this, v2);
         dukpp03::PushValue<_T3, Self>::perform(this, v3);
-        duk_call(ctx, 3);
+        if (this->pcall(3) != DUK_EXEC_SUCCESS)
+        {
+            duk_throw(ctx);
+        }
     }
     /*! Calls global function
         \param[in] function a function
@@ -658,7 +821,10 @@ public:
         dukpp03::PushValue<_T2, Self>::perform(this, v2);
         dukpp03::PushValue<_T3, Self>::perform(this, v3);
         dukpp03::PushValue<_T4, Self>::perform(this, v4);
-        duk_call(ctx, 4);
+        if (this->pcall(4) != DUK_EXEC_SUCCESS)
+        {
+            duk_throw(ctx);
+        }
     }
     /*! Calls global function
         \param[in] function a function
@@ -678,7 +844,10 @@ public:
         dukpp03::PushValue<_T3, Self>::perform(this, v3);
         dukpp03::PushValue<_T4, Self>::perform(this, v4);
         dukpp03::PushValue<_T5, Self>::perform(this, v5);
-        duk_call(ctx, 5);
+        if (this->pcall(5) != DUK_EXEC_SUCCESS)
+        {
+            duk_throw(ctx);
+        }
     }
     /*! Calls global function
         \param[in] function a function
@@ -700,7 +869,10 @@ public:
         dukpp03::PushValue<_T4, Self>::perform(this, v4);
         dukpp03::PushValue<_T5, Self>::perform(this, v5);
         dukpp03::PushValue<_T6, Self>::perform(this, v6);
-        duk_call(ctx, 6);
+        if (this->pcall(6) != DUK_EXEC_SUCCESS)
+        {
+            duk_throw(ctx);
+        }
     }
     /*! Calls global function
         \param[in] function a function
@@ -724,7 +896,10 @@ public:
         dukpp03::PushValue<_T5, Self>::perform(this, v5);
         dukpp03::PushValue<_T6, Self>::perform(this, v6);
         dukpp03::PushValue<_T7, Self>::perform(this, v7);
-        duk_call(ctx, 7);
+        if (this->pcall(7) != DUK_EXEC_SUCCESS)
+        {
+            duk_throw(ctx);
+        }
     }
     /*! Calls global function
         \param[in] function a function
@@ -750,9 +925,48 @@ public:
         dukpp03::PushValue<_T6, Self>::perform(this, v6);
         dukpp03::PushValue<_T7, Self>::perform(this, v7);
         dukpp03::PushValue<_T8, Self>::perform(this, v8);
-        duk_call(ctx, 8);
+        if (this->pcall(8) != DUK_EXEC_SUCCESS)
+        {
+            duk_throw(ctx);
+        }
     }
 protected:
+    /*! Defines attribute for object below key on stack top
+        \param[in] getter a getter
+        \param[in] should_own_getter whether context should own getter
+        \param[in] setter a setter
+        \param[in] should_own_setter whether context should own setter
+     */
+    void defineAttribute(LocalCallable* getter, bool should_own_getter, LocalCallable* setter, bool should_own_setter)
+    {
+        duk_idx_t obj = -2;
+        duk_uint_t flags = DUK_DEFPROP_HAVE_CONFIGURABLE | DUK_DEFPROP_HAVE_ENUMERABLE | DUK_DEFPROP_ENUMERABLE | DUK_DEFPROP_FORCE;
+        if (getter)
+        {
+            flags = flags | DUK_DEFPROP_HAVE_GETTER;
+            this->dukpp03::AbstractContext::pushCallable(getter, should_own_getter, true);
+            obj -= 1;
+        }
+        
+        if (setter)
+        {
+            flags = flags | DUK_DEFPROP_HAVE_SETTER;
+            this->dukpp03::AbstractContext::pushCallable(setter, should_own_setter, true);
+            obj -= 1;
+        }
+        duk_def_prop(m_context, obj, flags);
+    }
+    /*! Registers variant, owned by object, and stores handle of registration in object
+        \param[in] obj an index of object on stack
+        \param[in] v variant
+        \param[in] type a tag of type of value in variant or nullptr if it's unknown
+     */
+    void registerVariant(duk_idx_t obj, Variant* v, const void* type = nullptr)
+    {
+        const dukpp03::VariantRegistry::Handle handle = m_registered_objects.insert(v, type);
+        duk_push_number(m_context, static_cast<duk_double_t>(handle));
+        this->putProperty(obj, dukpp03::AbstractContext::VariantKey);
+    }
     /*! Starts evaluating object, needed for data
      */
     virtual void startEvaluating() override
@@ -790,6 +1004,9 @@ protected:
     /*! A timeout timer for context
      */
     Timer m_timeout_timer;
+    /*! A pool for variants, pushed via pushValueAsVariant
+     */
+    dukpp03::PoolAllocator m_variant_pool;
 };
 
 template<
@@ -797,33 +1014,37 @@ template<
 >
 typename _Context::Variant* Finalizer<_Context>::getVariantToFinalize(duk_context* ctx)
 {
-    if (duk_is_object(ctx, 0))
-    {
-        typename _Context::Variant* result = nullptr;
-        duk_get_prop_string(ctx, 0, DUKPP03_VARIANT_PROPERTY_SIGNATURE);
-        if (duk_is_pointer(ctx, -1))
-        {
-            void* ptr = duk_to_pointer(ctx, -1);
-            result = static_cast<typename _Context::Variant*>(ptr);
-        }
-        duk_pop(ctx);
-        return result;
-    }
-    return nullptr;
+    _Context* parent = static_cast<_Context*>(dukpp03::AbstractContext::getContext(ctx));
+    return parent->registeredVariant(parent->variantHandle(ctx, 0));
 }
 
+template<
+    typename _Context
+>
+typename _Context::Variant* Finalizer<_Context>::claimVariantToFinalize(duk_context* ctx)
+{
+    _Context* parent = static_cast<_Context*>(dukpp03::AbstractContext::getContext(ctx));
+    return parent->unregisterVariant(parent->variantHandle(ctx, 0));
+}
 
 template<
     typename _Context
 >
 duk_ret_t Finalizer<_Context>::finalize(duk_context *ctx)
 {    
-    typename _Context::Variant* variant = Finalizer<_Context>::getVariantToFinalize(ctx);
-    _Context* parent  = static_cast<_Context*>(dukpp03::AbstractContext::getContext(ctx));
-    if (variant && parent->isVariantRegistered(variant)) 
+    delete Finalizer<_Context>::claimVariantToFinalize(ctx);
+    return 0;
+}
+
+template<
+    typename _Context
+>
+duk_ret_t Finalizer<_Context>::finalizePooled(duk_context *ctx)
+{    
+    typename _Context::Variant* variant = Finalizer<_Context>::claimVariantToFinalize(ctx);
+    if (variant) 
     {
-        delete variant;
-        parent->unregisterVariant(variant);
+        static_cast<_Context*>(dukpp03::AbstractContext::getContext(ctx))->destroyPooledVariant(variant);
     }
     return 0;
 }
@@ -0,0 +1,302 @@
+/*! \file contextpool.h
+
+    Defines a pool of pre-warmed contexts, which are lent out and scrubbed, when returned
+ */
+#pragma once
+#include "contexttemplate.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <stdexcept>
+
+namespace dukpp03
+{
+
+/*! Metrics of context pool. All times are in seconds
+ */
+struct ContextPoolMetrics
+{
+    /*! Amount of borrowed contexts
+     */
+    unsigned long long Borrows;
+    /*! Amount of returned contexts
+     */
+    unsigned long long Returns;
+    /*! Amount of borrows, which found pool empty and had to wait or failed
+     */
+    unsigned long long Exhaustions;
+    /*! Amount of returned contexts, which could not be scrubbed and were fully reset
+     */
+    unsigned long long FullResets;
+    /*! A total time, spent in borrowing contexts, including waiting for them
+     */
+    double TotalBorrowTime;
+    /*! A maximal time, spent in borrowing a context
+     */
+    double MaxBorrowTime;
+    /*! A total time, spent in scrubbing returned contexts
+     */
+    double TotalScrubTime;
+    /*! A maximal time, spent in scrubbing a context
+     */
+    double MaxScrubTime;
+
+    /*! Constructs empty metrics
+     */
+    ContextPoolMetrics()
+    : Borrows(0), Returns(0), Exhaustions(0), FullResets(0),
+    TotalBorrowTime(0), MaxBorrowTime(0), TotalScrubTime(0), MaxScrubTime(0)
+    {
+
+    }
+};
+
+/*! A pool of pre-warmed contexts. All contexts are created at once and initialized with template.
+    After initialization state of global object is saved for each context. When context is returned
+    into pool, it's scrubbed: own properties of global object are restored to saved state, value stack
+    is cleaned and garbage collection is run. Heap and class bindings are kept, so next borrower
+    gets context without paying for creation and initialization.
+
+    State of context, kept outside of heap, is saved too. Limits of evaluation (maximal amount of instructions,
+    maximal execution time, watchdog and cancellation token) are restored, when context is returned. Callables,
+    owned by context, and class bindings could not be removed safely, since heap could still refer to them,
+    so if borrower added callables or changed class bindings, context is reset instead of scrubbing.
+
+    Note, that changes, made to objects, referenced by global object (e.g. adding property to Math), are not
+    reverted. If scrubbing fails, context is reset and initialized again with template.
+
+    Borrowing and returning contexts is thread-safe, but each context must be used only by one thread at time.
+ */
+template<
+    typename _Context
+>
+class ContextPool
+{
+public:
+    /*! Creates new pool. Template must be alive, while pool exists
+        \param[in] size amount of contexts in pool
+        \param[in] t a template for initializing contexts, could be nullptr
+     */
+    ContextPool(size_t size, const dukpp03::ContextTemplate<_Context>* t = nullptr) : m_template(t)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            _Context* ctx = new _Context();
+            m_states[ctx] = typename ContextPool<_Context>::State();
+            this->init(ctx);
+            m_contexts.push_back(ctx);
+            m_free.push_back(ctx);
+        }
+    }
+    /*! Destroys all contexts. All contexts must be returned into pool before it's destroyed
+     */
+    ~ContextPool()
+    {
+        for(size_t i = 0; i < m_contexts.size(); i++)
+        {
+            delete m_contexts[i];
+        }
+    }
+    /*! Borrows context from pool, waiting for free context if pool is exhausted
+        \return context
+     */
+    _Context* borrow()
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_free.empty())
+        {
+            ++m_metrics.Exhaustions;
+            m_available.wait(lock, [this] { return !m_free.empty(); });
+        }
+        _Context* result = m_free.back();
+        m_free.pop_back();
+        ++m_metrics.Borrows;
+        addTime(m_metrics.TotalBorrowTime, m_metrics.MaxBorrowTime, start);
+        return result;
+    }
+    /*! Tries to borrow context from pool without waiting
+        \return context or nullptr if pool is exhausted
+     */
+    _Context* tryBorrow()
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.empty())
+        {
+            ++m_metrics.Exhaustions;
+            return nullptr;
+        }
+        _Context* result = m_free.back();
+        m_free.pop_back();
+        ++m_metrics.Borrows;
+        addTime(m_metrics.TotalBorrowTime, m_metrics.MaxBorrowTime, start);
+        return result;
+    }
+    /*! Scrubs context and returns it into pool
+        \param[in] ctx context, borrowed from this pool
+     */
+    void giveBack(_Context* ctx)
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool full_reset = false;
+        ctx->cleanStack();
+        const typename ContextPool<_Context>::State& state = m_states.find(ctx)->second;
+        ctx->setMaximumInstructions(state.MaximumInstructions);
+        ctx->setMaximumExecutionTime(state.MaximumExecutionTime);
+        ctx->setWatchdog(state.Watchdog);
+        ctx->setCancellationToken(state.CancellationToken);
+        if (ctx->ownedCallableCount() != state.OwnedCallables
+            || ctx->classBindings() != state.ClassBindings
+            || !ctx->restoreGlobalState())
+        {
+            ctx->reset();
+            this->init(ctx);
+            full_reset = true;
+        }
+        // Second pass frees objects, which were resurrected by finalizers in first pass
+        duk_gc(ctx->context(), 0);
+        duk_gc(ctx->context(), 0);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_metrics.Returns;
+            if (full_reset)
+            {
+                ++m_metrics.FullResets;
+            }
+            addTime(m_metrics.TotalScrubTime, m_metrics.MaxScrubTime, start);
+            m_free.push_back(ctx);
+        }
+        m_available.notify_one();
+    }
+    /*! Returns amount of contexts in pool
+        \return amount of contexts
+     */
+    size_t size() const
+    {
+        return m_contexts.size();
+    }
+    /*! Returns amount of contexts, which could be borrowed now
+        \return amount of contexts
+     */
+    size_t available() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_free.size();
+    }
+    /*! Returns metrics of pool
+        \return metrics
+     */
+    dukpp03::ContextPoolMetrics metrics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_metrics;
+    }
+    /*! Resets metrics of pool
+     */
+    void resetMetrics()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_metrics = dukpp03::ContextPoolMetrics();
+    }
+private:
+    /*! A state of context outside of heap, saved after initialization
+     */
+    struct State
+    {
+        /*! A maximal amount of bytecode instructions for evaluation
+         */
+        unsigned long long MaximumInstructions;
+        /*! A maximal execution time
+         */
+        double MaximumExecutionTime;
+        /*! A watchdog for tracking execution time
+         */
+        dukpp03::Watchdog* Watchdog;
+        /*! A token for cancelling evaluations
+         */
+        dukpp03::CancellationToken* CancellationToken;
+        /*! An amount of callables, owned by context
+         */
+        size_t OwnedCallables;
+        /*! Class bindings of context
+         */
+        std::vector<dukpp03::ClassBinding<_Context>*> ClassBindings;
+    };
+    /*! A pool is non-copyable
+        \param[in] o other pool
+     */
+    ContextPool(const ContextPool& o)
+    {
+        throw std::logic_error("dukpp03::ContextPool is non-copyable!");
+    }
+    /*! A pool is non-copyable
+        \param[in] o other pool
+        \return self-reference
+     */
+    ContextPool& operator=(const ContextPool& o)
+    {
+        throw std::logic_error("dukpp03::ContextPool is non-copyable!");
+        return *this;
+    }
+    /*! Initializes context with template and saves it's state
+        \param[in] ctx context
+     */
+    void init(_Context* ctx)
+    {
+        if (m_template)
+        {
+            m_template->apply(ctx);
+        }
+        ctx->cleanStack();
+        ctx->saveGlobalState();
+        // Entries are only looked up after construction, so other threads could read map meanwhile
+        typename ContextPool<_Context>::State& state = m_states.find(ctx)->second;
+        state.MaximumInstructions = ctx->maximumInstructions();
+        state.MaximumExecutionTime = ctx->maximumExecutionTime();
+        state.Watchdog = ctx->watchdog();
+        state.CancellationToken = ctx->cancellationToken();
+        state.OwnedCallables = ctx->ownedCallableCount();
+        state.ClassBindings = ctx->classBindings();
+    }
+    /*! Adds time, elapsed from start to total and maximal time
+        \param[in,out] total a total time
+        \param[in,out] max a maximal time
+        \param[in] start a starting point
+     */
+    static void addTime(double& total, double& max, const std::chrono::steady_clock::time_point& start)
+    {
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        total += elapsed;
+        if (elapsed > max)
+        {
+            max = elapsed;
+        }
+    }
+    /*! A template for contexts
+     */
+    const dukpp03::ContextTemplate<_Context>* m_template;
+    /*! All contexts of pool
+     */
+    std::vector<_Context*> m_contexts;
+    /*! Contexts, which could be borrowed
+     */
+    std::vector<_Context*> m_free;
+    /*! Saved states of contexts
+     */
+    std::unordered_map<_Context*, typename ContextPool<_Context>::State> m_states;
+    /*! A lock for list of free contexts and metrics
+     */
+    mutable std::mutex m_mutex;
+    /*! A condition, signalled when context is returned
+     */
+    std::condition_variable m_available;
+    /*! Metrics of pool
+     */
+    dukpp03::ContextPoolMetrics m_metrics;
+};
+
+}
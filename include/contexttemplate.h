@@ -0,0 +1,375 @@
+/*! \file contexttemplate.h
+
+    Defines a template for contexts, which could be used to create a lot of contexts with same bindings
+ */
+#pragma once
+#include "classbinding.h"
+#include "bundle.h"
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace dukpp03
+{
+
+/*! A template for contexts. Records registration of class bindings, callables, globals and bootstrap scripts,
+    and replays them in the same order into new or reset contexts. Scripts are compiled only once, when added
+    into template, so new contexts are initialized only by loading bytecode and copying bindings.
+
+    Template owns all of bindings and callables, added to it, and copies them into each context, so
+    they must be copyable (class bindings are copied via dukpp03::ClassBinding copy constructor, callables
+    via clone).
+ */
+template<
+    typename _Context
+>
+class ContextTemplate
+{
+public:
+    /*! A step of initialization of context
+     */
+    class Step
+    {
+    public:
+        /*! Applies step to context
+            \param[in] ctx context
+            \param[out] error an error, if any
+            \return true on success
+         */
+        virtual bool apply(_Context* ctx, std::string* error) const = 0;
+        /*! Could be inherited
+         */
+        virtual ~Step()
+        {
+
+        }
+    };
+    /*! A step, which adds copy of class binding into context
+     */
+    class ClassBindingStep: public Step
+    {
+    public:
+        /*! Constructs new step
+            \param[in] name a name for binding
+            \param[in] c binding
+         */
+        ClassBindingStep(const std::string& name, dukpp03::ClassBinding<_Context>* c) : m_name(name), m_binding(c)
+        {
+
+        }
+        /*! Applies step to context
+            \param[in] ctx context
+            \param[out] error an error, if any
+            \return true on success
+         */
+        virtual bool apply(_Context* ctx, std::string* error) const override
+        {
+            dukpp03::ClassBinding<_Context>* c = new dukpp03::ClassBinding<_Context>(*m_binding);
+            if (!ctx->addClassBinding(m_name, c))
+            {
+                delete c;
+            }
+            return true;
+        }
+        /*! Frees binding
+         */
+        virtual ~ClassBindingStep() override
+        {
+            delete m_binding;
+        }
+    private:
+        /*! A name for binding
+         */
+        std::string m_name;
+        /*! A binding
+         */
+        dukpp03::ClassBinding<_Context>* m_binding;
+    };
+    /*! A step, which registers clone of callable as property of global object
+     */
+    class CallableStep: public Step
+    {
+    public:
+        /*! Constructs new step
+            \param[in] name a name of property of global object
+            \param[in] c callable
+         */
+        CallableStep(const std::string& name, dukpp03::Callable<_Context>* c) : m_name(name), m_callable(c)
+        {
+
+        }
+        /*! Applies step to context
+            \param[in] ctx context
+            \param[out] error an error, if any
+            \return true on success
+         */
+        virtual bool apply(_Context* ctx, std::string* error) const override
+        {
+            ctx->registerCallable(m_name, m_callable->clone());
+            return true;
+        }
+        /*! Frees callable
+         */
+        virtual ~CallableStep() override
+        {
+            delete m_callable;
+        }
+    private:
+        /*! A name of property of global object
+         */
+        std::string m_name;
+        /*! A callable
+         */
+        dukpp03::Callable<_Context>* m_callable;
+    };
+    /*! A step, which registers global variable
+     */
+    template<
+        typename _Value
+    >
+    class GlobalStep: public Step
+    {
+    public:
+        /*! Constructs new step
+            \param[in] name a name of property of global object
+            \param[in] value a value
+         */
+        GlobalStep(const std::string& name, const _Value& value) : m_name(name), m_value(value)
+        {
+
+        }
+        /*! Applies step to context
+            \param[in] ctx context
+            \param[out] error an error, if any
+            \return true on success
+         */
+        virtual bool apply(_Context* ctx, std::string* error) const override
+        {
+            ctx->registerGlobal(m_name, m_value);
+            return true;
+        }
+    private:
+        /*! A name of property of global object
+         */
+        std::string m_name;
+        /*! A value
+         */
+        _Value m_value;
+    };
+    /*! A step, which runs precompiled script
+     */
+    class ScriptStep: public Step
+    {
+    public:
+        /*! Constructs new step
+            \param[in] name a name of script
+            \param[in] bytecode a bytecode of script
+         */
+        ScriptStep(const std::string& name, const std::vector<unsigned char>& bytecode) : m_name(name), m_bytecode(bytecode)
+        {
+
+        }
+        /*! Applies step to context
+            \param[in] ctx context
+            \param[out] error an error, if any
+            \return true on success
+         */
+        virtual bool apply(_Context* ctx, std::string* error) const override
+        {
+            return ctx->runBytecode(m_bytecode, m_name, error);
+        }
+    private:
+        /*! A name of script
+         */
+        std::string m_name;
+        /*! A bytecode of script
+         */
+        std::vector<unsigned char> m_bytecode;
+    };
+    /*! A step, which loads bundle from file
+     */
+    class BundleStep: public Step
+    {
+    public:
+        /*! Constructs new step
+            \param[in] path a path to bundle
+         */
+        BundleStep(const std::string& path) : m_path(path)
+        {
+
+        }
+        /*! Applies step to context
+            \param[in] ctx context
+            \param[out] error an error, if any
+            \return true on success
+         */
+        virtual bool apply(_Context* ctx, std::string* error) const override
+        {
+            return ctx->loadBundle(m_path, error);
+        }
+    private:
+        /*! A path to bundle
+         */
+        std::string m_path;
+    };
+
+    /*! Creates empty template
+     */
+    ContextTemplate()
+    {
+
+    }
+    /*! Frees all steps
+     */
+    ~ContextTemplate()
+    {
+        clear();
+    }
+    /*! Adds new class binding into template. Template takes ownership of binding
+        \param[in] name a type name for binding, use Context::typeName() to obtain it
+        \param[in] c binding
+     */
+    void addClassBinding(const std::string& name, dukpp03::ClassBinding<_Context>* c)
+    {
+        m_steps.push_back(new ClassBindingStep(name, c));
+    }
+    /*! Adds new class binding into template. Template takes ownership of binding
+        \param[in] c binding
+     */
+    template<
+        typename T
+    >
+    void addClassBinding(dukpp03::ClassBinding<_Context>* c)
+    {
+        addClassBinding(_Context::template typeName<T>(), c);
+    }
+    /*! Registers callable as property of global object. Template takes ownership of callable
+        \param[in] callable_name name of property of global object
+        \param[in] callable a callable object
+     */
+    void registerCallable(const std::string& callable_name, dukpp03::Callable<_Context>* callable)
+    {
+        m_steps.push_back(new CallableStep(callable_name, callable));
+    }
+    /*! Registers global variable. Value is copied into each context
+        \param[in] property_name name of new property of global object
+        \param[in] value a value to be registered
+     */
+    template<
+        typename T
+    >
+    void registerGlobal(const std::string& property_name, const T& value)
+    {
+        m_steps.push_back(new GlobalStep<T>(property_name, value));
+    }
+    /*! Compiles script and adds it into template. Script is run as program, so
+        it's variables and functions become global
+        \param[in] source a source code
+        \param[in] filename a file name, used in error messages
+        \param[out] error an error, if any
+        \return true, if script is compiled
+     */
+    bool addScript(const std::string& source, const std::string& filename, std::string* error = nullptr)
+    {
+        std::vector<unsigned char> bytecode;
+        if (!dukpp03::Bundle::compile(dukpp03::Bundle::Source(filename, source), bytecode, error))
+        {
+            return false;
+        }
+        m_steps.push_back(new ScriptStep(filename, bytecode));
+        return true;
+    }
+    /*! Adds bundle, which will be loaded into each context
+        \param[in] path a path to bundle
+     */
+    void addBundle(const std::string& path)
+    {
+        m_steps.push_back(new BundleStep(path));
+    }
+    /*! Adds custom step into template. Template takes ownership of step
+        \param[in] step a step
+     */
+    void addStep(Step* step)
+    {
+        m_steps.push_back(step);
+    }
+    /*! Applies all steps to context in order they were added into template
+        \param[in] ctx context
+        \param[out] error an error, if any
+        \return true on success
+     */
+    bool apply(_Context* ctx, std::string* error = nullptr) const
+    {
+        for(size_t i = 0; i < m_steps.size(); i++)
+        {
+            if (!m_steps[i]->apply(ctx, error))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    /*! Creates new context and applies template to it
+        \param[out] error an error, if any
+        \return new context or nullptr if some step failed
+     */
+    _Context* create(std::string* error = nullptr) const
+    {
+        _Context* ctx = new _Context();
+        if (!apply(ctx, error))
+        {
+            delete ctx;
+            return nullptr;
+        }
+        return ctx;
+    }
+    /*! Resets context and applies template to it, so it's state becomes same as of newly created
+        \param[in] ctx context
+        \param[out] error an error, if any
+        \return true on success
+     */
+    bool reset(_Context* ctx, std::string* error = nullptr) const
+    {
+        ctx->reset();
+        return apply(ctx, error);
+    }
+    /*! Returns amount of steps in template
+        \return amount of steps
+     */
+    size_t size() const
+    {
+        return m_steps.size();
+    }
+    /*! Removes all steps from template
+     */
+    void clear()
+    {
+        for(size_t i = 0; i < m_steps.size(); i++)
+        {
+            delete m_steps[i];
+        }
+        m_steps.clear();
+    }
+private:
+    /*! A template is non-copyable
+        \param[in] o other template
+     */
+    ContextTemplate(const ContextTemplate& o)
+    {
+        throw std::logic_error("dukpp03::ContextTemplate is non-copyable!");
+    }
+    /*! A template is non-copyable
+        \param[in] o other template
+        \return self-reference
+     */
+    ContextTemplate& operator=(const ContextTemplate& o)
+    {
+        throw std::logic_error("dukpp03::ContextTemplate is non-copyable!");
+        return *this;
+    }
+    /*! Steps of initialization of context
+     */
+    std::vector<Step*> m_steps;
+};
+
+}
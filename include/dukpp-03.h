@@ -9,6 +9,11 @@
 #include "removepointer.h"
 #include "errorcodes.h"
 #include "context.h"
+#include "stringref.h"
+#include "bufferview.h"
+#include "containers.h"
+#include "exactinteger.h"
+#include "serialization.h"
 #include "function.h"
 #include "method.h"
 #include "thismethod.h"
@@ -19,4 +24,5 @@
 #include "getfield.h"
 #include "setfield.h"
 #include "classbinding.h"
-#include "jsobject.h"
\ No newline at end of file
+#include "jsobject.h"
+#include "contexttemplate.h"
\ No newline at end of file
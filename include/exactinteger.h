@@ -0,0 +1,254 @@
+/*! \file exactinteger.h
+
+    Defines a wrapper for 64-bit integers, which are passed to scripts without loss of precision
+ */
+#pragma once
+#include "duk_custom.h"
+#include "../duktape/src/duktape.h"
+#include "maybe.h"
+#include <cstddef>
+#include <string>
+#include <limits>
+#include <type_traits>
+
+namespace dukpp03
+{
+
+template<
+    typename _Value,
+    typename _Context
+>
+class PushValue;
+
+template<
+    typename _Value,
+    typename _Context
+>
+class GetValue;
+
+namespace internal
+{
+
+/*! A maximal integer, which could be represented by number in script exactly, i.e. 2^53 - 1
+ */
+const long long MaximalSafeInteger = 9007199254740991LL;
+
+/*! Parses decimal integer. Whole string must be an optional minus followed by digits
+    \param[in] s string
+    \param[in] length a length of string
+    \param[out] result a result
+    \return true if string is parsed and fits into type
+ */
+bool parseInteger(const char* s, size_t length, long long& result);
+
+/*! Parses decimal unsigned integer. Whole string must consist of digits
+    \param[in] s string
+    \param[in] length a length of string
+    \param[out] result a result
+    \return true if string is parsed and fits into type
+ */
+bool parseInteger(const char* s, size_t length, unsigned long long& result);
+
+}
+
+/*! A 64-bit integer, passed to scripts without loss of precision. Since Duktape has no BigInt and
+    numbers in scripts are doubles, integers, whose absolute value is bigger than 2^53 - 1, are
+    pushed as decimal strings. When read from stack, integer could be either number, which is
+    represented exactly, or decimal string.
+
+    Use plain long long to get a number, which is exact up to 2^53 and rounded beyond it.
+ */
+template<
+    typename _Integer
+>
+class ExactInteger
+{
+public:
+    /*! Constructs zero
+     */
+    ExactInteger() : m_value(0)
+    {
+
+    }
+    /*! Constructs integer
+        \param[in] v value
+     */
+    ExactInteger(_Integer v) : m_value(v)
+    {
+
+    }
+    /*! Returns value
+        \return value
+     */
+    _Integer value() const
+    {
+        return m_value;
+    }
+    /*! Converts to underlying type
+        \return value
+     */
+    operator _Integer() const
+    {
+        return m_value;
+    }
+    /*! Returns true, if integer could be represented by number in script exactly
+        \return whether integer is safe
+     */
+    bool isSafe() const
+    {
+        return dukpp03::ExactInteger<_Integer>::isSafe(m_value, std::is_signed<_Integer>());
+    }
+    /*! Pushes integer on stack as number if it's safe or as decimal string otherwise
+        \param[in] ctx context
+     */
+    void push(duk_context* ctx) const
+    {
+        if (this->isSafe())
+        {
+            duk_push_number(ctx, static_cast<duk_double_t>(m_value));
+        }
+        else
+        {
+            const std::string s = std::to_string(m_value);
+            duk_push_lstring(ctx, s.c_str(), s.size());
+        }
+    }
+    /*! Reads integer from stack. Number must be integral and safe, string must be decimal integer
+        \param[in] ctx context
+        \param[in] pos a position of value on stack
+        \return integer if it could be read exactly
+     */
+    static dukpp03::Maybe<dukpp03::ExactInteger<_Integer> > fromStack(duk_context* ctx, duk_idx_t pos)
+    {
+        dukpp03::Maybe<dukpp03::ExactInteger<_Integer> > result;
+        if (duk_is_number(ctx, pos))
+        {
+            const double v = duk_get_number(ctx, pos);
+            if (v >= -static_cast<double>(dukpp03::internal::MaximalSafeInteger)
+                && v <= static_cast<double>(dukpp03::internal::MaximalSafeInteger)
+                && static_cast<double>(static_cast<long long>(v)) == v)
+            {
+                dukpp03::ExactInteger<_Integer>::narrow(static_cast<long long>(v), result);
+            }
+        }
+        else
+        {
+            duk_size_t length = 0;
+            const char* s = duk_get_lstring(ctx, pos, &length);
+            if (s)
+            {
+                typename dukpp03::ExactInteger<_Integer>::Wide v = 0;
+                if (dukpp03::internal::parseInteger(s, length, v))
+                {
+                    dukpp03::ExactInteger<_Integer>::narrow(v, result);
+                }
+            }
+        }
+        return result;
+    }
+private:
+    /*! A widest integer type with same signedness
+     */
+    typedef typename std::conditional<std::is_signed<_Integer>::value, long long, unsigned long long>::type Wide;
+    /*! Checks, whether signed integer is safe
+        \param[in] v value
+        \return whether integer is safe
+     */
+    static bool isSafe(_Integer v, std::true_type)
+    {
+        return v >= -dukpp03::internal::MaximalSafeInteger && v <= dukpp03::internal::MaximalSafeInteger;
+    }
+    /*! Checks, whether unsigned integer is safe
+        \param[in] v value
+        \return whether integer is safe
+     */
+    static bool isSafe(_Integer v, std::false_type)
+    {
+        return v <= static_cast<unsigned long long>(dukpp03::internal::MaximalSafeInteger);
+    }
+    /*! Sets result, if value fits into type
+        \param[in] v value
+        \param[out] result a result
+     */
+    static void narrow(long long v, dukpp03::Maybe<dukpp03::ExactInteger<_Integer> >& result)
+    {
+        if (std::is_signed<_Integer>::value)
+        {
+            if (v >= static_cast<long long>(std::numeric_limits<_Integer>::min()) && v <= static_cast<long long>(std::numeric_limits<_Integer>::max()))
+            {
+                result.setValue(dukpp03::ExactInteger<_Integer>(static_cast<_Integer>(v)));
+            }
+        }
+        else
+        {
+            if (v >= 0)
+            {
+                dukpp03::ExactInteger<_Integer>::narrow(static_cast<unsigned long long>(v), result);
+            }
+        }
+    }
+    /*! Sets result, if value fits into type
+        \param[in] v value
+        \param[out] result a result
+     */
+    static void narrow(unsigned long long v, dukpp03::Maybe<dukpp03::ExactInteger<_Integer> >& result)
+    {
+        if (v <= static_cast<unsigned long long>(std::numeric_limits<_Integer>::max()))
+        {
+            result.setValue(dukpp03::ExactInteger<_Integer>(static_cast<_Integer>(v)));
+        }
+    }
+    /*! A value
+     */
+    _Integer m_value;
+};
+
+/*! A signed 64-bit integer without loss of precision
+ */
+typedef dukpp03::ExactInteger<long long> ExactInt64;
+/*! An unsigned 64-bit integer without loss of precision
+ */
+typedef dukpp03::ExactInteger<unsigned long long> ExactUInt64;
+
+/*! Makes possible to pass exact integers to functions
+ */
+template<
+    typename _Integer,
+    typename _Context
+>
+class GetValue<dukpp03::ExactInteger<_Integer>, _Context>
+{
+public:
+    /*! Performs getting value from stack
+        \param[in] ctx context
+        \param[in] pos index for stack
+        \return a value if it could be read exactly, otherwise empty maybe
+     */
+    static dukpp03::Maybe<dukpp03::ExactInteger<_Integer> > perform(_Context* ctx, duk_idx_t pos)
+    {
+        // Whether integer could be read depends on it's value and range of type
+        ctx->setValueDependentMatch(true);
+        return dukpp03::ExactInteger<_Integer>::fromStack(ctx->context(), pos);
+    }
+};
+
+/*! Makes possible to return exact integers from functions
+ */
+template<
+    typename _Integer,
+    typename _Context
+>
+class PushValue<dukpp03::ExactInteger<_Integer>, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value
+     */
+    static void perform(_Context* ctx, const dukpp03::ExactInteger<_Integer>& v)
+    {
+        v.push(ctx->context());
+    }
+};
+
+}
@@ -0,0 +1,119 @@
+/*! \file externalbuffer.h
+
+    Defines a memory block, owned by C++ code, which could be exposed to scripts as ArrayBuffer
+    or typed array without copying it
+ */
+#pragma once
+#include "duk_custom.h"
+#include "../duktape/src/duktape.h"
+#include <cstddef>
+#include <vector>
+
+namespace dukpp03
+{
+
+/*! A memory block, which could be pushed into context via dukpp03::AbstractContext::pushExternalBuffer.
+    Scripts work with block directly, and heap owns it after pushing, deleting it, when last ArrayBuffer
+    or view, referencing it, is collected or heap is destroyed.
+
+    Block must not move or change size, while it's owned by heap. Note, that plain buffer, taken from view
+    via Uint8Array.plainOf, does not keep block alive and must not outlive views of block.
+ */
+class ExternalBuffer
+{
+public:
+    /*! Constructs new buffer
+     */
+    ExternalBuffer();
+    /*! Could be inherited, frees memory block
+     */
+    virtual ~ExternalBuffer();
+    /*! Returns memory block
+        \return memory block
+     */
+    virtual void* data() = 0;
+    /*! Returns size of memory block in bytes
+        \return size of memory block
+     */
+    virtual size_t size() const = 0;
+    /*! A finalizer for ArrayBuffer, which detaches it from buffer and deletes buffer
+        \param[in] ctx context
+        \return 0
+     */
+    static duk_ret_t finalize(duk_context* ctx);
+private:
+    /*! A buffer is non-copyable
+        \param[in] o other buffer
+     */
+    ExternalBuffer(const dukpp03::ExternalBuffer& o);
+    /*! A buffer is non-copyable
+        \param[in] o other buffer
+        \return self-reference
+     */
+    dukpp03::ExternalBuffer& operator=(const dukpp03::ExternalBuffer& o);
+};
+
+/*! A buffer, which owns elements of vector
+ */
+template<
+    typename _Element
+>
+class VectorBuffer: public dukpp03::ExternalBuffer
+{
+public:
+    /*! Constructs buffer with specified amount of zero elements
+        \param[in] count amount of elements
+     */
+    VectorBuffer(size_t count) : m_elements(count)
+    {
+
+    }
+    /*! Constructs buffer, taking ownership of elements of vector
+        \param[in] elements elements. Vector is left empty
+     */
+    VectorBuffer(std::vector<_Element>& elements)
+    {
+        m_elements.swap(elements);
+    }
+    /*! Returns memory block
+        \return memory block
+     */
+    virtual void* data() override
+    {
+        return m_elements.data();
+    }
+    /*! Returns size of memory block in bytes
+        \return size of memory block
+     */
+    virtual size_t size() const override
+    {
+        return m_elements.size() * sizeof(_Element);
+    }
+    /*! Returns amount of elements
+        \return amount of elements
+     */
+    size_t count() const
+    {
+        return m_elements.size();
+    }
+    /*! Returns element
+        \param[in] i an index of element
+        \return element
+     */
+    _Element& operator[](size_t i)
+    {
+        return m_elements[i];
+    }
+    /*! Frees elements
+     */
+    virtual ~VectorBuffer() override
+    {
+
+    }
+private:
+    /*! Elements of buffer
+     */
+    std::vector<_Element> m_elements;
+};
+
+}
@@ -0,0 +1,152 @@
+/*! \file gcscheduler.h
+
+    Defines a scheduler, which runs garbage collection of context at quiet points, chosen by host
+ */
+#pragma once
+#include "abstractcontext.h"
+#include <chrono>
+
+namespace dukpp03
+{
+
+/*! A histogram of pauses. Bucket i contains pauses, which took from 2^(i-1) to 2^i microseconds,
+    first bucket contains pauses shorter than one microsecond, last one contains all longer pauses
+ */
+class PauseHistogram
+{
+public:
+    /*! An amount of buckets
+     */
+    static const size_t BucketCount = 32;
+    /*! Constructs empty histogram
+     */
+    PauseHistogram();
+    /*! Adds pause into histogram
+        \param[in] seconds a length of pause in seconds
+     */
+    void add(double seconds);
+    /*! Removes all pauses from histogram
+     */
+    void clear();
+    /*! Returns amount of pauses
+        \return amount of pauses
+     */
+    unsigned long long count() const;
+    /*! Returns total length of pauses in seconds
+        \return total length
+     */
+    double total() const;
+    /*! Returns length of longest pause in seconds
+        \return length of longest pause
+     */
+    double maximum() const;
+    /*! Returns amount of pauses in bucket
+        \param[in] i an index of bucket
+        \return amount of pauses or zero if index is invalid
+     */
+    unsigned long long bucket(size_t i) const;
+    /*! Returns upper bound of bucket in seconds
+        \param[in] i an index of bucket
+        \return upper bound
+     */
+    static double bucketBound(size_t i);
+    /*! Returns upper bound for percentile of pauses, e.g. 0.99 for p99. Result is precise up to bucket,
+        but never exceeds longest pause
+        \param[in] p a percentile in range [0, 1]
+        \return upper bound of percentile in seconds
+     */
+    double percentile(double p) const;
+private:
+    /*! Amount of pauses in buckets
+     */
+    unsigned long long m_buckets[dukpp03::PauseHistogram::BucketCount];
+    /*! Amount of pauses
+     */
+    unsigned long long m_count;
+    /*! A total length of pauses
+     */
+    double m_total;
+    /*! A length of longest pause
+     */
+    double m_maximum;
+};
+
+/*! A scheduler of garbage collection for context. Duktape frees most of garbage via reference counting,
+    but cycles are freed only by mark-and-sweep, which Duktape runs voluntarily, when enough allocations
+    were made, so it could pause any callback. Host could call collectIfNeeded at quiet points (between
+    requests, in idle callback), so mark-and-sweep runs there, once enough memory was allocated since last
+    collection. Since Duktape counts allocations from last mark-and-sweep, scheduled collections also
+    postpone voluntary ones.
+
+    Allocation volume is tracked by accounting allocator of context. Without it, scheduler could only
+    collect unconditionally. Scheduler must be used by the same thread, which runs context, and not
+    while context is evaluating.
+ */
+class GCScheduler
+{
+public:
+    /*! A default amount of allocated bytes, after which collection is needed
+     */
+    static const unsigned long long DefaultThreshold = 4 * 1024 * 1024;
+    /*! Creates new scheduler for context
+        \param[in] ctx a context
+        \param[in] allocator an accounting allocator, used by context. If nullptr, collectIfNeeded always collects
+        \param[in] threshold an amount of allocated bytes, after which collection is needed
+     */
+    GCScheduler(
+        dukpp03::AbstractContext* ctx, 
+        dukpp03::AccountingAllocator* allocator = nullptr, 
+        unsigned long long threshold = dukpp03::GCScheduler::DefaultThreshold
+    );
+    /*! Sets amount of allocated bytes, after which collection is needed
+        \param[in] threshold an amount of bytes
+     */
+    void setThreshold(unsigned long long threshold);
+    /*! Returns amount of allocated bytes, after which collection is needed
+        \return amount of bytes
+     */
+    unsigned long long threshold() const;
+    /*! Returns amount of bytes, allocated since last collection by scheduler
+        \return amount of bytes or zero, if scheduler has no allocator
+     */
+    unsigned long long allocatedSinceCollection() const;
+    /*! Returns true, if enough memory was allocated since last collection
+        \return whether collection is needed
+     */
+    bool needed() const;
+    /*! Runs garbage collection, if it's needed. Call it at quiet points
+        \param[in] compact whether objects should be compacted after collection, reducing memory usage
+        \return true if collection was run
+     */
+    bool collectIfNeeded(bool compact = false);
+    /*! Runs garbage collection unconditionally. Two passes are run, since first pass only
+        runs finalizers for some objects and they are freed only by second one
+        \param[in] compact whether objects should be compacted after collection, reducing memory usage
+     */
+    void collect(bool compact = false);
+    /*! Returns histogram of pauses, made by collections of scheduler
+        \return histogram
+     */
+    const dukpp03::PauseHistogram& pauses() const;
+    /*! Removes all pauses from histogram
+     */
+    void clearPauses();
+private:
+    /*! A context
+     */
+    dukpp03::AbstractContext* m_context;
+    /*! An allocator of context
+     */
+    dukpp03::AccountingAllocator* m_allocator;
+    /*! A threshold for collection
+     */
+    unsigned long long m_threshold;
+    /*! A total amount of allocated bytes at last collection
+     */
+    unsigned long long m_allocated_at_collection;
+    /*! A histogram of pauses
+     */
+    dukpp03::PauseHistogram m_pauses;
+};
+
+}
@@ -8,14 +8,15 @@
 #include "context.h"
 #include "maybe.h"
 #include <string>
+#include <limits>
 // ReSharper disable once CppUnusedIncludeDirective
 #include <iostream>
 
 // Fix for MinGW
 #ifndef DUKPP03_VARIANT_PROPERTY_SIGNATURE
-   /*! A property name for an object, which must have this property set to a string variant
+   /*! A property name for an object, which must have this property set to a handle of variant
     */
-   #define DUKPP03_VARIANT_PROPERTY_SIGNATURE "\1dukpp03::Variant\1"
+   #define DUKPP03_VARIANT_PROPERTY_SIGNATURE DUK_HIDDEN_SYMBOL("dukpp03::Variant")
 #endif
 
 namespace dukpp03
@@ -39,28 +40,51 @@ public:
  */
 static void perform(_Context* ctx, duk_idx_t pos, dukpp03::Maybe<_Value>& result)
 {
-    if (duk_is_object(ctx->context(), pos))
+    dukpp03::internal::TryGetValueFromObject<_Value, _Context>::fromVariant(ctx->variantFromObject(pos), result);
+}
+/*! Performs getting value from variant, owned by object
+    \param[in] v variant or nullptr
+    \param[out] result an output value. Won't be changed if result exists, will be set to result otherwise
+ */
+static void fromVariant(typename _Context::Variant* v, dukpp03::Maybe<_Value>& result)
+{
+    if (v)
     {
-       duk_get_prop_string(ctx->context(), pos, DUKPP03_VARIANT_PROPERTY_SIGNATURE);
-        if (duk_is_pointer(ctx->context(), -1))
+        result = _Context::template valueFromVariant<_Value>(v);
+        if (result.exists() == false)
         {
-            void* ptr = duk_to_pointer(ctx->context(), -1);
-            typename _Context::Variant * v = static_cast<typename _Context::Variant *>(ptr);
-            if (v)
-            {
-                result = _Context::template valueFromVariant<_Value>(v);
-                if (result.exists() == false)
-                {
-                    result = _Context::template valueAddressFromVariant<_Value>(v);
-                }
-            }
+            result = _Context::template valueAddressFromVariant<_Value>(v);
         }
-        duk_pop(ctx->context());
     }
 }
 
 };
 
+/*! Converts number to integer type. Fraction is truncated, NaN becomes zero and numbers out of range
+    become nearest bound of type, like in duk_get_int. Numbers up to 2^53 are converted exactly
+    \param[in] v number
+    \return integer
+ */
+template<
+    typename _Integer
+>
+_Integer numberToInteger(double v)
+{
+    if (v != v)
+    {
+        return 0;
+    }
+    if (v <= static_cast<double>(std::numeric_limits<_Integer>::min()))
+    {
+        return std::numeric_limits<_Integer>::min();
+    }
+    if (v >= static_cast<double>(std::numeric_limits<_Integer>::max()))
+    {
+        return std::numeric_limits<_Integer>::max();
+    }
+    return static_cast<_Integer>(v);
+}
+
 }
 
 /*! Performs getting value from a stack for every type of value
@@ -80,11 +104,13 @@ public:
 static dukpp03::Maybe<_Value> perform(_Context* ctx, duk_idx_t pos)
 {
     dukpp03::Maybe<_Value> result;
-    dukpp03::internal::TryGetValueFromObject<_Value, _Context>::perform(ctx, pos, result);
+    // Variant is looked up once for both value and pointer to value
+    typename _Context::Variant* v = ctx->variantFromObject(pos);
+    dukpp03::internal::TryGetValueFromObject<_Value, _Context>::fromVariant(v, result);
     if (result.exists() == false)
     {
         dukpp03::Maybe<_Value*> result2;
-        dukpp03::internal::TryGetValueFromObject<_Value*, _Context>::perform(ctx, pos, result2);
+        dukpp03::internal::TryGetValueFromObject<_Value*, _Context>::fromVariant(v, result2);
         if (result2.exists())
         {
             result.setReference(result2.value());
@@ -141,12 +167,17 @@ public:
 static dukpp03::Maybe<char> perform(_Context* ctx, duk_idx_t pos)
 {
     dukpp03::Maybe<char> result;
-    const dukpp03::Maybe<std::string> tmp = dukpp03::GetValue<std::string, _Context>::perform(ctx, pos);
-    if (tmp.exists())
+    // Character is read from string on stack without copying it
+    duk_size_t length = 0;
+    const char* s = duk_get_lstring(ctx->context(), pos, &length);
+    if (s)
     {
-        if (tmp.value().size() == 1) {
-            result.setValue(tmp.value()[0]);
-        }
+        // Only strings of length 1 are characters, so type of value does not decide a match
+        ctx->setValueDependentMatch(true);
+    }
+    if (s && length == 1)
+    {
+        result.setValue(s[0]);
     }
     if (!result.exists())
     {
@@ -200,12 +231,16 @@ public:
 static dukpp03::Maybe<unsigned char> perform(_Context* ctx, duk_idx_t pos)
 {
     dukpp03::Maybe<unsigned char> result;
-    const dukpp03::Maybe<std::string> tmp = dukpp03::GetValue<std::string, _Context>::perform(ctx, pos);
-    if (tmp.exists())
+    duk_size_t length = 0;
+    const char* s = duk_get_lstring(ctx->context(), pos, &length);
+    if (s)
     {
-        if (tmp.value().size() == 1) {
-            result.setValue(static_cast<unsigned char>(tmp.value()[0]));
-        }
+        // Only strings of length 1 are characters, so type of value does not decide a match
+        ctx->setValueDependentMatch(true);
+    }
+    if (s && length == 1)
+    {
+        result.setValue(static_cast<unsigned char>(s[0]));
     }
     if (!result.exists())
     {
@@ -237,9 +272,11 @@ static dukpp03::Maybe<std::string> perform(
 )
 {
     dukpp03::Maybe<std::string> result;
-    if (duk_is_string(ctx->context(), pos))
+    duk_size_t length = 0;
+    const char* s = duk_get_lstring(ctx->context(), pos, &length);
+    if (s)
     {
-        result.setValue(duk_to_string(ctx->context(), pos));
+        result.setValue(std::string(s, length));
     }
     return result;
 }
@@ -247,7 +284,7 @@ static dukpp03::Maybe<std::string> perform(
 };
 
 
-#define DEFINE_GET_VALUE_AS_CAST_FROM_INT( TYPE )   \
+#define DEFINE_GET_VALUE_AS_INTEGER( TYPE, READ )   \
 template<                                           \
     typename _Context                               \
 >                                                   \
@@ -262,7 +299,7 @@ static dukpp03::Maybe< TYPE > perform(              \
     dukpp03::Maybe< TYPE > result;                                                                    \
     if (duk_is_number(ctx->context(), pos))                                                           \
     {                                                                                                 \
-        result.setValue(static_cast< TYPE >(duk_to_int(ctx->context(), pos)));                        \
+        result.setValue( READ );                                                                      \
     }                                                                                                 \
     if (!result.exists())                                                                             \
     {                                                                                                 \
@@ -273,16 +310,16 @@ static dukpp03::Maybe< TYPE > perform(              \
 };                                                                                                    
 
 
-DEFINE_GET_VALUE_AS_CAST_FROM_INT(short)
-DEFINE_GET_VALUE_AS_CAST_FROM_INT(unsigned short)
-DEFINE_GET_VALUE_AS_CAST_FROM_INT(int)
-DEFINE_GET_VALUE_AS_CAST_FROM_INT(unsigned int)
-DEFINE_GET_VALUE_AS_CAST_FROM_INT(long)
-DEFINE_GET_VALUE_AS_CAST_FROM_INT(unsigned long)
-DEFINE_GET_VALUE_AS_CAST_FROM_INT(long long)
-DEFINE_GET_VALUE_AS_CAST_FROM_INT(unsigned long long)
+DEFINE_GET_VALUE_AS_INTEGER(short, static_cast<short>(duk_get_int(ctx->context(), pos)))
+DEFINE_GET_VALUE_AS_INTEGER(unsigned short, static_cast<unsigned short>(duk_get_int(ctx->context(), pos)))
+DEFINE_GET_VALUE_AS_INTEGER(int, static_cast<int>(duk_get_int(ctx->context(), pos)))
+DEFINE_GET_VALUE_AS_INTEGER(unsigned int, static_cast<unsigned int>(duk_get_uint(ctx->context(), pos)))
+DEFINE_GET_VALUE_AS_INTEGER(long, dukpp03::internal::numberToInteger<long>(duk_get_number(ctx->context(), pos)))
+DEFINE_GET_VALUE_AS_INTEGER(unsigned long, dukpp03::internal::numberToInteger<unsigned long>(duk_get_number(ctx->context(), pos)))
+DEFINE_GET_VALUE_AS_INTEGER(long long, dukpp03::internal::numberToInteger<long long>(duk_get_number(ctx->context(), pos)))
+DEFINE_GET_VALUE_AS_INTEGER(unsigned long long, dukpp03::internal::numberToInteger<unsigned long long>(duk_get_number(ctx->context(), pos)))
 
-#undef DEFINE_GET_VALUE_AS_CAST_FROM_INT
+#undef DEFINE_GET_VALUE_AS_INTEGER
 
 template<    
     typename _Context
@@ -6,8 +6,6 @@
 // ReSharper disable once CppUnusedIncludeDirective
 #include <cstdio>
 
-#define DUKPP03_JSOBJECT_POINTER_SIGNATURE "\1dukpp03::JSObject<_Context>\1"
-
 namespace dukpp03
 {
 
@@ -417,7 +415,7 @@ public:
         (const_cast<JSObject<_Context>*>(this))->m_links.push_back(lnk);
 
         // Set inner value, stored to ensure consistency
-        duk_push_string(c, DUKPP03_JSOBJECT_POINTER_SIGNATURE);   
+        ctx->pushKey(dukpp03::AbstractContext::JSObjectKey);
         duk_push_pointer(c, (const_cast<JSObject<_Context>*>(this)));
         duk_def_prop(c, obj, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_HAVE_WRITABLE | 0);
 
@@ -671,6 +669,7 @@ public:
             {
                 m_links.erase(m_links.begin() + i);
                 this->delRef();
+                return;
             }
         }
     }
@@ -778,7 +777,7 @@ dukpp03::JSObject<_Context>* JSObjectFinalizer<_Context>::getObject(duk_context*
     if (duk_is_object(ctx, 0))
     {
         dukpp03::JSObject<_Context>* result = nullptr;
-        duk_get_prop_string(ctx, 0, DUKPP03_JSOBJECT_POINTER_SIGNATURE);
+        dukpp03::AbstractContext::getContext(ctx)->getProperty(ctx, 0, dukpp03::AbstractContext::JSObjectKey);
         if (duk_is_pointer(ctx, -1))
         {
             void* ptr = duk_to_pointer(ctx, -1);
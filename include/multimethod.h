@@ -22,14 +22,14 @@ class MultiMethod: public dukpp03::Callable<_Context>
 public:
     /*! Constructs empty multi-method
      */
-    MultiMethod()
+    MultiMethod() : m_cache_id(dukpp03::AbstractContext::newOverloadCache())
     {
         
     }
     /*! Copies other multi-method
         \param[in] m multi-method
      */
-    MultiMethod(const dukpp03::MultiMethod<_Context>& m)
+    MultiMethod(const dukpp03::MultiMethod<_Context>& m) : m_cache_id(dukpp03::AbstractContext::newOverloadCache())
     {
         this->copy(m);
     }
@@ -60,6 +60,7 @@ public:
             return;
         }
         m_callables.push_back(callable);
+        m_cache_id = dukpp03::AbstractContext::newOverloadCache();
     }
     /*! Removes callable from list
         \param[in] callable
@@ -71,6 +72,7 @@ public:
         if (it != m_callables.end())
         {
             m_callables.erase(it);
+            m_cache_id = dukpp03::AbstractContext::newOverloadCache();
             return true;
         }
         return false;
@@ -153,7 +155,15 @@ public:
         
         std::pair<int, bool> result = std::make_pair(0, false);
         Callable<_Context>* ptr = nullptr;
-        this->getCandidate(c, result, &ptr);
+        if (m_callables.size() == 1)
+        {
+            // Only one overload would be chosen anyway, and it will check arguments by itself
+            ptr = m_callables[0];
+        }
+        else
+        {
+            this->getCandidate(c, result, &ptr);
+        }
         // std::cout << result.first << ", " << result.second << "\n";
         try
         {
@@ -215,6 +225,7 @@ public:
             delete m_callables[i];
         }
         m_callables.clear();
+        m_cache_id = dukpp03::AbstractContext::newOverloadCache();
     }
 protected:
     /*! Returns candidate for call for multi-method
@@ -223,6 +234,39 @@ protected:
         \param[out] callback a callback, which can be called upon
      */
     void getCandidate(_Context* c, std::pair<int, bool>& result, dukpp03::Callable<_Context>** callback)
+    {
+        MultiMethodDispatchKey key = MultiMethodDispatchKey();
+        const bool cacheable = this->makeDispatchKey(c, key);
+        if (cacheable)
+        {
+            dukpp03::AbstractCallable* overload = nullptr;
+            if (c->overloadCache(m_cache_id).find(key, &overload, result))
+            {
+                // Only shapes, for which scoring did not depend on values, are cached, so winner is the same
+                *callback = static_cast<dukpp03::Callable<_Context>*>(overload);
+                return;
+            }
+        }
+
+        // Flag could be raised by outer call, which is still checking it's arguments, so it's restored after scoring
+        const bool outer_value_dependent = c->valueDependentMatch();
+        c->setValueDependentMatch(false);
+        this->scoreCandidates(c, result, callback);
+        const bool value_dependent = c->valueDependentMatch();
+        c->setValueDependentMatch(outer_value_dependent || value_dependent);
+
+        if (cacheable && result.second && !value_dependent)
+        {
+            // Scoring could add caches of nested multi-methods to context, so cache is looked up again
+            c->overloadCache(m_cache_id).insert(key, *callback, result);
+        }
+    }
+    /*! Finds best candidate for call, checking all of overloads
+        \param[in]  c context
+        \param[out] result a result of seeking for candidate
+        \param[out] callback a callback, which can be called upon
+     */
+    void scoreCandidates(_Context* c, std::pair<int, bool>& result, dukpp03::Callable<_Context>** callback)
     {
         result = std::make_pair(0, false);
         bool first = true;
@@ -239,6 +283,64 @@ protected:
             }
         }
     }
+    /*! Builds a key for cache of overloads from current call
+        \param[in] c context
+        \param[out] key a resulting key
+        \return whether call could be cached
+     */
+    bool makeDispatchKey(_Context* c, MultiMethodDispatchKey& key)
+    {
+        duk_context* ctx = c->context();
+        const int count = c->getTop();
+        if (count > DUKPP03_MULTIMETHOD_MAX_CACHED_ARGUMENTS)
+        {
+            return false;
+        }
+        key.Types = 0;
+        key.ObjectCount = 0;
+        for(int i = 0; i < count; i++)
+        {
+            const int type = duk_get_type(ctx, i);
+            if (!MultiMethod<_Context>::isPrimitiveType(type))
+            {
+                const void* variant_type = (type == DUK_TYPE_OBJECT) ? c->variantType(ctx, i) : nullptr;
+                if (!variant_type || key.ObjectCount == DUKPP03_MULTIMETHOD_MAX_CACHED_OBJECTS)
+                {
+                    return false;
+                }
+                key.VariantTypes[key.ObjectCount++] = variant_type;
+            }
+            key.Types |= static_cast<unsigned long long>(type) << (4 * i);
+        }
+        key.ArgumentCount = count;
+        key.ConstructorCall = duk_is_constructor_call(ctx) != 0;
+        duk_push_this(ctx);
+        key.ThisType = duk_get_type(ctx, -1);
+        key.ThisVariantType = nullptr;
+        bool result = MultiMethod<_Context>::isPrimitiveType(key.ThisType);
+        if (key.ThisType == DUK_TYPE_OBJECT)
+        {
+            key.ThisVariantType = c->variantType(ctx, -1);
+            // This of constructor call is fresh default object, so it's the same for every call
+            result = (key.ThisVariantType != nullptr) || key.ConstructorCall;
+        }
+        duk_pop(ctx);
+        return result;
+    }
+    /*! Returns whether values of type are converted the same way regardless of contents. Objects, buffers,
+        pointers and lightfuncs are not, since their conversions look into values. Objects, which own
+        variants, are described by type of variant instead
+        \param[in] type a Duktape type of value
+        \return whether type could be described by key
+     */
+    static bool isPrimitiveType(int type)
+    {
+        return type == DUK_TYPE_UNDEFINED
+            || type == DUK_TYPE_NULL
+            || type == DUK_TYPE_BOOLEAN
+            || type == DUK_TYPE_NUMBER
+            || type == DUK_TYPE_STRING;
+    }
     /*! Copies multi-method state into self
         \param[in] m multi-method
      */
@@ -252,6 +354,9 @@ protected:
     /*! A list of methods, that could be called
      */
     std::vector<dukpp03::Callable<_Context>* > m_callables;
+    /*! An identifier of cache of overloads in contexts. Renewed, when list of methods is changed
+     */
+    dukpp03::AbstractContext::OverloadCacheId m_cache_id;
 };
 
 
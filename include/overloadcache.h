@@ -0,0 +1,107 @@
+/*! \file overloadcache.h
+
+    Defines a cache of overloads, resolved by multi-method for shapes of calls
+ */
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+/*! A maximal amount of arguments, which could be packed into dispatch key
+ */
+#define DUKPP03_MULTIMETHOD_MAX_CACHED_ARGUMENTS 16
+/*! A maximal amount of objects among arguments, which could be described by dispatch key
+ */
+#define DUKPP03_MULTIMETHOD_MAX_CACHED_OBJECTS 4
+/*! A maximal amount of cached resolved overloads for multi-method
+ */
+#define DUKPP03_MULTIMETHOD_CACHE_SIZE 8
+
+namespace dukpp03
+{
+
+class AbstractCallable;
+
+/*! A key for cache of resolved overloads of multi-method. Describes a shape of call:
+    Duktape types of arguments and this. Objects are described by type of variant, owned by them,
+    since conversions of such objects depend only on type of variant. Calls with other objects are not
+    described by key, since their conversions depend on contents, except for this of constructor call,
+    which is always fresh default object
+ */
+struct MultiMethodDispatchKey
+{
+    /*! Types of arguments, packed by four bits per argument
+     */
+    unsigned long long Types;
+    /*! Amount of arguments
+     */
+    int ArgumentCount;
+    /*! A type of this
+     */
+    int ThisType;
+    /*! Whether call is constructor call
+     */
+    bool ConstructorCall;
+    /*! A type of variant, owned by this, or nullptr if this is not an object
+     */
+    const void* ThisVariantType;
+    /*! Amount of objects among arguments
+     */
+    int ObjectCount;
+    /*! Types of variants, owned by objects among arguments, in order of arguments
+     */
+    const void* VariantTypes[DUKPP03_MULTIMETHOD_MAX_CACHED_OBJECTS];
+
+    /*! Compares two keys
+        \param[in] o other key
+        \return true if equal
+     */
+    bool operator==(const MultiMethodDispatchKey& o) const;
+};
+
+/*! A cache of overloads, resolved by one multi-method. Caches are kept per context, so multi-methods,
+    shared between contexts, used in different threads, are never changed during call
+ */
+class OverloadCache
+{
+public:
+    /*! Constructs empty cache
+     */
+    OverloadCache();
+    /*! Looks up overload, resolved for key
+        \param[in] key a key
+        \param[out] overload a resolved overload
+        \param[out] result a result of scoring for overload
+        \return whether overload is found
+     */
+    bool find(const dukpp03::MultiMethodDispatchKey& key, dukpp03::AbstractCallable** overload, std::pair<int, bool>& result) const;
+    /*! Stores overload, resolved for key, replacing oldest entry if cache is full
+        \param[in] key a key
+        \param[in] overload a resolved overload
+        \param[in] result a result of scoring for overload
+     */
+    void insert(const dukpp03::MultiMethodDispatchKey& key, dukpp03::AbstractCallable* overload, const std::pair<int, bool>& result);
+private:
+    /*! A cached overload for call shape
+     */
+    struct Entry
+    {
+        /*! A shape of call
+         */
+        dukpp03::MultiMethodDispatchKey Key;
+        /*! An overload, which won scoring for shape
+         */
+        dukpp03::AbstractCallable* Overload;
+        /*! A result of scoring for overload
+         */
+        std::pair<int, bool> Result;
+    };
+    /*! Cached entries
+     */
+    std::vector<dukpp03::OverloadCache::Entry> m_entries;
+    /*! A position of entry, which should be replaced next, when cache is full
+     */
+    size_t m_position;
+};
+
+}
@@ -0,0 +1,103 @@
+/*! \file pinnedvalue.h
+    
+    Defines a handle for value, pinned in heap stash of context
+ */
+#pragma once
+#include "duk_custom.h"
+#include "../duktape/src/duktape.h"
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+
+namespace dukpp03
+{
+
+class AbstractContext;
+
+/*! A reference-counted handle for value, which is stored in heap stash of context, so it won't
+    be collected, while handle exists. Handle could outlive a context, in that case it becomes detached
+    and does not refer to any value. Use dukpp03::AbstractContext::pin to create handle.
+
+    Handle could be released from any thread. Value is removed from heap stash later by context itself,
+    so heap of context is never accessed from thread, which released handle.
+ */
+class PinnedValue
+{
+public:
+    /*! Creates new handle for value. Value must be already stored in stash
+        \param[in] ctx a context
+        \param[in] heap_pointer a heap pointer of value
+        \param[in] index an index of value in heap stash
+        \param[in] slot a position of handle in list of handles of context
+     */
+    PinnedValue(dukpp03::AbstractContext* ctx, void* heap_pointer, duk_uarridx_t index, size_t slot);
+    /*! Increments reference count for handle
+     */
+    void addRef();
+    /*! Decrements reference count for handle, removing value from stash and destroying
+        handle, if count reaches zero
+     */
+    void delRef();
+    /*! Pushes value on stack of context
+        \return false, if handle is detached and nothing was pushed
+     */
+    bool push() const;
+    /*! Returns context, where value is stored
+        \return context or nullptr if handle is detached
+     */
+    dukpp03::AbstractContext* context() const;
+    /*! Returns heap pointer for value
+        \return heap pointer
+     */
+    void* heapPointer() const;
+    /*! Returns index of value in heap stash
+        \return index
+     */
+    duk_uarridx_t index() const;
+    /*! Returns position of handle in list of handles of context
+        \return position
+     */
+    size_t slot() const;
+    /*! Sets position of handle in list of handles of context. Called by context, when list is changed
+        \param[in] slot a position
+     */
+    void setSlot(size_t slot);
+    /*! Detaches handle from context. Called by context before heap is destroyed
+     */
+    void detach();
+    /*! Returns mutex, which guards attaching and detaching handles of all contexts, since handles
+        could be released from any thread
+        \return mutex
+     */
+    static std::mutex& mutex();
+private:
+    /*! Could be destroyed only via delRef
+     */
+    ~PinnedValue();
+    /*! This object is non-copyable
+        \param[in] p value
+     */
+    PinnedValue(const dukpp03::PinnedValue& p);
+    /*! This object is non-copyable
+        \param[in] p value
+        \return self-reference
+     */
+    dukpp03::PinnedValue& operator=(const dukpp03::PinnedValue& p);
+    /*! A context, where value is stored
+     */
+    std::atomic<dukpp03::AbstractContext*> m_context;
+    /*! A heap pointer for value
+     */
+    void* m_heap_pointer;
+    /*! An index of value in heap stash
+     */
+    duk_uarridx_t m_index;
+    /*! A position of handle in list of handles of context
+     */
+    size_t m_slot;
+    /*! A reference count for handle
+     */
+    std::atomic<int> m_refcount;
+};
+
+}
@@ -12,6 +12,45 @@
 namespace dukpp03
 {
 
+namespace internal
+{
+
+/*! Pushes 64-bit integer. Values, which fit into duk_int_t, are pushed as integers, others
+    are pushed as numbers, which are exact up to 2^53
+    \param[in] ctx context
+    \param[in] v value
+ */
+inline void pushInteger(duk_context* ctx, long long v)
+{
+    if (v >= DUK_INT_MIN && v <= DUK_INT_MAX)
+    {
+        duk_push_int(ctx, static_cast<duk_int_t>(v));
+    }
+    else
+    {
+        duk_push_number(ctx, static_cast<duk_double_t>(v));
+    }
+}
+
+/*! Pushes unsigned 64-bit integer. Values, which fit into duk_uint_t, are pushed as integers, others
+    are pushed as numbers, which are exact up to 2^53
+    \param[in] ctx context
+    \param[in] v value
+ */
+inline void pushInteger(duk_context* ctx, unsigned long long v)
+{
+    if (v <= DUK_UINT_MAX)
+    {
+        duk_push_uint(ctx, static_cast<duk_uint_t>(v));
+    }
+    else
+    {
+        duk_push_number(ctx, static_cast<duk_double_t>(v));
+    }
+}
+
+}
+
 /*! Performs pushing value on stack for every type of value
  */
 template<
@@ -27,7 +66,7 @@ public:
      */
     static void perform(_Context* ctx, const _Value& v)
     {        
-        ctx->template pushVariant<_Value>(_Context::VariantUtils::template makeFrom(v));
+        ctx->template pushValueAsVariant<_Value>(v);
     }
 };
 
@@ -161,7 +200,7 @@ public:
      */
     static void perform(_Context* ctx, const unsigned int& v)
     {
-        duk_push_int(ctx->context(), v);
+        duk_push_uint(ctx->context(), v);
     }
 };
 
@@ -178,7 +217,7 @@ public:
      */
     static void perform(_Context* ctx, const long& v)
     {
-        duk_push_int(ctx->context(), v);
+        dukpp03::internal::pushInteger(ctx->context(), static_cast<long long>(v));
     }
 };
 
@@ -194,7 +233,7 @@ public:
      */
     static void perform(_Context* ctx, const unsigned long& v)
     {
-        duk_push_int(ctx->context(), v);
+        dukpp03::internal::pushInteger(ctx->context(), static_cast<unsigned long long>(v));
     }
 };
 
@@ -210,7 +249,7 @@ public:
      */
     static void perform(_Context* ctx, const long long& v)
     {
-        duk_push_int(ctx->context(), static_cast<int>(v));
+        dukpp03::internal::pushInteger(ctx->context(), v);
     }
 };
 
@@ -226,7 +265,7 @@ public:
      */
     static void perform(_Context* ctx, const unsigned long long& v)
     {
-        duk_push_int(ctx->context(), static_cast<int>(v));
+        dukpp03::internal::pushInteger(ctx->context(), v);
     }
 };
 
@@ -0,0 +1,141 @@
+/*! \file scriptcache.h
+    
+    Defines a cache of compiled scripts, used by context to avoid compiling the same source again
+ */
+#pragma once
+#include "pinnedvalue.h"
+#include <string>
+#include <list>
+#include <map>
+
+namespace dukpp03
+{
+
+class AbstractContext;
+
+/*! A cache of compiled scripts for context. Scripts are identified by hash of source and file name, 
+    compiled functions are kept alive in heap stash. Least recently used scripts are evicted, when
+    approximate size of cache exceeds memory limit. Functions are stored live, not as bytecode, and
+    never dumped: size of entry is estimated as size of source and file name plus size of compiled
+    function, taken as CompiledSizeFactor times length of source
+ */
+class ScriptCache
+{
+public:
+    /*! A default limit for memory, used by cache
+     */
+    static const size_t DefaultMemoryLimit = 1024 * 1024;
+    /*! A ratio between estimated size of compiled function and length of its source
+     */
+    static const size_t CompiledSizeFactor = 2;
+    /*! Constructs empty cache
+        \param[in] ctx a context, which owns cache
+     */
+    ScriptCache(dukpp03::AbstractContext* ctx);
+    /*! Frees all entries of cache
+     */
+    ~ScriptCache();
+    /*! Tries to find compiled script and push it on stack
+        \param[in] source a source code
+        \param[in] filename a file name
+        \return true if script is found and pushed, false otherwise
+     */
+    bool push(const std::string& source, const std::string& filename);
+    /*! Inserts compiled function on top of stack into cache, evicting old entries if needed. 
+        Function is left on stack
+        \param[in] source a source code
+        \param[in] filename a file name
+     */
+    void insert(const std::string& source, const std::string& filename);
+    /*! Removes all entries from cache. Counters are left intact
+     */
+    void clear();
+    /*! Sets memory limit for cache. Zero disables cache
+        \param[in] limit a limit in bytes
+     */
+    void setMemoryLimit(size_t limit);
+    /*! Returns memory limit for cache
+        \return limit in bytes
+     */
+    size_t memoryLimit() const;
+    /*! Returns approximate amount of memory, used by cached scripts
+        \return amount of bytes
+     */
+    size_t memoryUsage() const;
+    /*! Returns amount of cached scripts
+        \return amount of scripts
+     */
+    size_t size() const;
+    /*! Returns amount of cache hits
+        \return amount of hits
+     */
+    unsigned long long hits() const;
+    /*! Returns amount of cache misses
+        \return amount of misses
+     */
+    unsigned long long misses() const;
+    /*! Resets hit and miss counters
+     */
+    void resetStatistics();
+    /*! Computes hash for source and file name
+        \param[in] source a source code
+        \param[in] filename a file name
+        \return hash
+     */
+    static unsigned long long hash(const std::string& source, const std::string& filename);
+private:
+    /*! An entry of cache
+     */
+    struct Entry
+    {
+        unsigned long long Hash;           //!< A hash of source and file name
+        std::string Source;                //!< A source code
+        std::string FileName;              //!< A file name
+        dukpp03::PinnedValue* Function;    //!< A compiled function
+        size_t Size;                       //!< An approximate size of entry
+    };
+    /*! A list of entries, most recently used first
+     */
+    typedef std::list<Entry> EntryList;
+    /*! Removes least recently used entries, until memory usage fits into limit
+        \param[in] limit a limit
+     */
+    void evict(size_t limit);
+    /*! Removes entry from cache
+        \param[in] it iterator for entry
+     */
+    void erase(EntryList::iterator it);
+    /*! This object is non-copyable
+        \param[in] o cache
+     */
+    ScriptCache(const dukpp03::ScriptCache& o);
+    /*! This object is non-copyable
+        \param[in] o cache
+        \return self-reference
+     */
+    dukpp03::ScriptCache& operator=(const dukpp03::ScriptCache& o);
+
+    /*! A context, which owns cache
+     */
+    dukpp03::AbstractContext* m_context;
+    /*! Entries of cache
+     */
+    EntryList m_entries;
+    /*! An index of entries by hash
+     */
+    std::map<unsigned long long, EntryList::iterator> m_index;
+    /*! A memory limit
+     */
+    size_t m_memory_limit;
+    /*! A memory usage
+     */
+    size_t m_memory_usage;
+    /*! Amount of hits
+     */
+    unsigned long long m_hits;
+    /*! Amount of misses
+     */
+    unsigned long long m_misses;
+};
+
+}
@@ -0,0 +1,342 @@
+/*! \file scriptexecutor.h
+
+    Defines an executor, which runs scripts on several worker threads, each of them having own context
+ */
+#pragma once
+#include "contexttemplate.h"
+#include "value.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <atomic>
+#include <stdexcept>
+
+namespace dukpp03
+{
+
+/*! A result of running script in executor
+ */
+struct ScriptResult
+{
+    /*! Whether script was run without errors
+     */
+    bool Success;
+    /*! A result of script. Undefined if error occurred
+     */
+    dukpp03::Value Result;
+    /*! An error if any
+     */
+    std::string Error;
+
+    /*! Constructs failed result without error
+     */
+    ScriptResult() : Success(false)
+    {
+
+    }
+};
+
+/*! An executor, which owns several worker threads. Each worker has own context, initialized
+    with the same template, so contexts are never shared between threads. Tasks are distributed
+    between workers in round-robin order, and idle workers steal tasks from queues of busy workers.
+    Arguments and results are passed as dukpp03::Value, so they do not depend on heap of any context.
+
+    Tasks are run in arbitrary worker, so they should not rely on state, left by other tasks.
+ */
+template<
+    typename _Context
+>
+class ScriptExecutor
+{
+public:
+    /*! Creates executor and starts worker threads. Template is used only in constructor
+        \param[in] threads amount of worker threads. If zero, amount of hardware threads is used
+        \param[in] t a template for initializing contexts of workers, could be nullptr
+     */
+    ScriptExecutor(size_t threads, const dukpp03::ContextTemplate<_Context>* t = nullptr)
+    : m_pending(0), m_stopping(false), m_next_worker(0), m_steals(0)
+    {
+        if (threads == 0)
+        {
+            threads = std::thread::hardware_concurrency();
+            if (threads == 0)
+            {
+                threads = 1;
+            }
+        }
+        for(size_t i = 0; i < threads; i++)
+        {
+            Worker* w = new Worker();
+            w->Context = new _Context();
+            if (t)
+            {
+                t->apply(w->Context);
+            }
+            w->Context->cleanStack();
+            m_workers.push_back(w);
+        }
+        for(size_t i = 0; i < m_workers.size(); i++)
+        {
+            m_workers[i]->Thread = std::thread(&ScriptExecutor<_Context>::run, this, i);
+        }
+    }
+    /*! Waits for all submitted tasks and stops workers
+     */
+    ~ScriptExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        // Workers may still look into queues of each other, so they are freed only after all threads are stopped
+        for(size_t i = 0; i < m_workers.size(); i++)
+        {
+            m_workers[i]->Thread.join();
+        }
+        for(size_t i = 0; i < m_workers.size(); i++)
+        {
+            delete m_workers[i]->Context;
+            delete m_workers[i];
+        }
+    }
+    /*! Submits script for evaluation. If script evaluates to function, it's called with arguments,
+        and result of call is returned, otherwise result of evaluation is returned. Compiled scripts
+        are cached in contexts of workers
+        \param[in] source a source code
+        \param[in] args arguments for function
+        \return future result
+     */
+    std::future<dukpp03::ScriptResult> submit(const std::string& source, const std::vector<dukpp03::Value>& args = std::vector<dukpp03::Value>())
+    {
+        Task* task = new Task();
+        task->Source = source;
+        task->Arguments = args;
+        return this->enqueue(task);
+    }
+    /*! Submits call of global function, defined in template
+        \param[in] function a name of global function
+        \param[in] args arguments for function
+        \return future result
+     */
+    std::future<dukpp03::ScriptResult> submitCall(const std::string& function, const std::vector<dukpp03::Value>& args = std::vector<dukpp03::Value>())
+    {
+        Task* task = new Task();
+        task->Function = function;
+        task->Arguments = args;
+        return this->enqueue(task);
+    }
+    /*! Returns amount of worker threads
+        \return amount of worker threads
+     */
+    size_t threadCount() const
+    {
+        return m_workers.size();
+    }
+    /*! Returns amount of tasks, which were stolen by workers from queues of other workers
+        \return amount of stolen tasks
+     */
+    unsigned long long steals() const
+    {
+        return m_steals.load();
+    }
+private:
+    /*! A task for executor
+     */
+    struct Task
+    {
+        /*! A source code of script. Empty if global function is called
+         */
+        std::string Source;
+        /*! A name of global function. Empty if script is evaluated
+         */
+        std::string Function;
+        /*! Arguments for call
+         */
+        std::vector<dukpp03::Value> Arguments;
+        /*! A promise for result
+         */
+        std::promise<dukpp03::ScriptResult> Promise;
+    };
+    /*! A worker thread with own context and queue
+     */
+    struct Worker
+    {
+        /*! A lock for queue
+         */
+        std::mutex Mutex;
+        /*! A queue of tasks. Owner takes tasks from front, thieves from back
+         */
+        std::deque<Task*> Queue;
+        /*! A context of worker
+         */
+        _Context* Context;
+        /*! A thread of worker
+         */
+        std::thread Thread;
+    };
+    /*! An executor is non-copyable
+        \param[in] o other executor
+     */
+    ScriptExecutor(const ScriptExecutor& o)
+    {
+        throw std::logic_error("dukpp03::ScriptExecutor is non-copyable!");
+    }
+    /*! An executor is non-copyable
+        \param[in] o other executor
+        \return self-reference
+     */
+    ScriptExecutor& operator=(const ScriptExecutor& o)
+    {
+        throw std::logic_error("dukpp03::ScriptExecutor is non-copyable!");
+        return *this;
+    }
+    /*! Puts task into queue of next worker
+        \param[in] task a task
+        \return future result
+     */
+    std::future<dukpp03::ScriptResult> enqueue(Task* task)
+    {
+        std::future<dukpp03::ScriptResult> result = task->Promise.get_future();
+        Worker* w = m_workers[m_next_worker.fetch_add(1) % m_workers.size()];
+        // Counter is increased before task is queued, so it never drops below zero, when task is taken
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_pending;
+        }
+        {
+            std::lock_guard<std::mutex> lock(w->Mutex);
+            w->Queue.push_back(task);
+        }
+        m_wake.notify_one();
+        return result;
+    }
+    /*! Takes task from own queue of worker or steals it from other workers
+        \param[in] index an index of worker
+        \return task or nullptr if all queues are empty
+     */
+    Task* take(size_t index)
+    {
+        for(size_t i = 0; i < m_workers.size(); i++)
+        {
+            Worker* w = m_workers[(index + i) % m_workers.size()];
+            std::lock_guard<std::mutex> lock(w->Mutex);
+            if (!w->Queue.empty())
+            {
+                Task* result = nullptr;
+                if (i == 0)
+                {
+                    result = w->Queue.front();
+                    w->Queue.pop_front();
+                }
+                else
+                {
+                    result = w->Queue.back();
+                    w->Queue.pop_back();
+                    ++m_steals;
+                }
+                std::lock_guard<std::mutex> pending_lock(m_mutex);
+                --m_pending;
+                return result;
+            }
+        }
+        return nullptr;
+    }
+    /*! A loop of worker thread
+        \param[in] index an index of worker
+     */
+    void run(size_t index)
+    {
+        _Context* ctx = m_workers[index]->Context;
+        while(true)
+        {
+            Task* task = this->take(index);
+            if (task)
+            {
+                task->Promise.set_value(this->perform(ctx, task));
+                delete task;
+            }
+            else
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_stopping || m_pending != 0; });
+                if (m_stopping && m_pending == 0)
+                {
+                    return;
+                }
+            }
+        }
+    }
+    /*! Runs task in context
+        \param[in] ctx context
+        \param[in] task a task
+        \return result
+     */
+    dukpp03::ScriptResult perform(_Context* ctx, Task* task)
+    {
+        dukpp03::ScriptResult result;
+        duk_context* c = ctx->context();
+        bool callable = true;
+        if (task->Function.size())
+        {
+            duk_get_global_string(c, task->Function.c_str());
+        }
+        else
+        {
+            if (!ctx->eval(task->Source, std::string("executor.js"), false, &(result.Error)))
+            {
+                ctx->cleanStack();
+                return result;
+            }
+            callable = duk_is_function(c, -1) != 0;
+        }
+        if (callable)
+        {
+            for(size_t i = 0; i < task->Arguments.size(); i++)
+            {
+                task->Arguments[i].push(c);
+            }
+            if (ctx->pcall(static_cast<duk_idx_t>(task->Arguments.size())) != DUK_EXEC_SUCCESS)
+            {
+                result.Error = ctx->errorOnStack(-1).value();
+                if (result.Error.empty())
+                {
+                    result.Error = duk_safe_to_string(c, -1);
+                }
+                ctx->cleanStack();
+                return result;
+            }
+        }
+        // Result is read in protected call, so failing task does not abort process
+        result.Success = dukpp03::Value::fromStack(c, -1, result.Result, &(result.Error));
+        ctx->cleanStack();
+        return result;
+    }
+    /*! Workers of executor
+     */
+    std::vector<Worker*> m_workers;
+    /*! A lock for amount of pending tasks and stopping flag
+     */
+    std::mutex m_mutex;
+    /*! A condition, signalled when new task is submitted or executor is stopping
+     */
+    std::condition_variable m_wake;
+    /*! Amount of tasks in queues
+     */
+    size_t m_pending;
+    /*! Whether executor is stopping
+     */
+    bool m_stopping;
+    /*! An index of worker for next task
+     */
+    std::atomic<size_t> m_next_worker;
+    /*! Amount of stolen tasks
+     */
+    std::atomic<unsigned long long> m_steals;
+};
+
+}
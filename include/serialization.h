@@ -0,0 +1,514 @@
+/*! \file serialization.h
+
+    Defines bulk marshalling of values between C++ and scripts: encoded JSON and CBOR payloads,
+    decoded by native codecs of Duktape, and maps of fields of structures
+ */
+#pragma once
+#include "duk_custom.h"
+#include "../duktape/src/duktape.h"
+#include "abstractcontext.h"
+#include "maybe.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+namespace dukpp03
+{
+
+template<
+    typename _Value,
+    typename _Context
+>
+class PushValue;
+
+template<
+    typename _Value,
+    typename _Context
+>
+class GetValue;
+
+/*! A JSON text. When passed to function, argument is encoded as JSON, when returned from function,
+    text is decoded into value. Use it to pass large payloads, which are already serialized, without
+    building them field by field
+ */
+struct JSONText
+{
+    /*! A text
+     */
+    std::string Text;
+
+    /*! Constructs empty text
+     */
+    JSONText()
+    {
+
+    }
+    /*! Constructs text
+        \param[in] text a text
+     */
+    explicit JSONText(const std::string& text) : Text(text)
+    {
+
+    }
+};
+
+/*! A CBOR-encoded data. When passed to function, argument is encoded as CBOR, when returned from
+    function, data is decoded into value
+ */
+struct CBORData
+{
+    /*! A data
+     */
+    std::vector<unsigned char> Data;
+
+    /*! Constructs empty data
+     */
+    CBORData()
+    {
+
+    }
+    /*! Constructs data
+        \param[in] data a data
+     */
+    explicit CBORData(const std::vector<unsigned char>& data) : Data(data)
+    {
+
+    }
+};
+
+/*! Makes possible to pass arguments of functions as JSON text
+ */
+template<
+    typename _Context
+>
+class GetValue<dukpp03::JSONText, _Context>
+{
+public:
+    /*! Performs getting value from stack
+        \param[in] ctx context
+        \param[in] pos index for stack
+        \return a text if value could be represented as JSON, otherwise empty maybe
+     */
+    static dukpp03::Maybe<dukpp03::JSONText> perform(_Context* ctx, duk_idx_t pos)
+    {
+        // Payload is encoded in place to avoid copying it
+        dukpp03::Maybe<dukpp03::JSONText> result;
+        result.setValue(dukpp03::JSONText());
+        if (!ctx->encodeJSON(pos, result.mutableValue().Text))
+        {
+            result.clear();
+        }
+        return result;
+    }
+};
+
+/*! Makes possible to return JSON text from functions. Malformed text is pushed as undefined
+ */
+template<
+    typename _Context
+>
+class PushValue<dukpp03::JSONText, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value
+     */
+    static void perform(_Context* ctx, const dukpp03::JSONText& v)
+    {
+        if (!ctx->decodeJSON(v.Text.c_str(), v.Text.size()))
+        {
+            duk_push_undefined(ctx->context());
+        }
+    }
+};
+
+/*! Makes possible to pass arguments of functions as CBOR data
+ */
+template<
+    typename _Context
+>
+class GetValue<dukpp03::CBORData, _Context>
+{
+public:
+    /*! Performs getting value from stack
+        \param[in] ctx context
+        \param[in] pos index for stack
+        \return a data if value could be encoded, otherwise empty maybe
+     */
+    static dukpp03::Maybe<dukpp03::CBORData> perform(_Context* ctx, duk_idx_t pos)
+    {
+        dukpp03::Maybe<dukpp03::CBORData> result;
+        result.setValue(dukpp03::CBORData());
+        if (!ctx->encodeCBOR(pos, result.mutableValue().Data))
+        {
+            result.clear();
+        }
+        return result;
+    }
+};
+
+/*! Makes possible to return CBOR data from functions. Malformed data is pushed as undefined
+ */
+template<
+    typename _Context
+>
+class PushValue<dukpp03::CBORData, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value
+     */
+    static void perform(_Context* ctx, const dukpp03::CBORData& v)
+    {
+        if (!ctx->decodeCBOR(v.Data.data(), v.Data.size()))
+        {
+            duk_push_undefined(ctx->context());
+        }
+    }
+};
+
+/*! A map of fields of structure, which describes, how structure is represented as plain object in scripts.
+    Names of fields are interned in each context, where map is used, so object is built or read without
+    interning strings. Map could be used directly or via encode and decode methods, which convert structure
+    to and from JSON or CBOR with native codecs of Duktape.
+
+    Structure must be default-constructible and copyable. Fields are converted with dukpp03::GetValue and
+    dukpp03::PushValue, nested structures could be described with other map via addObject.
+ */
+template<
+    typename _Context,
+    typename _Class
+>
+class FieldMap
+{
+public:
+    /*! Creates empty map
+     */
+    FieldMap() : m_key_set(dukpp03::AbstractContext::newKeySet())
+    {
+
+    }
+    /*! Destroys all fields
+     */
+    ~FieldMap()
+    {
+        for(size_t i = 0; i < m_fields.size(); i++)
+        {
+            delete m_fields[i].second;
+        }
+    }
+    /*! Adds new field
+        \param[in] name a name of property in script
+        \param[in] field a field
+        \return self-reference
+     */
+    template<
+        typename _Field
+    >
+    dukpp03::FieldMap<_Context, _Class>& addField(const std::string& name, _Field _Class::* field)
+    {
+        m_fields.push_back(NamedField(name, new Field<_Field>(field)));
+        m_key_set = dukpp03::AbstractContext::newKeySet();
+        return *this;
+    }
+    /*! Adds new field, which is structure, described by other map. Other map must outlive this one
+        \param[in] name a name of property in script
+        \param[in] field a field
+        \param[in] map a map of fields of nested structure
+        \return self-reference
+     */
+    template<
+        typename _Field
+    >
+    dukpp03::FieldMap<_Context, _Class>& addObject(const std::string& name, _Field _Class::* field, const dukpp03::FieldMap<_Context, _Field>& map)
+    {
+        m_fields.push_back(NamedField(name, new ObjectField<_Field>(field, map)));
+        m_key_set = dukpp03::AbstractContext::newKeySet();
+        return *this;
+    }
+    /*! Returns amount of fields
+        \return amount of fields
+     */
+    size_t size() const
+    {
+        return m_fields.size();
+    }
+    /*! Pushes structure on stack as plain object
+        \param[in] ctx context
+        \param[in] v structure
+     */
+    void push(_Context* ctx, const _Class& v) const
+    {
+        const std::vector<dukpp03::AbstractContext::PropertyKey>& keys = this->keys(ctx);
+        duk_context* c = ctx->context();
+        duk_require_stack(c, 2);
+        duk_push_object(c);
+        for(size_t i = 0; i < m_fields.size(); i++)
+        {
+            m_fields[i].second->push(ctx, v);
+            ctx->putProperty(c, -2, keys[i]);
+        }
+    }
+    /*! Reads structure from plain object on stack. Missing fields and fields of wrong type are errors
+        \param[in] ctx context
+        \param[in] pos a position of object on stack
+        \param[out] v structure
+        \return true if all fields are read
+     */
+    bool get(_Context* ctx, duk_idx_t pos, _Class& v) const
+    {
+        duk_context* c = ctx->context();
+        if (!duk_is_object(c, pos))
+        {
+            return false;
+        }
+        // Result depends on fields of object, so overload, chosen for it, must not be cached
+        ctx->setValueDependentMatch(true);
+        const std::vector<dukpp03::AbstractContext::PropertyKey>& keys = this->keys(ctx);
+        pos = duk_normalize_index(c, pos);
+        duk_require_stack(c, 1);
+        for(size_t i = 0; i < m_fields.size(); i++)
+        {
+            ctx->getProperty(c, pos, keys[i]);
+            const bool result = m_fields[i].second->get(ctx, v);
+            duk_pop(c);
+            if (!result)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    /*! Encodes structure as JSON
+        \param[in] ctx context
+        \param[in] v structure
+        \param[out] result a text
+        \param[out] error an error if any
+        \return true on success
+     */
+    bool encodeJSON(_Context* ctx, const _Class& v, std::string& result, std::string* error = nullptr) const
+    {
+        this->push(ctx, v);
+        const bool ok = ctx->encodeJSON(-1, result, error);
+        duk_pop(ctx->context());
+        return ok;
+    }
+    /*! Decodes structure from JSON
+        \param[in] ctx context
+        \param[in] text a text
+        \param[out] v structure
+        \param[out] error an error if any
+        \return true on success
+     */
+    bool decodeJSON(_Context* ctx, const std::string& text, _Class& v, std::string* error = nullptr) const
+    {
+        if (!ctx->decodeJSON(text.c_str(), text.size(), error))
+        {
+            return false;
+        }
+        return this->getAndPop(ctx, v, error);
+    }
+    /*! Encodes structure as CBOR
+        \param[in] ctx context
+        \param[in] v structure
+        \param[out] result a data
+        \param[out] error an error if any
+        \return true on success
+     */
+    bool encodeCBOR(_Context* ctx, const _Class& v, std::vector<unsigned char>& result, std::string* error = nullptr) const
+    {
+        this->push(ctx, v);
+        const bool ok = ctx->encodeCBOR(-1, result, error);
+        duk_pop(ctx->context());
+        return ok;
+    }
+    /*! Decodes structure from CBOR
+        \param[in] ctx context
+        \param[in] data a data
+        \param[in] size a size of data
+        \param[out] v structure
+        \param[out] error an error if any
+        \return true on success
+     */
+    bool decodeCBOR(_Context* ctx, const unsigned char* data, size_t size, _Class& v, std::string* error = nullptr) const
+    {
+        if (!ctx->decodeCBOR(data, size, error))
+        {
+            return false;
+        }
+        return this->getAndPop(ctx, v, error);
+    }
+private:
+    /*! A field of structure
+     */
+    class AbstractField
+    {
+    public:
+        /*! Pushes value of field on stack
+            \param[in] ctx context
+            \param[in] v structure
+         */
+        virtual void push(_Context* ctx, const _Class& v) const = 0;
+        /*! Reads value of field from top of stack
+            \param[in] ctx context
+            \param[out] v structure
+            \return true if value has proper type
+         */
+        virtual bool get(_Context* ctx, _Class& v) const = 0;
+        /*! Could be inherited
+         */
+        virtual ~AbstractField()
+        {
+
+        }
+    };
+    /*! A field, converted with dukpp03::GetValue and dukpp03::PushValue
+     */
+    template<
+        typename _Field
+    >
+    class Field: public AbstractField
+    {
+    public:
+        /*! Constructs field
+            \param[in] field a field
+         */
+        Field(_Field _Class::* field) : m_field(field)
+        {
+
+        }
+        /*! Pushes value of field on stack
+            \param[in] ctx context
+            \param[in] v structure
+         */
+        virtual void push(_Context* ctx, const _Class& v) const override
+        {
+            dukpp03::PushValue<_Field, _Context>::perform(ctx, v.*m_field);
+        }
+        /*! Reads value of field from top of stack
+            \param[in] ctx context
+            \param[out] v structure
+            \return true if value has proper type
+         */
+        virtual bool get(_Context* ctx, _Class& v) const override
+        {
+            dukpp03::Maybe<_Field> result = dukpp03::GetValue<_Field, _Context>::perform(ctx, -1);
+            if (result.exists())
+            {
+                v.*m_field = result.value();
+            }
+            return result.exists();
+        }
+    private:
+        /*! A field
+         */
+        _Field _Class::* m_field;
+    };
+    /*! A field, which is structure, described by other map
+     */
+    template<
+        typename _Field
+    >
+    class ObjectField: public AbstractField
+    {
+    public:
+        /*! Constructs field
+            \param[in] field a field
+            \param[in] map a map of nested structure
+         */
+        ObjectField(_Field _Class::* field, const dukpp03::FieldMap<_Context, _Field>& map) : m_field(field), m_map(&map)
+        {
+
+        }
+        /*! Pushes value of field on stack
+            \param[in] ctx context
+            \param[in] v structure
+         */
+        virtual void push(_Context* ctx, const _Class& v) const override
+        {
+            m_map->push(ctx, v.*m_field);
+        }
+        /*! Reads value of field from top of stack
+            \param[in] ctx context
+            \param[out] v structure
+            \return true if value has proper type
+         */
+        virtual bool get(_Context* ctx, _Class& v) const override
+        {
+            return m_map->get(ctx, -1, v.*m_field);
+        }
+    private:
+        /*! A field
+         */
+        _Field _Class::* m_field;
+        /*! A map of nested structure
+         */
+        const dukpp03::FieldMap<_Context, _Field>* m_map;
+    };
+    /*! A named field
+     */
+    typedef std::pair<std::string, AbstractField*> NamedField;
+    /*! A map is non-copyable
+        \param[in] o other map
+     */
+    FieldMap(const FieldMap& o)
+    {
+        throw std::logic_error("dukpp03::FieldMap is non-copyable!");
+    }
+    /*! A map is non-copyable
+        \param[in] o other map
+        \return self-reference
+     */
+    FieldMap& operator=(const FieldMap& o)
+    {
+        throw std::logic_error("dukpp03::FieldMap is non-copyable!");
+        return *this;
+    }
+    /*! Returns names of fields, interned in context, interning them if needed. Keys are cached by context,
+        so map is not changed and could be shared between contexts in different threads
+        \param[in] ctx context
+        \return keys in order of fields
+     */
+    const std::vector<dukpp03::AbstractContext::PropertyKey>& keys(_Context* ctx) const
+    {
+        const std::vector<dukpp03::AbstractContext::PropertyKey>* result = ctx->keySet(m_key_set);
+        if (result)
+        {
+            return *result;
+        }
+        std::vector<std::string> names;
+        for(size_t i = 0; i < m_fields.size(); i++)
+        {
+            names.push_back(m_fields[i].first);
+        }
+        return ctx->internKeySet(m_key_set, names);
+    }
+    /*! Reads structure from top of stack and pops it
+        \param[in] ctx context
+        \param[out] v structure
+        \param[out] error an error if any
+        \return true on success
+     */
+    bool getAndPop(_Context* ctx, _Class& v, std::string* error) const
+    {
+        const bool result = this->get(ctx, -1, v);
+        duk_pop(ctx->context());
+        if (!result && error)
+        {
+            *error = "Value does not match structure";
+        }
+        return result;
+    }
+    /*! Fields of structure
+     */
+    std::vector<NamedField> m_fields;
+    /*! An identifier of names of fields, interned in contexts. Replaced, when fields are changed
+     */
+    dukpp03::AbstractContext::KeySetId m_key_set;
+};
+
+}
@@ -0,0 +1,199 @@
+/*! \file stringref.h
+
+    Defines a borrowed reference to string, which points into string, owned by Duktape heap
+ */
+#pragma once
+#include "duk_custom.h"
+#include "../duktape/src/duktape.h"
+#include "maybe.h"
+#include <cstddef>
+#include <string>
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+    #include <string_view>
+    /*! Defined, when std::string_view could be used as argument of bound functions
+     */
+    #define DUKPP03_HAS_STRING_VIEW
+#endif
+
+namespace dukpp03
+{
+
+template<
+    typename _Value,
+    typename _Context
+>
+class PushValue;
+
+template<
+    typename _Value,
+    typename _Context
+>
+class GetValue;
+
+/*! A non-owning reference to characters of string. When taken as argument of bound function, it points
+    directly into string on stack of context, so reading argument does not copy or allocate anything.
+    Reference is valid only while function is called and must not be stored. Use str() to get a copy,
+    which could outlive call.
+ */
+class StringRef
+{
+public:
+    /*! Constructs empty reference
+     */
+    StringRef();
+    /*! Constructs reference to characters
+        \param[in] data characters, not necessarily zero-terminated
+        \param[in] size amount of characters
+     */
+    StringRef(const char* data, size_t size) : m_data(data), m_size(size)
+    {
+
+    }
+    /*! Constructs reference to zero-terminated string
+        \param[in] data string
+     */
+    StringRef(const char* data);
+    /*! Constructs reference to characters of string. String must outlive reference
+        \param[in] s string
+     */
+    StringRef(const std::string& s);
+    /*! Returns characters of string. They are not necessarily zero-terminated
+        \return characters
+     */
+    const char* data() const
+    {
+        return m_data;
+    }
+    /*! Returns amount of characters
+        \return amount of characters
+     */
+    size_t size() const
+    {
+        return m_size;
+    }
+    /*! Returns true, if string is empty
+        \return whether string is empty
+     */
+    bool empty() const;
+    /*! Returns character at specified position
+        \param[in] i a position, which must be less than size
+        \return character
+     */
+    char operator[](size_t i) const;
+    /*! Copies characters into owned string
+        \return string
+     */
+    std::string str() const;
+    /*! Compares characters of strings
+        \param[in] o other string
+        \return true if strings are equal
+     */
+    bool operator==(const dukpp03::StringRef& o) const;
+    /*! Compares characters of strings
+        \param[in] o other string
+        \return true if strings are not equal
+     */
+    bool operator!=(const dukpp03::StringRef& o) const;
+private:
+    /*! Characters of string
+     */
+    const char* m_data;
+    /*! Amount of characters
+     */
+    size_t m_size;
+};
+
+/*! Makes possible to take borrowed strings as arguments of functions
+ */
+template<
+    typename _Context
+>
+class GetValue<dukpp03::StringRef, _Context>
+{
+public:
+    /*! Performs getting value from stack
+        \param[in] ctx context
+        \param[in] pos index for stack
+        \return a value if it exists, otherwise empty maybe
+     */
+    static dukpp03::Maybe<dukpp03::StringRef> perform(_Context* ctx, duk_idx_t pos)
+    {
+        dukpp03::Maybe<dukpp03::StringRef> result;
+        duk_size_t length = 0;
+        const char* s = duk_get_lstring(ctx->context(), pos, &length);
+        if (s)
+        {
+            result.setValue(dukpp03::StringRef(s, length));
+        }
+        return result;
+    }
+};
+
+/*! Makes possible to return borrowed strings from functions. Characters are copied into heap
+ */
+template<
+    typename _Context
+>
+class PushValue<dukpp03::StringRef, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value
+     */
+    static void perform(_Context* ctx, const dukpp03::StringRef& v)
+    {
+        duk_push_lstring(ctx->context(), v.data(), v.size());
+    }
+};
+
+#ifdef DUKPP03_HAS_STRING_VIEW
+
+/*! Makes possible to take std::string_view as argument of functions. View points into string on stack
+    of context, so it's valid only while function is called
+ */
+template<
+    typename _Context
+>
+class GetValue<std::string_view, _Context>
+{
+public:
+    /*! Performs getting value from stack
+        \param[in] ctx context
+        \param[in] pos index for stack
+        \return a value if it exists, otherwise empty maybe
+     */
+    static dukpp03::Maybe<std::string_view> perform(_Context* ctx, duk_idx_t pos)
+    {
+        dukpp03::Maybe<std::string_view> result;
+        duk_size_t length = 0;
+        const char* s = duk_get_lstring(ctx->context(), pos, &length);
+        if (s)
+        {
+            result.setValue(std::string_view(s, length));
+        }
+        return result;
+    }
+};
+
+/*! Makes possible to return std::string_view from functions. Characters are copied into heap
+ */
+template<
+    typename _Context
+>
+class PushValue<std::string_view, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value
+     */
+    static void perform(_Context* ctx, const std::string_view& v)
+    {
+        duk_push_lstring(ctx->context(), v.data(), v.size());
+    }
+};
+
+#endif
+
+}
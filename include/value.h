@@ -0,0 +1,255 @@
+/*! \file value.h
+
+    Defines a self-contained value, which does not depend on any heap, so it could be passed
+    between contexts and threads
+ */
+#pragma once
+#include "duk_custom.h"
+#include "../duktape/src/duktape.h"
+#include "maybe.h"
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace dukpp03
+{
+
+template<
+    typename _Value,
+    typename _Context
+>
+class PushValue;
+
+template<
+    typename _Value,
+    typename _Context
+>
+class GetValue;
+
+/*! A self-contained value: undefined, null, boolean, number, string, array or plain object.
+    Value owns all of it's data, so it could be read from stack of one context and pushed into
+    another one, possibly in other thread. Functions, pointers and cycles cannot be represented and
+    are replaced with undefined.
+ */
+class Value
+{
+public:
+    /*! A type of value
+     */
+    enum class Type
+    {
+        Undefined,
+        Null,
+        Boolean,
+        Number,
+        String,
+        Array,
+        Object
+    };
+    /*! A named property of object
+     */
+    typedef std::pair<std::string, dukpp03::Value> Property;
+    /*! A maximal depth of nested arrays and objects, which is read from stack
+     */
+    static const int MaximalDepth = 64;
+    /*! Creates undefined value
+     */
+    Value();
+    /*! Creates boolean value
+        \param[in] v value
+     */
+    Value(bool v);
+    /*! Creates number value
+        \param[in] v value
+     */
+    Value(double v);
+    /*! Creates number value
+        \param[in] v value
+     */
+    Value(int v);
+    /*! Creates string value
+        \param[in] v value
+     */
+    Value(const std::string& v);
+    /*! Creates string value
+        \param[in] v value
+     */
+    Value(const char* v);
+    /*! Creates null value
+        \return null value
+     */
+    static dukpp03::Value null();
+    /*! Creates empty array
+        \return empty array
+     */
+    static dukpp03::Value array();
+    /*! Creates empty object
+        \return empty object
+     */
+    static dukpp03::Value object();
+    /*! Returns type of value
+        \return type
+     */
+    dukpp03::Value::Type type() const;
+    /*! Returns true, if value is undefined
+        \return whether value is undefined
+     */
+    bool isUndefined() const;
+    /*! Returns true, if value is null
+        \return whether value is null
+     */
+    bool isNull() const;
+    /*! Returns boolean value. Returns false for other types
+        \return value
+     */
+    bool asBoolean() const;
+    /*! Returns number value. Returns zero for other types
+        \return value
+     */
+    double asNumber() const;
+    /*! Returns string value. Returns empty string for other types
+        \return value
+     */
+    const std::string& asString() const;
+    /*! Returns elements of array. Empty for other types
+        \return elements
+     */
+    const std::vector<dukpp03::Value>& elements() const;
+    /*! Returns properties of object in order of their insertion. Empty for other types
+        \return properties
+     */
+    const std::vector<dukpp03::Value::Property>& properties() const;
+    /*! Appends element to array. Value becomes array, if it's not
+        \param[in] v element
+     */
+    void append(const dukpp03::Value& v);
+    /*! Sets property of object, replacing existing one. Value becomes object, if it's not
+        \param[in] name a name of property
+        \param[in] v value of property
+     */
+    void set(const std::string& name, const dukpp03::Value& v);
+    /*! Returns property of object
+        \param[in] name a name of property
+        \return value of property if it exists
+     */
+    dukpp03::Maybe<dukpp03::Value> get(const std::string& name) const;
+    /*! Returns amount of elements in array or properties in object
+        \return amount
+     */
+    size_t size() const;
+    /*! Compares values structurally
+        \param[in] o other value
+        \return true if values are equal
+     */
+    bool operator==(const dukpp03::Value& o) const;
+    /*! Compares values structurally
+        \param[in] o other value
+        \return true if values are not equal
+     */
+    bool operator!=(const dukpp03::Value& o) const;
+    /*! Pushes value on stack of context
+        \param[in] ctx context
+     */
+    void push(duk_context* ctx) const;
+    /*! Reads value from stack of context. Accessors are not called and proxies are read as plain objects,
+        so properties, defined by getters, are skipped
+        \param[in] ctx context
+        \param[in] pos a position of value on stack
+        \return value or undefined, if value could not be read
+     */
+    static dukpp03::Value fromStack(duk_context* ctx, duk_idx_t pos);
+    /*! Reads value from stack of context in protected call, so errors, raised while reading, e.g. when
+        running out of memory, are reported instead of being fatal. Accessors are not called
+        \param[in] ctx context
+        \param[in] pos a position of value on stack
+        \param[out] result a value or undefined on failure
+        \param[out] error an error, if reading failed
+        \return true on success
+     */
+    static bool fromStack(duk_context* ctx, duk_idx_t pos, dukpp03::Value& result, std::string* error);
+private:
+    /*! Reads value from stack of context
+        \param[in] ctx context
+        \param[in] pos a position of value on stack
+        \param[in] depth a current depth of nested values
+        \return value
+     */
+    static dukpp03::Value fromStack(duk_context* ctx, duk_idx_t pos, int depth);
+    /*! Reads value on top of stack into value, passed as user data. Called via duk_safe_call
+        \param[in] ctx context
+        \param[in] udata a resulting value
+        \return 0
+     */
+    static duk_ret_t readInProtectedCall(duk_context* ctx, void* udata);
+    /*! Replaces key on top of stack with value of own data property of object. Accessors are not called
+        \param[in] ctx context
+        \param[in] obj an index of object on stack
+        \return true if property is data property. Otherwise key is popped and nothing is pushed
+     */
+    static bool pushOwnDataProperty(duk_context* ctx, duk_idx_t obj);
+    /*! A type of value
+     */
+    dukpp03::Value::Type m_type;
+    /*! A boolean value
+     */
+    bool m_boolean;
+    /*! A number value
+     */
+    double m_number;
+    /*! A string value
+     */
+    std::string m_string;
+    /*! Elements of array
+     */
+    std::vector<dukpp03::Value> m_elements;
+    /*! Properties of object
+     */
+    std::vector<dukpp03::Value::Property> m_properties;
+};
+
+/*! Makes possible to pass self-contained values to functions
+ */
+template<
+    typename _Context
+>
+class GetValue<dukpp03::Value, _Context>
+{
+public:
+    /*! Performs getting value from stack
+        \param[in] ctx context
+        \param[in] pos index for stack
+        \return a value, or empty maybe, if value could not be read
+     */
+    static dukpp03::Maybe<dukpp03::Value> perform(_Context* ctx, duk_idx_t pos)
+    {
+        dukpp03::Maybe<dukpp03::Value> result;
+        result.setValue(dukpp03::Value());
+        if (!dukpp03::Value::fromStack(ctx->context(), pos, result.mutableValue(), nullptr))
+        {
+            // Reading could fail only because of contents of object, so overload, chosen for it, must not be cached
+            ctx->setValueDependentMatch(true);
+            result.clear();
+        }
+        return result;
+    }
+};
+
+/*! Makes possible to return self-contained values from functions
+ */
+template<
+    typename _Context
+>
+class PushValue<dukpp03::Value, _Context>
+{
+public:
+    /*! Performs pushing value
+        \param[in] ctx context
+        \param[in] v value
+     */
+    static void perform(_Context* ctx, const dukpp03::Value& v)
+    {
+        v.push(ctx->context());
+    }
+};
+
+}
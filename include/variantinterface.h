@@ -27,6 +27,20 @@ public:
         typename _UnderlyingValue
     >
     static _VariantType* makeFrom(_UnderlyingValue val);
+    /*! Makes variant from value in specified storage via placement new. Used by context
+        to keep variants in pool instead of allocating each of them on heap
+        \param[in] storage a storage, big enough for variant and aligned at least by 8 bytes
+        \param[in] val value
+        \return variant value
+     */
+    template<
+        typename _UnderlyingValue
+    >
+    static _VariantType* makeAt(void* storage, _UnderlyingValue val);
+    /*! Destroys variant, made by makeAt, without freeing it's storage
+        \param[in] v variant
+     */
+    static void destroyAt(_VariantType* v);
     /*! Fetches underlying value from variant type. Note,
         that if we are stored T* in variant and requesting value of
         type T this function MUST return empty maybe, because in other cases 
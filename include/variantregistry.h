@@ -0,0 +1,115 @@
+/*! \file variantregistry.h
+
+    Defines a registry of variants, owned by objects of context
+ */
+#pragma once
+#include <vector>
+#include <cstddef>
+
+namespace dukpp03
+{
+
+/*! A registry of variants, owned by objects of context. Variants are kept in table of slots,
+    reused via free list, so registering and unregistering variant is O(1) and does not hash or
+    allocate memory. Each registration is identified by handle, which contains index of slot and
+    generation of slot, incremented when slot is freed, so stale handles are never mistaken for new ones.
+
+    Objects keep handle instead of pointer to variant. Handle fits into 53 bits, so it's stored as number
+ */
+class VariantRegistry
+{
+public:
+    /*! A handle of registration
+     */
+    typedef unsigned long long Handle;
+    /*! An invalid handle, never returned by insert
+     */
+    static const Handle InvalidHandle = 0;
+    /*! Constructs empty registry
+     */
+    VariantRegistry();
+    /*! Registers variant
+        \param[in] v variant
+        \param[in] type a tag of type of value in variant, returned by typeTag, or nullptr if type is unknown
+        \return handle of registration
+     */
+    dukpp03::VariantRegistry::Handle insert(void* v, const void* type = nullptr);
+    /*! Returns variant, registered with specified handle
+        \param[in] h handle
+        \return variant or nullptr if handle is invalid or stale
+     */
+    void* find(dukpp03::VariantRegistry::Handle h) const;
+    /*! Returns tag of type of value in variant, registered with specified handle
+        \param[in] h handle
+        \return tag or nullptr if handle is invalid or stale, or type is unknown
+     */
+    const void* type(dukpp03::VariantRegistry::Handle h) const;
+    /*! Returns tag, which identifies type. Tags of different types are different
+        \return tag
+     */
+    template<
+        typename _Type
+    >
+    static const void* typeTag()
+    {
+        static const char tag = 0;
+        return &tag;
+    }
+    /*! Unregisters variant with specified handle
+        \param[in] h handle
+        \return unregistered variant or nullptr if handle is invalid or stale
+     */
+    void* take(dukpp03::VariantRegistry::Handle h);
+    /*! Checks, whether variant is registered, looking through all slots. Slow, use contains with handle instead
+        \param[in] v variant
+        \return true if registered
+     */
+    bool contains(void* v) const;
+    /*! Unregisters variant, looking through all slots. Slow, use remove with handle instead
+        \param[in] v variant
+        \return true if variant was registered
+     */
+    bool remove(void* v);
+    /*! Returns amount of registered variants
+        \return amount of variants
+     */
+    size_t size() const;
+    /*! Unregisters all variants
+     */
+    void clear();
+private:
+    /*! A slot of registry
+     */
+    struct Slot
+    {
+        /*! A registered variant or nullptr if slot is free
+         */
+        void* Variant;
+        /*! A tag of type of value in variant
+         */
+        const void* Type;
+        /*! A generation of slot
+         */
+        unsigned int Generation;
+    };
+    /*! Returns index of slot for handle
+        \param[in] h handle
+        \return index of slot or size of table if handle is invalid or stale
+     */
+    size_t slot(dukpp03::VariantRegistry::Handle h) const;
+    /*! Frees slot, incrementing it's generation
+        \param[in] index an index of slot
+     */
+    void release(size_t index);
+    /*! Slots of registry
+     */
+    std::vector<dukpp03::VariantRegistry::Slot> m_slots;
+    /*! Indexes of free slots
+     */
+    std::vector<unsigned int> m_free;
+    /*! Amount of registered variants
+     */
+    size_t m_size;
+};
+
+}
@@ -0,0 +1,96 @@
+/*! \file watchdog.h
+
+    Defines a watchdog, which tracks deadlines of evaluations on separate thread
+ */
+#pragma once
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace dukpp03
+{
+
+/*! A watchdog, which owns a thread, sleeping until nearest deadline of armed evaluations and
+    raising their flags, when deadline expires. With watchdog, check of timeout in interrupt
+    hook of Duktape is a single relaxed load of flag instead of reading a clock.
+
+    One watchdog could be shared by any amount of contexts in any threads. See
+    dukpp03::AbstractContext::setWatchdog
+ */
+class Watchdog
+{
+public:
+    /*! Starts thread of watchdog
+     */
+    Watchdog();
+    /*! Stops thread of watchdog. All flags must be disarmed before watchdog is destroyed
+     */
+    ~Watchdog();
+    /*! Returns watchdog, shared by whole process. It's created on first call
+        \return shared watchdog
+     */
+    static dukpp03::Watchdog* shared();
+    /*! Clears flag and sets deadline for it. If flag is already armed, deadline is replaced
+        \param[in] flag a flag, which will be set, when deadline expires. Must be valid until disarmed
+        \param[in] time an amount of milliseconds until deadline
+     */
+    void arm(std::atomic<bool>* flag, double time);
+    /*! Removes deadline for flag. When this function returns, watchdog no longer touches flag
+        \param[in] flag a flag
+     */
+    void disarm(std::atomic<bool>* flag);
+    /*! Returns amount of currently armed flags
+        \return amount of flags
+     */
+    size_t armed();
+private:
+    /*! A clock for deadlines
+     */
+    typedef std::chrono::steady_clock Clock;
+    /*! An armed flag with deadline
+     */
+    struct Deadline
+    {
+        /*! A flag
+         */
+        std::atomic<bool>* Flag;
+        /*! A time point, when flag should be set
+         */
+        Clock::time_point Time;
+    };
+    /*! A watchdog is non-copyable
+        \param[in] o other watchdog
+     */
+    Watchdog(const dukpp03::Watchdog& o);
+    /*! A watchdog is non-copyable
+        \param[in] o other watchdog
+        \return self-reference
+     */
+    dukpp03::Watchdog& operator=(const dukpp03::Watchdog& o);
+    /*! A loop of thread of watchdog
+     */
+    void run();
+    /*! A lock for deadlines and stopping flag
+     */
+    std::mutex m_mutex;
+    /*! A condition, signalled when earlier deadline is armed or watchdog is stopping
+     */
+    std::condition_variable m_wake;
+    /*! Armed deadlines
+     */
+    std::vector<dukpp03::Watchdog::Deadline> m_deadlines;
+    /*! A time point, until which thread of watchdog sleeps
+     */
+    dukpp03::Watchdog::Clock::time_point m_sleep_until;
+    /*! Whether watchdog is stopping
+     */
+    bool m_stopping;
+    /*! A thread of watchdog
+     */
+    std::thread m_thread;
+};
+
+}
@@ -139,23 +139,14 @@ public:
     )
     {
         dukpp03::Maybe<QObject*> result;
-        if (duk_is_object(ctx->context(), pos))
+        QVariant* v = ctx->variantFromObject(pos);
+        if (v)
         {
-            duk_get_prop_string(ctx->context(), pos, DUKPP03_VARIANT_PROPERTY_SIGNATURE);
-            if (duk_is_pointer(ctx->context(), -1))
+            QObject* o = dukpp03::qt::toQObject(v);
+            if (o)
             {
-                void* ptr = duk_to_pointer(ctx->context(), -1);
-                auto* v = static_cast<QVariant*>(ptr);
-                if (v)
-                {
-                    QObject* o = dukpp03::qt::toQObject(v);
-                    if (o)
-                    {
-                        result.setValue(o);
-                    }
-                }
+                result.setValue(o);
             }
-            duk_pop(ctx->context());
         }
         return result;
     }
@@ -214,17 +205,11 @@ inline static dukpp03::Maybe<QVariant> perform(
     }
     if (duk_is_object(ctx->context(), pos))
     {
-        duk_get_prop_string(ctx->context(), pos, DUKPP03_VARIANT_PROPERTY_SIGNATURE);
-        if (duk_is_pointer(ctx->context(), -1))
+        QVariant* v = ctx->variantFromObject(pos);
+        if (v)
         {
-            void* ptr = duk_to_pointer(ctx->context(), -1);
-            auto* v = static_cast<QVariant *>(ptr);
-            if (v)
-            {
-                result.setValue(*v);
-            }
+            result.setValue(*v);
         }
-        duk_pop(ctx->context());
     }
     return result;
 }
@@ -122,7 +122,7 @@ QObject* dukpp03::qt::MetaPropertyAccessor::checkThis(dukpp03::qt::BasicContext*
 {
     dukpp03::Maybe< QObject* > maybe_this_object;
 
-    dukpp03::qt::Context::LocalCallable::CheckArgument< QObject* >::passedAsThis(c, maybe_this_object);
+    dukpp03::qt::Context::LocalCallable::CheckArgument< QObject* >::fromThis(c, maybe_this_object);
     if (maybe_this_object.exists())
     {
         QObject* this_object  = maybe_this_object.value();
@@ -7,20 +7,15 @@
 
 duk_ret_t dukpp03::qt::qobjectfinalizer(duk_context* ctx)
 {
-    QVariant* v = dukpp03::Finalizer<dukpp03::qt::BasicContext>::getVariantToFinalize(ctx);
-    dukpp03::qt::BasicContext* parent  = static_cast<dukpp03::qt::BasicContext*>(dukpp03::AbstractContext::getContext(ctx));
+    QVariant* v = dukpp03::Finalizer<dukpp03::qt::BasicContext>::claimVariantToFinalize(ctx);
     if (v)
     {
-        if (parent->isVariantRegistered(v))
+        QVariant result;
+        if (dukpp03::qt::Convert::convert("QObject*", v, result))
         {
-            QVariant result;
-            if (dukpp03::qt::Convert::convert("QObject*", v, result))
-            {
-                delete result.value<QObject*>();
-            }
-            parent->unregisterVariant(v);
-            delete v;
+            delete result.value<QObject*>();
         }
+        delete v;
     }
     return 0;
 }
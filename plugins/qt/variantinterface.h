@@ -9,6 +9,7 @@
 #include <QVariant>
 #include <QMetaType>
 #include <QObject>
+#include <new>
 
 namespace dukpp03
 {
@@ -33,6 +34,25 @@ public:
     {
         return new QVariant(QVariant::fromValue(val));
     }
+    /*! Makes variant from value in specified storage
+        \param[in] storage a storage
+        \param[in] val value
+        \return new variant
+     */
+    template<
+        typename _UnderlyingValue
+    >
+    static Variant* makeAt(void* storage, _UnderlyingValue val)
+    {
+        return new (storage) QVariant(QVariant::fromValue(val));
+    }
+    /*! Destroys variant, made by makeAt, without freeing it's storage
+        \param[in] v variant
+     */
+    static void destroyAt(Variant* v)
+    {
+        v->~QVariant();
+    }
     /*! Fetches underlying value from variant type
         \param[in] v a variant, containing data
         \return an underlying value
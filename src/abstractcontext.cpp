@@ -1,22 +1,34 @@
 #include "../include/abstractcontext.h"
 #include "../include/callable.h"
+#include "../include/externalbuffer.h"
 #include <cassert>
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
 
-/*! A property, where located pointer to callable in wrapper
+/*! A property of heap stash, which contains array of interned keys
  */
-#define DUKPP03_NATIVE_FUNCTION_SIGNATURE_PROPERTY "\1_____native_signature\1"
+#define DUKPP03_INTERNED_KEYS_PROPERTY "\1dukpp03::InternedKeys\1"
 
-dukpp03::AbstractContext::AbstractContext() : m_maximal_execution_time(30000), m_running(false)
+dukpp03::AbstractContext::AbstractContext(dukpp03::Allocator* allocator) 
+: m_maximal_execution_time(30000), m_running(false), m_evaluation_depth(0), m_maximal_instructions(0), m_timeout_checks(0), m_cancellation_token(nullptr),
+m_pinned_value_index(0), m_has_released_pinned_values(false), m_script_cache(this), m_allocator(allocator), m_watchdog(nullptr), m_deadline_expired(false), m_value_dependent_match(false)
 {
-    m_context = duk_create_heap(nullptr, nullptr, nullptr, this, nullptr);
-    duk_print_alert_init(m_context, 0 /*flags*/);
+    m_key_names.push_back(DUKPP03_NATIVE_FUNCTION_SIGNATURE_PROPERTY);
+    m_key_names.push_back(DUKPP03_VARIANT_PROPERTY_SIGNATURE);
+    m_key_names.push_back(DUKPP03_JSOBJECT_POINTER_SIGNATURE);
+    m_key_names.push_back(DUKPP03_EXTERNAL_BUFFER_SIGNATURE);
+    for(size_t i = 0; i < m_key_names.size(); i++)
+    {
+        m_key_indexes[m_key_names[i]] = i;
+    }
+    this->createHeap();
 }
 
 dukpp03::AbstractContext::~AbstractContext()
 {
+    m_script_cache.clear();
+    this->detachPinnedValues();
     if (m_context)
     {
          duk_destroy_heap(m_context);
@@ -32,10 +44,18 @@ dukpp03::AbstractContext* dukpp03::AbstractContext::getContext(duk_context* ctx)
     return static_cast<dukpp03::AbstractContext*>(funcs.udata);
 }
 
+bool dukpp03::AbstractContext::usesFastIntegers()
+{
+#ifdef DUK_USE_FASTINT
+    return true;
+#else
+    return false;
+#endif
+}
+
 bool dukpp03::AbstractContext::eval(const std::string& string, bool clean_heap, std::string* error)
 {
-    m_running = true;
-    startEvaluating();
+    this->beginEvaluation();
     duk_push_string(m_context, string.c_str());
     bool result = false;
     if (duk_peval(m_context) != 0) 
@@ -67,18 +87,26 @@ bool dukpp03::AbstractContext::eval(const std::string& string, bool clean_heap,
             duk_pop(m_context);
         }
     }
-    m_running = false;
+    this->endEvaluation();
     return result;
 }
 
 bool dukpp03::AbstractContext::eval(const std::string& string, const std::string& filename, bool clean_heap, std::string* error)
 {
-    m_running = true;
-    startEvaluating();
-    duk_push_string(m_context, string.c_str());
-    duk_push_string(m_context, filename.c_str());
+    this->beginEvaluation();
     bool result = false;
-    if (duk_pcompile(m_context, DUK_COMPILE_EVAL) == 0)
+    bool compiled = m_script_cache.push(string, filename);
+    if (!compiled)
+    {
+        duk_push_string(m_context, string.c_str());
+        duk_push_string(m_context, filename.c_str());
+        compiled = (duk_pcompile(m_context, DUK_COMPILE_EVAL) == 0);
+        if (compiled)
+        {
+            m_script_cache.insert(string, filename);
+        }
+    }
+    if (compiled)
     {
         duk_push_global_object(m_context);  /* 'this' binding */
         if (duk_pcall_method(m_context, 0) != 0) 
@@ -136,7 +164,7 @@ bool dukpp03::AbstractContext::eval(const std::string& string, const std::string
                 duk_pop(m_context);
         }
     }
-    m_running = false;
+    this->endEvaluation();
     return result;
 }
 
@@ -153,6 +181,22 @@ bool dukpp03::AbstractContext::timeoutReached() const
     {
         return false;
     }
+    if (m_cancellation_token && m_cancellation_token->cancelled())
+    {
+        return true;
+    }
+    if (m_maximal_instructions != 0)
+    {
+        ++m_timeout_checks;
+        if (m_timeout_checks * dukpp03::AbstractContext::InstructionsPerCheck > m_maximal_instructions)
+        {
+            return true;
+        }
+    }
+    if (m_watchdog)
+    {
+        return m_deadline_expired.load(std::memory_order_relaxed);
+    }
     double elapsed_time = const_cast<dukpp03::AbstractContext*>(this)->elapsedFromEvaluation();
     return (elapsed_time >= m_maximal_execution_time);
 }
@@ -167,6 +211,68 @@ double dukpp03::AbstractContext::maximumExecutionTime() const
     return m_maximal_execution_time;
 }
 
+void dukpp03::AbstractContext::setMaximumInstructions(unsigned long long count)
+{
+    m_maximal_instructions = count;
+}
+
+unsigned long long dukpp03::AbstractContext::maximumInstructions() const
+{
+    return m_maximal_instructions;
+}
+
+void dukpp03::AbstractContext::setCancellationToken(dukpp03::CancellationToken* token)
+{
+    m_cancellation_token = token;
+}
+
+dukpp03::CancellationToken* dukpp03::AbstractContext::cancellationToken() const
+{
+    return m_cancellation_token;
+}
+
+void dukpp03::AbstractContext::setWatchdog(dukpp03::Watchdog* watchdog)
+{
+    m_watchdog = watchdog;
+}
+
+dukpp03::Watchdog* dukpp03::AbstractContext::watchdog() const
+{
+    return m_watchdog;
+}
+
+bool dukpp03::AbstractContext::loadBundle(const std::string& path, std::string* error)
+{
+    this->beginEvaluation();
+    bool result = dukpp03::Bundle::load(m_context, path, error);
+    this->endEvaluation();
+    return result;
+}
+
+bool dukpp03::AbstractContext::runBytecode(const std::vector<unsigned char>& bytecode, const std::string& name, std::string* error)
+{
+    if (bytecode.empty())
+    {
+        if (error)
+        {
+            *error = name + ": empty bytecode";
+        }
+        return false;
+    }
+    this->beginEvaluation();
+    bool result = dukpp03::Bundle::run(m_context, &(bytecode[0]), bytecode.size(), name, error);
+    this->endEvaluation();
+    return result;
+}
+
+duk_int_t dukpp03::AbstractContext::pcall(duk_idx_t nargs)
+{
+    this->beginEvaluation();
+    duk_int_t result = duk_pcall(m_context, nargs);
+    this->endEvaluation();
+    return result;
+}
+
 void dukpp03::AbstractContext::throwError(const std::string& error_string, dukpp03::ErrorCodes code)
 {
     duk_push_error_object(m_context, static_cast<int>(code), error_string.c_str());
@@ -220,11 +326,7 @@ void dukpp03::AbstractContext::registerNativeFunction(const std::string& callabl
     duk_push_global_object(m_context);
 
     duk_push_c_function(m_context, f, args);
-    duk_int_t result = duk_peval_string(m_context, "new Function()");
-    assert(result == 0);
-    duk_dup(m_context, -1);
-    duk_put_prop_string(m_context, -3, "prototype");
-    duk_set_prototype(m_context, - 2);
+    this->initFunctionPrototype();
 
     duk_put_prop_string(m_context, -2 /*idx:global*/, callable_name.c_str());
     duk_pop(m_context);  
@@ -236,14 +338,12 @@ void dukpp03::AbstractContext::throwCaughtException()
 }
 
 static int dukpp03_context_invoke_wrapper(duk_context *ctx) {
-    duk_push_current_function(ctx);
-    duk_get_prop_string(ctx, -1, DUKPP03_NATIVE_FUNCTION_SIGNATURE_PROPERTY);
-    void* callableptr = duk_to_pointer(ctx, -1);
-    duk_pop(ctx);
-    duk_pop(ctx);
-
-    assert(callableptr);
     dukpp03::AbstractContext* c =  dukpp03::AbstractContext::getContext(ctx);
+    void* callableptr = c->currentCallable(ctx);
+    if (!callableptr)
+    {
+        return DUK_RET_REFERENCE_ERROR;
+    }
     return c->call(callableptr);
 }
 
@@ -270,16 +370,331 @@ void dukpp03::AbstractContext::pushCallable(dukpp03::AbstractCallable* callable,
    
    duk_push_c_function(m_context, wrapper, DUK_VARARGS);
    
-   duk_push_string(m_context, DUKPP03_NATIVE_FUNCTION_SIGNATURE_PROPERTY);   
-   duk_push_pointer(m_context, callable);
-   duk_def_prop(m_context, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_HAVE_WRITABLE | 0);
+   const duk_int_t magic = this->callableMagic(callable);
+   if (magic != 0)
+   {
+       duk_set_magic(m_context, -1, magic);
+   }
+   else
+   {
+       this->pushKey(dukpp03::AbstractContext::NativeFunctionKey);
+       duk_push_pointer(m_context, callable);
+       duk_def_prop(m_context, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_HAVE_WRITABLE | 0);
+   }
 
    /* Init it with correct prototype */
-   duk_int_t result = duk_peval_string(m_context, "new Function()");
-   assert(result == 0);
-   duk_dup(m_context, -1);
-   duk_put_prop_string(m_context, -3, "prototype");
-   duk_set_prototype(m_context, - 2);   
+   this->initFunctionPrototype();
+}
+
+void* dukpp03::AbstractContext::currentCallable(duk_context* ctx)
+{
+    const duk_int_t magic = duk_get_current_magic(ctx);
+    if (magic > 0)
+    {
+        return m_callables[magic - 1];
+    }
+    duk_push_current_function(ctx);
+    this->getProperty(ctx, -1, dukpp03::AbstractContext::NativeFunctionKey);
+    void* result = duk_to_pointer(ctx, -1);
+    duk_pop_2(ctx);
+    return result;
+}
+
+size_t dukpp03::AbstractContext::callableTableSize() const
+{
+    return m_callables.size();
+}
+
+void dukpp03::AbstractContext::forgetCallable(dukpp03::AbstractCallable* callable)
+{
+    std::unordered_map<dukpp03::AbstractCallable*, duk_int_t>::iterator it = m_callable_magics.find(callable);
+    if (it != m_callable_magics.end())
+    {
+        m_callables[it->second - 1] = nullptr;
+        m_callable_magics.erase(it);
+    }
+}
+
+void dukpp03::AbstractContext::setCurrentFunctionAsPrototype()
+{
+    duk_push_current_function(m_context);
+    void* function = duk_get_heapptr(m_context, -1);
+    bool found = false;
+    duk_get_prototype(m_context, -2);
+    while(duk_is_object(m_context, -1) && !found)
+    {
+        found = (duk_get_heapptr(m_context, -1) == function);
+        duk_get_prototype(m_context, -1);
+        duk_remove(m_context, -2);
+    }
+    duk_pop(m_context);
+    if (found)
+    {
+        duk_pop(m_context);
+    }
+    else
+    {
+        duk_set_prototype(m_context, -2);
+    }
+}
+
+dukpp03::PinnedValue* dukpp03::AbstractContext::pin(duk_idx_t pos)
+{
+    const duk_idx_t index = duk_normalize_index(m_context, pos);
+    this->removeReleasedPinnedValues();
+    const duk_uarridx_t stash_index = m_pinned_value_index++;
+    duk_push_heap_stash(m_context);
+    duk_dup(m_context, index);
+    duk_put_prop_index(m_context, -2, stash_index);
+    duk_pop(m_context);
+
+    std::lock_guard<std::mutex> lock(dukpp03::PinnedValue::mutex());
+    dukpp03::PinnedValue* result = new dukpp03::PinnedValue(this, duk_get_heapptr(m_context, index), stash_index, m_pinned_values.size());
+    m_pinned_values.push_back(result);
+    return result;
+}
+
+void dukpp03::AbstractContext::unpin(dukpp03::PinnedValue* v)
+{
+    const size_t slot = v->slot();
+    assert( slot < m_pinned_values.size() && m_pinned_values[slot] == v );
+    m_pinned_values[slot] = m_pinned_values[m_pinned_values.size() - 1];
+    m_pinned_values[slot]->setSlot(slot);
+    m_pinned_values.pop_back();
+    m_released_pinned_values.push_back(v->index());
+    m_has_released_pinned_values = true;
+    v->detach();
+}
+
+dukpp03::Allocator* dukpp03::AbstractContext::allocator() const
+{
+    return m_allocator;
+}
+
+dukpp03::ScriptCache& dukpp03::AbstractContext::scriptCache()
+{
+    return m_script_cache;
+}
+
+/*! A key in heap stash, where baseline state of global object is stored
+ */
+#define DUKPP03_GLOBAL_BASELINE_PROPERTY "dukpp03_global_baseline"
+
+/*! Fields of property descriptor, compared when restoring global object
+ */
+static const char* dukpp03_descriptor_fields[] = { "value", "get", "set", "writable", "enumerable", "configurable" };
+
+/*! Replaces key on top of stack with descriptor of own property of object. Prototype of descriptor
+    is removed, so reading it's fields never runs accessors, defined in Object.prototype
+    \param[in] ctx context
+    \param[in] obj an index of object
+ */
+static void dukpp03_get_own_descriptor(duk_context* ctx, duk_idx_t obj)
+{
+    duk_get_prop_desc(ctx, obj, 0);
+    if (duk_is_object(ctx, -1))
+    {
+        duk_push_undefined(ctx);
+        duk_set_prototype(ctx, -2);
+    }
+}
+
+/*! Throws error, unless descriptors could be read without running script. Duktape fills descriptors
+    via put, so properties of Object.prototype with names of fields of descriptor would be invoked
+    \param[in] ctx context
+ */
+static void dukpp03_require_plain_descriptors(duk_context* ctx)
+{
+    duk_push_object(ctx);
+    duk_get_prototype(ctx, -1);
+    duk_get_prototype(ctx, -1);
+    bool plain = duk_is_undefined(ctx, -1) != 0;
+    duk_pop(ctx);
+    for(size_t i = 0; plain && i < sizeof(dukpp03_descriptor_fields) / sizeof(const char*); i++)
+    {
+        plain = duk_has_prop_string(ctx, -1, dukpp03_descriptor_fields[i]) == 0;
+    }
+    duk_pop_2(ctx);
+    if (!plain)
+    {
+        duk_error(ctx, DUK_ERR_ERROR, "Object.prototype is changed, so global state could not be read");
+    }
+}
+
+static duk_ret_t dukpp03_save_global_state(duk_context* ctx, void*)
+{
+    dukpp03_require_plain_descriptors(ctx);
+    duk_push_heap_stash(ctx);
+    duk_push_bare_object(ctx);
+    duk_push_global_object(ctx);
+    duk_enum(ctx, -1, DUK_ENUM_OWN_PROPERTIES_ONLY | DUK_ENUM_INCLUDE_NONENUMERABLE);
+    while(duk_next(ctx, -1, 0))
+    {
+        // Descriptors are stored instead of values, so accessors are not invoked and attributes are kept
+        duk_dup(ctx, -1);
+        dukpp03_get_own_descriptor(ctx, -4);
+        duk_put_prop(ctx, -5);
+    }
+    duk_pop_2(ctx);
+    duk_put_prop_string(ctx, -2, DUKPP03_GLOBAL_BASELINE_PROPERTY);
+    duk_pop(ctx);
+    return 0;
+}
+
+/*! Checks, whether two property descriptors on stack describe the same property
+    \param[in] ctx context
+    \param[in] a an index of first descriptor
+    \param[in] b an index of second descriptor
+    \return true if descriptors are the same
+ */
+static bool dukpp03_same_descriptors(duk_context* ctx, duk_idx_t a, duk_idx_t b)
+{
+    for(size_t i = 0; i < sizeof(dukpp03_descriptor_fields) / sizeof(const char*); i++)
+    {
+        duk_get_prop_string(ctx, a, dukpp03_descriptor_fields[i]);
+        duk_get_prop_string(ctx, b, dukpp03_descriptor_fields[i]);
+        const bool same = duk_samevalue(ctx, -1, -2) != 0;
+        duk_pop_2(ctx);
+        if (!same)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*! Defines property of object with attributes, stored in descriptor on top of stack, popping key and descriptor
+    \param[in] ctx context
+    \param[in] obj an index of object
+ */
+static void dukpp03_define_from_descriptor(duk_context* ctx, duk_idx_t obj)
+{
+    const duk_idx_t desc = duk_get_top_index(ctx);
+    duk_uint_t flags = DUK_DEFPROP_HAVE_ENUMERABLE | DUK_DEFPROP_HAVE_CONFIGURABLE | DUK_DEFPROP_FORCE;
+    duk_get_prop_string(ctx, desc, "enumerable");
+    flags |= duk_to_boolean(ctx, -1) ? DUK_DEFPROP_ENUMERABLE : 0;
+    duk_get_prop_string(ctx, desc, "configurable");
+    flags |= duk_to_boolean(ctx, -1) ? DUK_DEFPROP_CONFIGURABLE : 0;
+    duk_pop_2(ctx);
+    duk_dup(ctx, desc - 1);
+    if (duk_has_prop_string(ctx, desc, "get") || duk_has_prop_string(ctx, desc, "set"))
+    {
+        duk_get_prop_string(ctx, desc, "get");
+        duk_get_prop_string(ctx, desc, "set");
+        flags |= DUK_DEFPROP_HAVE_GETTER | DUK_DEFPROP_HAVE_SETTER;
+    }
+    else
+    {
+        duk_get_prop_string(ctx, desc, "writable");
+        flags |= DUK_DEFPROP_HAVE_WRITABLE | (duk_to_boolean(ctx, -1) ? DUK_DEFPROP_WRITABLE : 0);
+        duk_pop(ctx);
+        duk_get_prop_string(ctx, desc, "value");
+        flags |= DUK_DEFPROP_HAVE_VALUE;
+    }
+    duk_def_prop(ctx, obj, flags);
+    duk_pop_2(ctx);
+}
+
+static duk_ret_t dukpp03_restore_global_state(duk_context* ctx, void*)
+{
+    dukpp03_require_plain_descriptors(ctx);
+    duk_push_global_object(ctx);                               // 0 - global object
+    duk_push_heap_stash(ctx);
+    duk_get_prop_string(ctx, -1, DUKPP03_GLOBAL_BASELINE_PROPERTY);
+    duk_remove(ctx, -2);                                       // 1 - baseline
+    if (!duk_is_object(ctx, 1))
+    {
+        return duk_error(ctx, DUK_ERR_ERROR, "Global state is not saved");
+    }
+    // Collect keys first, since global object is modified, while iterating them
+    duk_push_array(ctx);                                       // 2 - keys of global object
+    duk_uarridx_t count = 0;
+    duk_enum(ctx, 0, DUK_ENUM_OWN_PROPERTIES_ONLY | DUK_ENUM_INCLUDE_NONENUMERABLE);
+    while(duk_next(ctx, -1, 0))
+    {
+        duk_put_prop_index(ctx, 2, count++);
+    }
+    duk_pop(ctx);
+    // Only descriptors are compared, so getters, left by script, are never invoked
+    for(duk_uarridx_t i = 0; i < count; i++)
+    {
+        duk_get_prop_index(ctx, 2, i);                         // 3 - key
+        duk_dup(ctx, 3);
+        dukpp03_get_own_descriptor(ctx, 0);                    // 4 - current descriptor
+        duk_dup(ctx, 3);
+        if (duk_get_prop(ctx, 1))                              // 5 - saved descriptor
+        {
+            if (dukpp03_same_descriptors(ctx, 4, 5))
+            {
+                duk_pop(ctx);
+            }
+            else
+            {
+                duk_dup(ctx, 3);
+                duk_swap(ctx, -1, -2);
+                dukpp03_define_from_descriptor(ctx, 0);
+            }
+            duk_pop(ctx);
+        }
+        else
+        {
+            duk_pop(ctx);
+            duk_get_prop_string(ctx, 4, "configurable");
+            const bool configurable = duk_to_boolean(ctx, -1) != 0;
+            duk_pop_2(ctx);
+            duk_dup(ctx, 3);
+            if (configurable)
+            {
+                duk_del_prop(ctx, 0);
+            }
+            else
+            {
+                // Non-configurable properties could not be removed, so we just clear them
+                duk_push_undefined(ctx);
+                duk_def_prop(ctx, 0, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_FORCE);
+            }
+        }
+        duk_pop(ctx);
+    }
+    // Restore properties, that were deleted
+    duk_enum(ctx, 1, DUK_ENUM_OWN_PROPERTIES_ONLY);
+    while(duk_next(ctx, -1, 1))
+    {
+        duk_dup(ctx, -2);
+        duk_get_prop_desc(ctx, 0, 0);
+        const bool exists = duk_is_object(ctx, -1);
+        duk_pop(ctx);
+        if (exists)
+        {
+            duk_pop_2(ctx);
+        }
+        else
+        {
+            dukpp03_define_from_descriptor(ctx, 0);
+        }
+    }
+    duk_pop_3(ctx);
+    duk_pop(ctx);
+    return 0;
+}
+
+void dukpp03::AbstractContext::saveGlobalState()
+{
+    duk_safe_call(m_context, dukpp03_save_global_state, nullptr, 0, 1);
+    duk_pop(m_context);
+}
+
+bool dukpp03::AbstractContext::restoreGlobalState(std::string* error)
+{
+    this->beginEvaluation();
+    const bool result = (duk_safe_call(m_context, dukpp03_restore_global_state, nullptr, 0, 1) == DUK_EXEC_SUCCESS);
+    this->endEvaluation();
+    if (error)
+    {
+        *error = result ? "" : duk_safe_to_string(m_context, -1);
+    }
+    duk_pop(m_context);
+    return result;
 }
 
 void dukpp03::AbstractContext::registerCallable(const std::string& callable_name, dukpp03::AbstractCallable* callable, bool own)
@@ -294,14 +709,346 @@ void dukpp03::AbstractContext::registerCallable(const std::string& callable_name
 
 // ================================= PROTECTED METHODS =================================
 
+static void* dukpp03_heap_allocate(void* udata, duk_size_t size)
+{
+    return static_cast<dukpp03::AbstractContext*>(udata)->allocator()->allocate(size);
+}
+
+static void* dukpp03_heap_reallocate(void* udata, void* ptr, duk_size_t size)
+{
+    return static_cast<dukpp03::AbstractContext*>(udata)->allocator()->reallocate(ptr, size);
+}
+
+static void dukpp03_heap_free(void* udata, void* ptr)
+{
+    static_cast<dukpp03::AbstractContext*>(udata)->allocator()->free(ptr);
+}
+
+void dukpp03::AbstractContext::createHeap()
+{
+    if (m_allocator)
+    {
+        m_context = duk_create_heap(dukpp03_heap_allocate, dukpp03_heap_reallocate, dukpp03_heap_free, this, nullptr);
+    }
+    else
+    {
+        m_context = duk_create_heap(nullptr, nullptr, nullptr, this, nullptr);
+    }
+    duk_print_alert_init(m_context, 0 /*flags*/);
+    m_callables.clear();
+    m_callable_magics.clear();
+    m_overload_caches.clear();
+    m_keys.clear();
+    for(size_t i = 0; i < m_key_names.size(); i++)
+    {
+        this->internKeyInHeap(i);
+    }
+}
+
+void dukpp03::AbstractContext::beginEvaluation()
+{
+    if (m_evaluation_depth++ != 0)
+    {
+        return;
+    }
+    this->removeReleasedPinnedValues();
+    m_running = true;
+    m_timeout_checks = 0;
+    if (m_watchdog)
+    {
+        m_watchdog->arm(&m_deadline_expired, m_maximal_execution_time);
+    }
+    else
+    {
+        startEvaluating();
+    }
+}
+
+void dukpp03::AbstractContext::endEvaluation()
+{
+    if (--m_evaluation_depth != 0)
+    {
+        return;
+    }
+    m_running = false;
+    if (m_watchdog)
+    {
+        m_watchdog->disarm(&m_deadline_expired);
+    }
+}
+
 void dukpp03::AbstractContext::initContextBeforeAccessing()
 {
     
 }
 
+void dukpp03::AbstractContext::detachPinnedValues()
+{
+    std::lock_guard<std::mutex> lock(dukpp03::PinnedValue::mutex());
+    for(size_t i = 0; i < m_pinned_values.size(); i++)
+    {
+        m_pinned_values[i]->detach();
+    }
+    m_pinned_values.clear();
+    // Heap is going to be destroyed, so there is no need to remove values from it
+    m_released_pinned_values.clear();
+    m_has_released_pinned_values = false;
+}
+
+void dukpp03::AbstractContext::initFunctionPrototype()
+{
+    // A fresh function always inherits Function.prototype, so we could take it
+    // from function itself instead of evaluating "new Function()"
+    duk_push_object(m_context);
+    duk_get_prototype(m_context, -2);
+    duk_set_prototype(m_context, -2);
+    duk_dup(m_context, -1);
+    duk_put_prop_string(m_context, -3, "prototype");
+    duk_set_prototype(m_context, -2);
+}
+
+dukpp03::AbstractContext::PropertyKey dukpp03::AbstractContext::internKey(const std::string& name)
+{
+    std::unordered_map<std::string, dukpp03::AbstractContext::PropertyKey>::const_iterator it = m_key_indexes.find(name);
+    if (it != m_key_indexes.end())
+    {
+        return it->second;
+    }
+    m_key_names.push_back(name);
+    m_key_indexes[name] = m_key_names.size() - 1;
+    this->internKeyInHeap(m_key_names.size() - 1);
+    return m_key_names.size() - 1;
+}
+
+dukpp03::AbstractContext::KeySetId dukpp03::AbstractContext::newKeySet()
+{
+    static std::atomic<dukpp03::AbstractContext::KeySetId> last(0);
+    return ++last;
+}
+
+const std::vector<dukpp03::AbstractContext::PropertyKey>* dukpp03::AbstractContext::keySet(dukpp03::AbstractContext::KeySetId id) const
+{
+    std::unordered_map<dukpp03::AbstractContext::KeySetId, std::vector<dukpp03::AbstractContext::PropertyKey> >::const_iterator it = m_key_sets.find(id);
+    if (it != m_key_sets.end())
+    {
+        return &(it->second);
+    }
+    return nullptr;
+}
+
+const std::vector<dukpp03::AbstractContext::PropertyKey>& dukpp03::AbstractContext::internKeySet(dukpp03::AbstractContext::KeySetId id, const std::vector<std::string>& names)
+{
+    std::vector<dukpp03::AbstractContext::PropertyKey> keys;
+    keys.reserve(names.size());
+    for(size_t i = 0; i < names.size(); i++)
+    {
+        keys.push_back(this->internKey(names[i]));
+    }
+    std::vector<dukpp03::AbstractContext::PropertyKey>& result = m_key_sets[id];
+    result.swap(keys);
+    return result;
+}
+
+dukpp03::AbstractContext::OverloadCacheId dukpp03::AbstractContext::newOverloadCache()
+{
+    static std::atomic<dukpp03::AbstractContext::OverloadCacheId> last(0);
+    return ++last;
+}
+
+dukpp03::OverloadCache& dukpp03::AbstractContext::overloadCache(dukpp03::AbstractContext::OverloadCacheId id)
+{
+    return m_overload_caches[id];
+}
+
+size_t dukpp03::AbstractContext::keyCount() const
+{
+    return m_key_names.size();
+}
+
+void dukpp03::AbstractContext::pushKey(dukpp03::AbstractContext::PropertyKey key) const
+{
+    assert( key < m_keys.size() );
+    duk_push_heapptr(m_context, m_keys[key]);
+}
+
+bool dukpp03::AbstractContext::getProperty(duk_context* ctx, duk_idx_t obj, dukpp03::AbstractContext::PropertyKey key) const
+{
+    assert( key < m_keys.size() );
+    return duk_get_prop_heapptr(ctx, obj, m_keys[key]) != 0;
+}
+
+void dukpp03::AbstractContext::putProperty(duk_idx_t obj, dukpp03::AbstractContext::PropertyKey key) const
+{
+    assert( key < m_keys.size() );
+    duk_put_prop_heapptr(m_context, obj, m_keys[key]);
+}
+
+void dukpp03::AbstractContext::putProperty(duk_context* ctx, duk_idx_t obj, dukpp03::AbstractContext::PropertyKey key) const
+{
+    assert( key < m_keys.size() );
+    duk_put_prop_heapptr(ctx, obj, m_keys[key]);
+}
+
+void dukpp03::AbstractContext::pushExternalBuffer(dukpp03::ExternalBuffer* buffer, duk_uint_t type)
+{
+    assert( buffer );
+    duk_require_stack(m_context, 4);
+    const size_t size = buffer->size();
+    duk_push_external_buffer(m_context);
+    duk_config_buffer(m_context, -1, buffer->data(), size);
+    // Buffer is owned by ArrayBuffer, since views reference it and keep it alive, unlike plain buffer
+    duk_push_buffer_object(m_context, -1, 0, size, DUK_BUFOBJ_ARRAYBUFFER);
+    duk_push_array(m_context);
+    duk_push_pointer(m_context, buffer);
+    duk_put_prop_index(m_context, -2, 0);
+    duk_dup(m_context, -3);
+    duk_put_prop_index(m_context, -2, 1);
+    this->putProperty(-2, dukpp03::AbstractContext::ExternalBufferKey);
+    duk_remove(m_context, -2);
+    duk_push_c_function(m_context, dukpp03::ExternalBuffer::finalize, 2);
+    duk_set_finalizer(m_context, -2);
+    if (type != DUK_BUFOBJ_ARRAYBUFFER)
+    {
+        duk_push_buffer_object(m_context, -1, 0, size, type);
+        duk_remove(m_context, -2);
+    }
+}
+
+static duk_ret_t dukpp03_json_decode(duk_context* ctx, void*)
+{
+    duk_json_decode(ctx, -1);
+    return 1;
+}
+
+static duk_ret_t dukpp03_json_encode(duk_context* ctx, void*)
+{
+    duk_json_encode(ctx, -1);
+    return 1;
+}
+
+static duk_ret_t dukpp03_cbor_decode(duk_context* ctx, void*)
+{
+    duk_cbor_decode(ctx, -1, 0);
+    return 1;
+}
+
+static duk_ret_t dukpp03_cbor_encode(duk_context* ctx, void*)
+{
+    duk_cbor_encode(ctx, -1, 0);
+    return 1;
+}
+
+/*! Runs encoder or decoder for value on top of stack, replacing it with result
+    \param[in] ctx context
+    \param[in] f function
+    \param[out] error an error
+    \return true on success. On failure value is popped
+ */
+static bool dukpp03_transcode(duk_context* ctx, duk_safe_call_function f, std::string* error)
+{
+    if (duk_safe_call(ctx, f, nullptr, 1, 1) != DUK_EXEC_SUCCESS)
+    {
+        if (error)
+        {
+            *error = duk_safe_to_string(ctx, -1);
+        }
+        duk_pop(ctx);
+        return false;
+    }
+    if (error)
+    {
+        *error = "";
+    }
+    return true;
+}
+
+bool dukpp03::AbstractContext::decodeJSON(const char* data, size_t size, std::string* error)
+{
+    duk_require_stack(m_context, 1);
+    duk_push_lstring(m_context, data, size);
+    return dukpp03_transcode(m_context, dukpp03_json_decode, error);
+}
+
+bool dukpp03::AbstractContext::decodeCBOR(const unsigned char* data, size_t size, std::string* error)
+{
+    duk_require_stack(m_context, 1);
+    // Decoder copies strings and byte strings out of input, so it's not copied into heap
+    duk_push_external_buffer(m_context);
+    duk_config_buffer(m_context, -1, const_cast<unsigned char*>(data), size);
+    return dukpp03_transcode(m_context, dukpp03_cbor_decode, error);
+}
+
+bool dukpp03::AbstractContext::encodeJSON(duk_idx_t pos, std::string& result, std::string* error)
+{
+    duk_require_stack(m_context, 1);
+    duk_dup(m_context, pos);
+    if (!dukpp03_transcode(m_context, dukpp03_json_encode, error))
+    {
+        return false;
+    }
+    duk_size_t size = 0;
+    const char* data = duk_get_lstring(m_context, -1, &size);
+    if (data)
+    {
+        result.assign(data, size);
+    }
+    else if (error)
+    {
+        *error = "Value cannot be represented as JSON";
+    }
+    duk_pop(m_context);
+    return data != nullptr;
+}
+
+bool dukpp03::AbstractContext::encodeCBOR(duk_idx_t pos, std::vector<unsigned char>& result, std::string* error)
+{
+    duk_require_stack(m_context, 1);
+    duk_dup(m_context, pos);
+    if (!dukpp03_transcode(m_context, dukpp03_cbor_encode, error))
+    {
+        return false;
+    }
+    duk_size_t size = 0;
+    const unsigned char* data = static_cast<const unsigned char*>(duk_get_buffer_data(m_context, -1, &size));
+    result.assign(data, data + size);
+    duk_pop(m_context);
+    return true;
+}
+
+bool dukpp03::AbstractContext::valueDependentMatch() const
+{
+    return m_value_dependent_match;
+}
+
+void dukpp03::AbstractContext::setValueDependentMatch(bool value)
+{
+    m_value_dependent_match = value;
+}
+
 // ================================= PRIVATE METHODS =================================
 
-dukpp03::AbstractContext::AbstractContext(const dukpp03::AbstractContext& p)
+void dukpp03::AbstractContext::removeReleasedPinnedValues()
+{
+    if (!m_has_released_pinned_values)
+    {
+        return;
+    }
+    std::vector<duk_uarridx_t> indexes;
+    {
+        std::lock_guard<std::mutex> lock(dukpp03::PinnedValue::mutex());
+        indexes.swap(m_released_pinned_values);
+        m_has_released_pinned_values = false;
+    }
+    duk_push_heap_stash(m_context);
+    for(size_t i = 0; i < indexes.size(); i++)
+    {
+        duk_del_prop_index(m_context, -1, indexes[i]);
+    }
+    duk_pop(m_context);
+}
+
+dukpp03::AbstractContext::AbstractContext(const dukpp03::AbstractContext& p) : m_evaluation_depth(0), m_maximal_instructions(0), m_timeout_checks(0), m_cancellation_token(nullptr),
+m_has_released_pinned_values(false), m_script_cache(this), m_allocator(nullptr), m_watchdog(nullptr), m_deadline_expired(false), m_value_dependent_match(false)
 {
     throw std::logic_error("dukpp03::AbstractContext is non-copyable!");
 }
@@ -312,6 +1059,41 @@ dukpp03::AbstractContext& dukpp03::AbstractContext::operator=(const dukpp03::Abs
     return *this;
 }
 
+duk_int_t dukpp03::AbstractContext::callableMagic(dukpp03::AbstractCallable* callable)
+{
+    std::unordered_map<dukpp03::AbstractCallable*, duk_int_t>::const_iterator it = m_callable_magics.find(callable);
+    if (it != m_callable_magics.end())
+    {
+        return it->second;
+    }
+    if (m_callables.size() >= dukpp03::AbstractContext::MaximalCallableTableSize)
+    {
+        return 0;
+    }
+    m_callables.push_back(callable);
+    const duk_int_t magic = static_cast<duk_int_t>(m_callables.size());
+    m_callable_magics.insert(std::make_pair(callable, magic));
+    return magic;
+}
+
+void dukpp03::AbstractContext::internKeyInHeap(dukpp03::AbstractContext::PropertyKey key)
+{
+    duk_push_heap_stash(m_context);
+    if (!duk_get_prop_string(m_context, -1, DUKPP03_INTERNED_KEYS_PROPERTY))
+    {
+        duk_pop(m_context);
+        duk_push_array(m_context);
+        duk_dup_top(m_context);
+        duk_put_prop_string(m_context, -3, DUKPP03_INTERNED_KEYS_PROPERTY);
+    }
+    const std::string& name = m_key_names[key];
+    duk_push_lstring(m_context, name.c_str(), name.size());
+    assert( key == m_keys.size() );
+    m_keys.push_back(duk_get_heapptr(m_context, -1));
+    duk_put_prop_index(m_context, -2, static_cast<duk_uarridx_t>(key));
+    duk_pop_2(m_context);
+}
+
 // ===================== dukpp03::____check_timeout ===========================
 
 int dukpp03::____check_timeout(void* ptr)
@@ -324,3 +1106,4 @@ int dukpp03::____check_timeout(void* ptr)
         return 1;
     return 0;
 }
+
@@ -0,0 +1,415 @@
+#include "../include/allocator.h"
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+/*! A size of header of each block, containing index of size class
+ */
+#define DUKPP03_POOL_HEADER_SIZE 8
+/*! A size of additional header of blocks, allocated via malloc, containing size of block
+ */
+#define DUKPP03_POOL_LARGE_HEADER_SIZE 8
+
+/*! Sizes of classes of pool allocator
+ */
+static const size_t dukpp03_pool_class_sizes[dukpp03::PoolAllocator::ClassCount] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024
+};
+
+/*! An index of size class for each size, rounded up to multiple of 16
+ */
+static const unsigned char dukpp03_pool_class_lookup[dukpp03::PoolAllocator::MaximalClassSize / 16 + 1] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 
+    7, 8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 
+    9, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 
+    10, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 
+    11
+};
+
+dukpp03::Allocator::~Allocator()
+{
+
+}
+
+dukpp03::PoolAllocator::PoolAllocator(size_t slab_size) : m_slab_size(slab_size)
+{
+    for(size_t i = 0; i < dukpp03::PoolAllocator::ClassCount; i++)
+    {
+        m_free[i] = nullptr;
+    }
+}
+
+dukpp03::PoolAllocator::~PoolAllocator()
+{
+    for(size_t i = 0; i < m_slabs.size(); i++)
+    {
+        ::free(m_slabs[i]);
+    }
+}
+
+void* dukpp03::PoolAllocator::allocate(size_t size)
+{
+    if (size == 0)
+    {
+        return nullptr;
+    }
+    const size_t index = dukpp03::PoolAllocator::sizeClass(size);
+    if (index == dukpp03::PoolAllocator::ClassCount)
+    {
+        char* block = static_cast<char*>(::malloc(size + DUKPP03_POOL_HEADER_SIZE + DUKPP03_POOL_LARGE_HEADER_SIZE));
+        if (!block)
+        {
+            return nullptr;
+        }
+        *reinterpret_cast<std::uint64_t*>(block) = size;
+        *reinterpret_cast<std::uint64_t*>(block + DUKPP03_POOL_LARGE_HEADER_SIZE) = index;
+        return block + DUKPP03_POOL_HEADER_SIZE + DUKPP03_POOL_LARGE_HEADER_SIZE;
+    }
+    if (!m_free[index] && !this->grow(index))
+    {
+        return nullptr;
+    }
+    char* result = static_cast<char*>(m_free[index]);
+    m_free[index] = *reinterpret_cast<void**>(result);
+    return result;
+}
+
+void* dukpp03::PoolAllocator::reallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+    {
+        return this->allocate(size);
+    }
+    if (size == 0)
+    {
+        this->free(ptr);
+        return nullptr;
+    }
+    char* p = static_cast<char*>(ptr);
+    const size_t index = static_cast<size_t>(*reinterpret_cast<std::uint64_t*>(p - DUKPP03_POOL_HEADER_SIZE));
+    const size_t new_index = dukpp03::PoolAllocator::sizeClass(size);
+    if (index == new_index)
+    {
+        if (index != dukpp03::PoolAllocator::ClassCount)
+        {
+            return ptr;
+        }
+        char* block = p - DUKPP03_POOL_HEADER_SIZE - DUKPP03_POOL_LARGE_HEADER_SIZE;
+        block = static_cast<char*>(::realloc(block, size + DUKPP03_POOL_HEADER_SIZE + DUKPP03_POOL_LARGE_HEADER_SIZE));
+        if (!block)
+        {
+            return nullptr;
+        }
+        *reinterpret_cast<std::uint64_t*>(block) = size;
+        return block + DUKPP03_POOL_HEADER_SIZE + DUKPP03_POOL_LARGE_HEADER_SIZE;
+    }
+    void* result = this->allocate(size);
+    if (!result)
+    {
+        return nullptr;
+    }
+    const size_t old_size = dukpp03::PoolAllocator::usableSize(ptr);
+    memcpy(result, ptr, (old_size < size) ? old_size : size);
+    this->free(ptr);
+    return result;
+}
+
+void dukpp03::PoolAllocator::free(void* ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+    char* p = static_cast<char*>(ptr);
+    const size_t index = static_cast<size_t>(*reinterpret_cast<std::uint64_t*>(p - DUKPP03_POOL_HEADER_SIZE));
+    if (index == dukpp03::PoolAllocator::ClassCount)
+    {
+        ::free(p - DUKPP03_POOL_HEADER_SIZE - DUKPP03_POOL_LARGE_HEADER_SIZE);
+        return;
+    }
+    *reinterpret_cast<void**>(p) = m_free[index];
+    m_free[index] = p;
+}
+
+size_t dukpp03::PoolAllocator::slabCount() const
+{
+    return m_slabs.size();
+}
+
+size_t dukpp03::PoolAllocator::slabSize() const
+{
+    return m_slab_size;
+}
+
+// ================================= PRIVATE METHODS =================================
+
+dukpp03::PoolAllocator::PoolAllocator(const dukpp03::PoolAllocator& o)
+{
+    throw std::logic_error("dukpp03::PoolAllocator is non-copyable!");
+}
+
+dukpp03::PoolAllocator& dukpp03::PoolAllocator::operator=(const dukpp03::PoolAllocator& o)
+{
+    throw std::logic_error("dukpp03::PoolAllocator is non-copyable!");
+    return *this;
+}
+
+size_t dukpp03::PoolAllocator::sizeClass(size_t size)
+{
+    if (size > dukpp03::PoolAllocator::MaximalClassSize)
+    {
+        return dukpp03::PoolAllocator::ClassCount;
+    }
+    return dukpp03_pool_class_lookup[(size + 15) / 16];
+}
+
+size_t dukpp03::PoolAllocator::usableSize(void* ptr)
+{
+    char* p = static_cast<char*>(ptr);
+    const size_t index = static_cast<size_t>(*reinterpret_cast<std::uint64_t*>(p - DUKPP03_POOL_HEADER_SIZE));
+    if (index == dukpp03::PoolAllocator::ClassCount)
+    {
+        return static_cast<size_t>(*reinterpret_cast<std::uint64_t*>(p - DUKPP03_POOL_HEADER_SIZE - DUKPP03_POOL_LARGE_HEADER_SIZE));
+    }
+    return dukpp03_pool_class_sizes[index];
+}
+
+bool dukpp03::PoolAllocator::grow(size_t index)
+{
+    const size_t stride = dukpp03_pool_class_sizes[index] + DUKPP03_POOL_HEADER_SIZE;
+    size_t count = m_slab_size / stride;
+    if (count == 0)
+    {
+        count = 1;
+    }
+    char* slab = static_cast<char*>(::malloc(count * stride));
+    if (!slab)
+    {
+        return false;
+    }
+    m_slabs.push_back(slab);
+    // Blocks are linked in order of addresses, so consequent allocations are close in memory
+    for(size_t i = count; i > 0; i--)
+    {
+        char* block = slab + (i - 1) * stride;
+        *reinterpret_cast<std::uint64_t*>(block) = index;
+        *reinterpret_cast<void**>(block + DUKPP03_POOL_HEADER_SIZE) = m_free[index];
+        m_free[index] = block + DUKPP03_POOL_HEADER_SIZE;
+    }
+    return true;
+}
+
+dukpp03::AccountingAllocator::AccountingAllocator(dukpp03::Allocator* allocator)
+: m_allocator(allocator),
+m_hard_limit(0),
+m_soft_limit(0),
+m_soft_armed(true),
+m_live_bytes(0),
+m_peak_bytes(0),
+m_allocated_bytes(0),
+m_live_blocks(0),
+m_allocations(0),
+m_failures(0),
+m_soft_collections(0)
+{
+
+}
+
+dukpp03::AccountingAllocator::~AccountingAllocator()
+{
+
+}
+
+void* dukpp03::AccountingAllocator::allocate(size_t size)
+{
+    if (size == 0)
+    {
+        return nullptr;
+    }
+    if (!this->admit(size))
+    {
+        return nullptr;
+    }
+    const size_t full_size = size + dukpp03::AccountingAllocator::HeaderSize;
+    char* block = static_cast<char*>((m_allocator) ? m_allocator->allocate(full_size) : ::malloc(full_size));
+    if (!block)
+    {
+        m_failures.store(m_failures.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    *reinterpret_cast<std::uint64_t*>(block) = size;
+    this->setLive(m_live_bytes.load(std::memory_order_relaxed) + size);
+    m_allocated_bytes.store(m_allocated_bytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    m_live_blocks.store(m_live_blocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_allocations.store(m_allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return block + dukpp03::AccountingAllocator::HeaderSize;
+}
+
+void* dukpp03::AccountingAllocator::reallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+    {
+        return this->allocate(size);
+    }
+    if (size == 0)
+    {
+        this->free(ptr);
+        return nullptr;
+    }
+    char* block = static_cast<char*>(ptr) - dukpp03::AccountingAllocator::HeaderSize;
+    const size_t old_size = static_cast<size_t>(*reinterpret_cast<std::uint64_t*>(block));
+    if (size > old_size && !this->admit(size - old_size))
+    {
+        return nullptr;
+    }
+    const size_t full_size = size + dukpp03::AccountingAllocator::HeaderSize;
+    block = static_cast<char*>((m_allocator) ? m_allocator->reallocate(block, full_size) : ::realloc(block, full_size));
+    if (!block)
+    {
+        m_failures.store(m_failures.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    *reinterpret_cast<std::uint64_t*>(block) = size;
+    this->setLive(m_live_bytes.load(std::memory_order_relaxed) - old_size + size);
+    if (size > old_size)
+    {
+        m_allocated_bytes.store(m_allocated_bytes.load(std::memory_order_relaxed) + (size - old_size), std::memory_order_relaxed);
+    }
+    m_allocations.store(m_allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return block + dukpp03::AccountingAllocator::HeaderSize;
+}
+
+void dukpp03::AccountingAllocator::free(void* ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+    char* block = static_cast<char*>(ptr) - dukpp03::AccountingAllocator::HeaderSize;
+    const size_t size = static_cast<size_t>(*reinterpret_cast<std::uint64_t*>(block));
+    m_live_bytes.store(m_live_bytes.load(std::memory_order_relaxed) - size, std::memory_order_relaxed);
+    m_live_blocks.store(m_live_blocks.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    if (m_allocator)
+    {
+        m_allocator->free(block);
+    }
+    else
+    {
+        ::free(block);
+    }
+}
+
+void dukpp03::AccountingAllocator::setHardLimit(size_t limit)
+{
+    m_hard_limit.store(limit);
+}
+
+size_t dukpp03::AccountingAllocator::hardLimit() const
+{
+    return m_hard_limit.load();
+}
+
+void dukpp03::AccountingAllocator::setSoftLimit(size_t limit)
+{
+    m_soft_limit.store(limit);
+}
+
+size_t dukpp03::AccountingAllocator::softLimit() const
+{
+    return m_soft_limit.load();
+}
+
+size_t dukpp03::AccountingAllocator::liveBytes() const
+{
+    return m_live_bytes.load(std::memory_order_relaxed);
+}
+
+size_t dukpp03::AccountingAllocator::peakBytes() const
+{
+    return m_peak_bytes.load(std::memory_order_relaxed);
+}
+
+void dukpp03::AccountingAllocator::resetPeak()
+{
+    m_peak_bytes.store(m_live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+unsigned long long dukpp03::AccountingAllocator::allocatedBytes() const
+{
+    return m_allocated_bytes.load(std::memory_order_relaxed);
+}
+
+size_t dukpp03::AccountingAllocator::liveBlocks() const
+{
+    return m_live_blocks.load(std::memory_order_relaxed);
+}
+
+unsigned long long dukpp03::AccountingAllocator::allocations() const
+{
+    return m_allocations.load(std::memory_order_relaxed);
+}
+
+unsigned long long dukpp03::AccountingAllocator::failures() const
+{
+    return m_failures.load(std::memory_order_relaxed);
+}
+
+unsigned long long dukpp03::AccountingAllocator::softCollections() const
+{
+    return m_soft_collections.load(std::memory_order_relaxed);
+}
+
+// ================================= PRIVATE METHODS =================================
+
+dukpp03::AccountingAllocator::AccountingAllocator(const dukpp03::AccountingAllocator& o)
+{
+    throw std::logic_error("dukpp03::AccountingAllocator is non-copyable!");
+}
+
+dukpp03::AccountingAllocator& dukpp03::AccountingAllocator::operator=(const dukpp03::AccountingAllocator& o)
+{
+    throw std::logic_error("dukpp03::AccountingAllocator is non-copyable!");
+    return *this;
+}
+
+bool dukpp03::AccountingAllocator::admit(size_t growth)
+{
+    const size_t live = m_live_bytes.load(std::memory_order_relaxed);
+    const size_t hard_limit = m_hard_limit.load(std::memory_order_relaxed);
+    if (hard_limit != 0 && live + growth > hard_limit)
+    {
+        m_failures.store(m_failures.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+    const size_t soft_limit = m_soft_limit.load(std::memory_order_relaxed);
+    if (soft_limit != 0)
+    {
+        if (live + growth <= soft_limit)
+        {
+            m_soft_armed = true;
+        }
+        else
+        {
+            // Failed allocation makes Duktape run mark-and-sweep and retry, which is the only
+            // way to collect garbage here, since duk_gc could not be called from allocator.
+            // First allocation is heap itself, which is not retried, so it's never failed
+            if (m_soft_armed && live != 0)
+            {
+                m_soft_armed = false;
+                m_soft_collections.store(m_soft_collections.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void dukpp03::AccountingAllocator::setLive(size_t live)
+{
+    m_live_bytes.store(live, std::memory_order_relaxed);
+    if (live > m_peak_bytes.load(std::memory_order_relaxed))
+    {
+        m_peak_bytes.store(live, std::memory_order_relaxed);
+    }
+}
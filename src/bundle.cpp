@@ -0,0 +1,378 @@
+#include "../include/bundle.h"
+#include <fstream>
+#include <cstring>
+
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+/*! A magic, which is placed at beginning of bundle
+ */
+#define DUKPP03_BUNDLE_MAGIC "DKPPBNDL"
+/*! A length of magic
+ */
+#define DUKPP03_BUNDLE_MAGIC_LENGTH 8
+
+namespace 
+{
+
+/*! Writes 32-bit unsigned integer as little-endian
+    \param[out] out a buffer
+    \param[in] v value
+ */
+void writeUInt32(std::vector<unsigned char>& out, unsigned int v)
+{
+    for(int i = 0; i < 4; i++)
+    {
+        out.push_back(static_cast<unsigned char>((v >> (8 * i)) & 0xFF));
+    }
+}
+
+/*! Writes 64-bit unsigned integer as little-endian
+    \param[out] out a buffer
+    \param[in] v value
+ */
+void writeUInt64(std::vector<unsigned char>& out, unsigned long long v)
+{
+    for(int i = 0; i < 8; i++)
+    {
+        out.push_back(static_cast<unsigned char>((v >> (8 * i)) & 0xFF));
+    }
+}
+
+/*! Reads 32-bit unsigned integer as little-endian
+    \param[in] data a data
+    \return value
+ */
+unsigned int readUInt32(const unsigned char* data)
+{
+    unsigned int result = 0;
+    for(int i = 0; i < 4; i++)
+    {
+        result |= static_cast<unsigned int>(data[i]) << (8 * i);
+    }
+    return result;
+}
+
+/*! Reads 64-bit unsigned integer as little-endian
+    \param[in] data a data
+    \return value
+ */
+unsigned long long readUInt64(const unsigned char* data)
+{
+    unsigned long long result = 0;
+    for(int i = 0; i < 8; i++)
+    {
+        result |= static_cast<unsigned long long>(data[i]) << (8 * i);
+    }
+    return result;
+}
+
+/*! Fetches error from top of stack
+    \param[in] ctx context
+    \param[out] error an error
+ */
+void fetchError(duk_context* ctx, std::string* error)
+{
+    if (error)
+    {
+        if (duk_is_object(ctx, -1) && duk_has_prop_string(ctx, -1, "stack"))
+        {
+            duk_get_prop_string(ctx, -1, "stack");
+            *error = duk_safe_to_string(ctx, -1);
+            duk_pop(ctx);
+        }
+        else
+        {
+            *error = duk_safe_to_string(ctx, -1);
+        }
+    }
+}
+
+/*! Sets error, if needed
+    \param[out] error an error
+    \param[in] message a message
+    \return false
+ */
+bool setError(std::string* error, const std::string& message)
+{
+    if (error)
+    {
+        *error = message;
+    }
+    return false;
+}
+
+/*! Loads function from buffer on top of stack in protected mode
+    \param[in] ctx context
+    \param[in] udata unused
+    \return 1
+ */
+duk_ret_t loadFunction(duk_context* ctx, void* udata)
+{
+    duk_load_function(ctx);
+    return 1;
+}
+
+/*! Dumps compiled function from top of stack in protected mode
+    \param[in] ctx context
+    \param[in] udata unused
+    \return 1
+ */
+duk_ret_t dumpFunction(duk_context* ctx, void* udata)
+{
+    duk_dump_function(ctx);
+    return 1;
+}
+
+/*! Checks bundle and runs scripts from it
+    \param[in] ctx context
+    \param[in] data a data of bundle
+    \param[in] size a size of data
+    \param[out] error an error
+    \return true on success
+ */
+bool loadFromMemory(duk_context* ctx, const unsigned char* data, size_t size, std::string* error)
+{
+    if (size < dukpp03::Bundle::HeaderSize || memcmp(data, DUKPP03_BUNDLE_MAGIC, DUKPP03_BUNDLE_MAGIC_LENGTH) != 0)
+    {
+        return setError(error, "File is not a bundle");
+    }
+    if (readUInt32(data + 8) != dukpp03::Bundle::FormatVersion)
+    {
+        return setError(error, "Unsupported version of bundle format");
+    }
+    if (readUInt32(data + 12) != static_cast<unsigned int>(DUK_VERSION))
+    {
+        return setError(error, "Bundle was compiled for other version of Duktape");
+    }
+    if (readUInt32(data + 16) != dukpp03::Bundle::configFlags())
+    {
+        return setError(error, "Bundle was compiled for other configuration of Duktape");
+    }
+    const unsigned int count = readUInt32(data + 20);
+    const unsigned long long payload_size = readUInt64(data + 24);
+    if (payload_size != size - dukpp03::Bundle::HeaderSize)
+    {
+        return setError(error, "Bundle is truncated");
+    }
+    const unsigned char* payload = data + dukpp03::Bundle::HeaderSize;
+    if (readUInt64(data + 32) != dukpp03::Bundle::checksum(payload, static_cast<size_t>(payload_size)))
+    {
+        return setError(error, "Checksum of bundle does not match");
+    }
+
+    size_t offset = 0;
+    for(unsigned int i = 0; i < count; i++)
+    {
+        if (payload_size - offset < 4)
+        {
+            return setError(error, "Bundle is truncated");
+        }
+        const size_t name_length = readUInt32(payload + offset);
+        offset += 4;
+        if (payload_size - offset < name_length + 4)
+        {
+            return setError(error, "Bundle is truncated");
+        }
+        const std::string name(reinterpret_cast<const char*>(payload + offset), name_length);
+        offset += name_length;
+        const size_t bytecode_length = readUInt32(payload + offset);
+        offset += 4;
+        if (payload_size - offset < bytecode_length)
+        {
+            return setError(error, "Bundle is truncated");
+        }
+        if (!dukpp03::Bundle::run(ctx, payload + offset, bytecode_length, name, error))
+        {
+            return false;
+        }
+        offset += bytecode_length;
+    }
+    if (error)
+    {
+        *error = "";
+    }
+    return true;
+}
+
+}
+
+bool dukpp03::Bundle::write(const std::string& path, const std::vector<dukpp03::Bundle::Source>& sources, std::string* error)
+{
+    std::vector<unsigned char> payload;
+    std::vector<unsigned char> bytecode;
+    for(size_t i = 0; i < sources.size(); i++)
+    {
+        if (!dukpp03::Bundle::compile(sources[i], bytecode, error))
+        {
+            return false;
+        }
+        writeUInt32(payload, static_cast<unsigned int>(sources[i].first.size()));
+        payload.insert(payload.end(), sources[i].first.begin(), sources[i].first.end());
+        writeUInt32(payload, static_cast<unsigned int>(bytecode.size()));
+        payload.insert(payload.end(), bytecode.begin(), bytecode.end());
+    }
+
+    std::vector<unsigned char> header;
+    header.insert(header.end(), DUKPP03_BUNDLE_MAGIC, DUKPP03_BUNDLE_MAGIC + DUKPP03_BUNDLE_MAGIC_LENGTH);
+    writeUInt32(header, dukpp03::Bundle::FormatVersion);
+    writeUInt32(header, static_cast<unsigned int>(DUK_VERSION));
+    writeUInt32(header, dukpp03::Bundle::configFlags());
+    writeUInt32(header, static_cast<unsigned int>(sources.size()));
+    writeUInt64(header, payload.size());
+    writeUInt64(header, dukpp03::Bundle::checksum(payload.empty() ? nullptr : &(payload[0]), payload.size()));
+
+    std::ofstream out(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.good())
+    {
+        return setError(error, "Cannot open file " + path + " for writing");
+    }
+    out.write(reinterpret_cast<const char*>(&(header[0])), header.size());
+    if (!payload.empty())
+    {
+        out.write(reinterpret_cast<const char*>(&(payload[0])), payload.size());
+    }
+    if (!out.good())
+    {
+        return setError(error, "Cannot write bundle into file " + path);
+    }
+    if (error)
+    {
+        *error = "";
+    }
+    return true;
+}
+
+bool dukpp03::Bundle::compile(const dukpp03::Bundle::Source& source, std::vector<unsigned char>& bytecode, std::string* error)
+{
+    duk_context* ctx = duk_create_heap(nullptr, nullptr, nullptr, nullptr, nullptr);
+    bool result = false;
+    duk_push_lstring(ctx, source.second.c_str(), source.second.size());
+    duk_push_lstring(ctx, source.first.c_str(), source.first.size());
+    if (duk_pcompile(ctx, 0) != 0 || duk_safe_call(ctx, dumpFunction, nullptr, 1, 1) != DUK_EXEC_SUCCESS)
+    {
+        fetchError(ctx, error);
+    }
+    else
+    {
+        duk_size_t size = 0;
+        const unsigned char* data = static_cast<const unsigned char*>(duk_get_buffer(ctx, -1, &size));
+        bytecode.assign(data, data + size);
+        result = true;
+    }
+    duk_destroy_heap(ctx);
+    return result;
+}
+
+bool dukpp03::Bundle::run(duk_context* ctx, const unsigned char* bytecode, size_t size, const std::string& name, std::string* error)
+{
+    // Bytecode is read directly from passed memory without copying
+    duk_push_external_buffer(ctx);
+    duk_config_buffer(ctx, -1, const_cast<unsigned char*>(bytecode), size);
+    if (duk_safe_call(ctx, loadFunction, nullptr, 1, 1) != DUK_EXEC_SUCCESS)
+    {
+        fetchError(ctx, error);
+        duk_pop(ctx);
+        return false;
+    }
+    duk_push_global_object(ctx);
+    if (duk_pcall_method(ctx, 0) != DUK_EXEC_SUCCESS)
+    {
+        fetchError(ctx, error);
+        if (error)
+        {
+            *error = name + ": " + *error;
+        }
+        duk_pop(ctx);
+        return false;
+    }
+    duk_pop(ctx);
+    if (error)
+    {
+        *error = "";
+    }
+    return true;
+}
+
+bool dukpp03::Bundle::load(duk_context* ctx, const std::string& path, std::string* error)
+{
+#ifndef _WIN32
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return setError(error, "Cannot open file " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return setError(error, "File is not a bundle");
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return setError(error, "Cannot map file " + path);
+    }
+    const bool result = loadFromMemory(ctx, static_cast<const unsigned char*>(data), size, error);
+    munmap(data, size);
+    return result;
+#else
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+    if (!in.good())
+    {
+        return setError(error, "Cannot open file " + path);
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.empty())
+    {
+        return setError(error, "File is not a bundle");
+    }
+    return loadFromMemory(ctx, reinterpret_cast<const unsigned char*>(&(data[0])), data.size(), error);
+#endif
+}
+
+unsigned int dukpp03::Bundle::configFlags()
+{
+    unsigned int result = 0;
+#ifdef DUK_USE_FASTINT
+    result |= 1 << 0;
+#endif
+#ifdef DUK_USE_PACKED_TVAL
+    result |= 1 << 1;
+#endif
+#ifdef DUK_USE_DOUBLE_LE
+    result |= 1 << 2;
+#endif
+#ifdef DUK_USE_DOUBLE_BE
+    result |= 1 << 3;
+#endif
+#ifdef DUK_USE_DOUBLE_ME
+    result |= 1 << 4;
+#endif
+#ifdef DUK_USE_BYTECODE_DUMP_SUPPORT
+    result |= 1 << 5;
+#endif
+    if (sizeof(void*) == 8)
+    {
+        result |= 1 << 6;
+    }
+    return result;
+}
+
+unsigned long long dukpp03::Bundle::checksum(const unsigned char* data, size_t size)
+{
+    // FNV-1a
+    unsigned long long result = 14695981039346656037ULL;
+    for(size_t i = 0; i < size; i++)
+    {
+        result ^= data[i];
+        result *= 1099511628211ULL;
+    }
+    return result;
+}
@@ -0,0 +1,35 @@
+#include "../include/cancellationtoken.h"
+#include <stdexcept>
+
+dukpp03::CancellationToken::CancellationToken() : m_cancelled(false)
+{
+
+}
+
+void dukpp03::CancellationToken::cancel()
+{
+    m_cancelled.store(true, std::memory_order_relaxed);
+}
+
+void dukpp03::CancellationToken::reset()
+{
+    m_cancelled.store(false, std::memory_order_relaxed);
+}
+
+bool dukpp03::CancellationToken::cancelled() const
+{
+    return m_cancelled.load(std::memory_order_relaxed);
+}
+
+// ================================= PRIVATE METHODS =================================
+
+dukpp03::CancellationToken::CancellationToken(const dukpp03::CancellationToken& o)
+{
+    throw std::logic_error("dukpp03::CancellationToken is non-copyable!");
+}
+
+dukpp03::CancellationToken& dukpp03::CancellationToken::operator=(const dukpp03::CancellationToken& o)
+{
+    throw std::logic_error("dukpp03::CancellationToken is non-copyable!");
+    return *this;
+}
@@ -0,0 +1,53 @@
+#include "../include/containers.h"
+
+bool dukpp03::internal::typedArrayData(duk_context* ctx, duk_idx_t pos, duk_uint_t type, void** data, duk_size_t* size)
+{
+    if (!duk_is_buffer_data(ctx, pos))
+    {
+        return false;
+    }
+    pos = duk_normalize_index(ctx, pos);
+    if (duk_is_buffer(ctx, pos))
+    {
+        if (type != DUK_BUFOBJ_UINT8ARRAY)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // There is no way to get type of elements of buffer object, so prototype of value is compared with
+        // built-in prototype of array of requested type. Even if script replaces prototype of value,
+        // data is never read outside of it
+        duk_require_stack(ctx, 4);
+        duk_get_prototype(ctx, pos);
+        duk_push_fixed_buffer(ctx, 0);
+        duk_push_buffer_object(ctx, -1, 0, 0, type);
+        duk_get_prototype(ctx, -1);
+        const bool same = duk_get_heapptr(ctx, -1) == duk_get_heapptr(ctx, -4);
+        duk_pop_n(ctx, 4);
+        if (!same)
+        {
+            return false;
+        }
+    }
+    *data = duk_get_buffer_data(ctx, pos, size);
+    return true;
+}
+
+bool dukpp03::internal::isArrayLike(duk_context* ctx, duk_idx_t pos)
+{
+    if (duk_is_array(ctx, pos))
+    {
+        return true;
+    }
+    if (!duk_is_buffer_data(ctx, pos))
+    {
+        return false;
+    }
+    // Only typed arrays have size of element, unlike ArrayBuffer and DataView
+    duk_get_prop_string(ctx, pos, "BYTES_PER_ELEMENT");
+    const bool result = duk_is_number(ctx, -1) != 0;
+    duk_pop(ctx);
+    return result;
+}
@@ -0,0 +1,52 @@
+#include "../include/exactinteger.h"
+
+bool dukpp03::internal::parseInteger(const char* s, size_t length, long long& result)
+{
+    if (length != 0 && s[0] == '-')
+    {
+        unsigned long long magnitude = 0;
+        if (!dukpp03::internal::parseInteger(s + 1, length - 1, magnitude))
+        {
+            return false;
+        }
+        const unsigned long long limit = static_cast<unsigned long long>(std::numeric_limits<long long>::max()) + 1;
+        if (magnitude > limit)
+        {
+            return false;
+        }
+        result = (magnitude == limit) ? std::numeric_limits<long long>::min() : -static_cast<long long>(magnitude);
+        return true;
+    }
+    unsigned long long v = 0;
+    if (!dukpp03::internal::parseInteger(s, length, v) || v > static_cast<unsigned long long>(std::numeric_limits<long long>::max()))
+    {
+        return false;
+    }
+    result = static_cast<long long>(v);
+    return true;
+}
+
+bool dukpp03::internal::parseInteger(const char* s, size_t length, unsigned long long& result)
+{
+    if (length == 0)
+    {
+        return false;
+    }
+    const unsigned long long max = std::numeric_limits<unsigned long long>::max();
+    unsigned long long v = 0;
+    for(size_t i = 0; i < length; i++)
+    {
+        if (s[i] < '0' || s[i] > '9')
+        {
+            return false;
+        }
+        const unsigned long long digit = static_cast<unsigned long long>(s[i] - '0');
+        if (v > (max - digit) / 10)
+        {
+            return false;
+        }
+        v = v * 10 + digit;
+    }
+    result = v;
+    return true;
+}
@@ -0,0 +1,49 @@
+#include "../include/externalbuffer.h"
+#include "../include/abstractcontext.h"
+#include <stdexcept>
+
+dukpp03::ExternalBuffer::ExternalBuffer()
+{
+
+}
+
+dukpp03::ExternalBuffer::~ExternalBuffer()
+{
+
+}
+
+duk_ret_t dukpp03::ExternalBuffer::finalize(duk_context* ctx)
+{
+    dukpp03::AbstractContext* parent = dukpp03::AbstractContext::getContext(ctx);
+    parent->getProperty(ctx, 0, dukpp03::AbstractContext::ExternalBufferKey);
+    if (!duk_is_array(ctx, -1))
+    {
+        duk_pop(ctx);
+        return 0;
+    }
+    duk_get_prop_index(ctx, -1, 0);
+    dukpp03::ExternalBuffer* buffer = static_cast<dukpp03::ExternalBuffer*>(duk_get_pointer(ctx, -1));
+    duk_pop(ctx);
+    // Scripts could call finalizer directly via Duktape.fin, while buffer is still referenced, so it's
+    // detached from memory block, making views of it empty, before block is deleted
+    duk_get_prop_index(ctx, -1, 1);
+    duk_config_buffer(ctx, -1, nullptr, 0);
+    duk_pop_2(ctx);
+    duk_push_undefined(ctx);
+    parent->putProperty(ctx, 0, dukpp03::AbstractContext::ExternalBufferKey);
+    delete buffer;
+    return 0;
+}
+
+// ================================= PRIVATE METHODS =================================
+
+dukpp03::ExternalBuffer::ExternalBuffer(const dukpp03::ExternalBuffer& o)
+{
+    throw std::logic_error("dukpp03::ExternalBuffer is non-copyable!");
+}
+
+dukpp03::ExternalBuffer& dukpp03::ExternalBuffer::operator=(const dukpp03::ExternalBuffer& o)
+{
+    throw std::logic_error("dukpp03::ExternalBuffer is non-copyable!");
+    return *this;
+}
@@ -0,0 +1,156 @@
+#include "../include/gcscheduler.h"
+
+dukpp03::PauseHistogram::PauseHistogram()
+{
+    this->clear();
+}
+
+void dukpp03::PauseHistogram::add(double seconds)
+{
+    size_t i = 0;
+    while(i < dukpp03::PauseHistogram::BucketCount - 1 && seconds >= dukpp03::PauseHistogram::bucketBound(i))
+    {
+        ++i;
+    }
+    ++(m_buckets[i]);
+    ++m_count;
+    m_total += seconds;
+    if (seconds > m_maximum)
+    {
+        m_maximum = seconds;
+    }
+}
+
+void dukpp03::PauseHistogram::clear()
+{
+    for(size_t i = 0; i < dukpp03::PauseHistogram::BucketCount; i++)
+    {
+        m_buckets[i] = 0;
+    }
+    m_count = 0;
+    m_total = 0;
+    m_maximum = 0;
+}
+
+unsigned long long dukpp03::PauseHistogram::count() const
+{
+    return m_count;
+}
+
+double dukpp03::PauseHistogram::total() const
+{
+    return m_total;
+}
+
+double dukpp03::PauseHistogram::maximum() const
+{
+    return m_maximum;
+}
+
+unsigned long long dukpp03::PauseHistogram::bucket(size_t i) const
+{
+    if (i >= dukpp03::PauseHistogram::BucketCount)
+    {
+        return 0;
+    }
+    return m_buckets[i];
+}
+
+double dukpp03::PauseHistogram::bucketBound(size_t i)
+{
+    return static_cast<double>(1ULL << i) / 1.0E+6;
+}
+
+double dukpp03::PauseHistogram::percentile(double p) const
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+    const double rank = p * static_cast<double>(m_count);
+    unsigned long long seen = 0;
+    for(size_t i = 0; i < dukpp03::PauseHistogram::BucketCount; i++)
+    {
+        seen += m_buckets[i];
+        if (seen != 0 && static_cast<double>(seen) >= rank)
+        {
+            const double bound = dukpp03::PauseHistogram::bucketBound(i);
+            return (bound < m_maximum) ? bound : m_maximum;
+        }
+    }
+    return m_maximum;
+}
+
+dukpp03::GCScheduler::GCScheduler(
+    dukpp03::AbstractContext* ctx, 
+    dukpp03::AccountingAllocator* allocator, 
+    unsigned long long threshold
+) : m_context(ctx), m_allocator(allocator), m_threshold(threshold), m_allocated_at_collection(0)
+{
+    if (m_allocator)
+    {
+        m_allocated_at_collection = m_allocator->allocatedBytes();
+    }
+}
+
+void dukpp03::GCScheduler::setThreshold(unsigned long long threshold)
+{
+    m_threshold = threshold;
+}
+
+unsigned long long dukpp03::GCScheduler::threshold() const
+{
+    return m_threshold;
+}
+
+unsigned long long dukpp03::GCScheduler::allocatedSinceCollection() const
+{
+    if (!m_allocator)
+    {
+        return 0;
+    }
+    return m_allocator->allocatedBytes() - m_allocated_at_collection;
+}
+
+bool dukpp03::GCScheduler::needed() const
+{
+    if (!m_allocator)
+    {
+        return true;
+    }
+    return this->allocatedSinceCollection() >= m_threshold;
+}
+
+bool dukpp03::GCScheduler::collectIfNeeded(bool compact)
+{
+    if (!this->needed())
+    {
+        return false;
+    }
+    this->collect(compact);
+    return true;
+}
+
+void dukpp03::GCScheduler::collect(bool compact)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    duk_context* ctx = m_context->context();
+    const duk_uint_t flags = (compact) ? DUK_GC_COMPACT : 0;
+    duk_gc(ctx, flags);
+    duk_gc(ctx, flags);
+    m_pauses.add(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    if (m_allocator)
+    {
+        m_allocated_at_collection = m_allocator->allocatedBytes();
+    }
+}
+
+const dukpp03::PauseHistogram& dukpp03::GCScheduler::pauses() const
+{
+    return m_pauses;
+}
+
+void dukpp03::GCScheduler::clearPauses()
+{
+    m_pauses.clear();
+}
@@ -0,0 +1,58 @@
+#include "../include/overloadcache.h"
+
+bool dukpp03::MultiMethodDispatchKey::operator==(const dukpp03::MultiMethodDispatchKey& o) const
+{
+    if (Types != o.Types
+        || ArgumentCount != o.ArgumentCount
+        || ThisType != o.ThisType
+        || ConstructorCall != o.ConstructorCall
+        || ThisVariantType != o.ThisVariantType
+        || ObjectCount != o.ObjectCount)
+    {
+        return false;
+    }
+    for(int i = 0; i < ObjectCount; i++)
+    {
+        if (VariantTypes[i] != o.VariantTypes[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+dukpp03::OverloadCache::OverloadCache() : m_position(0)
+{
+
+}
+
+bool dukpp03::OverloadCache::find(const dukpp03::MultiMethodDispatchKey& key, dukpp03::AbstractCallable** overload, std::pair<int, bool>& result) const
+{
+    for(size_t i = 0; i < m_entries.size(); i++)
+    {
+        if (m_entries[i].Key == key)
+        {
+            *overload = m_entries[i].Overload;
+            result = m_entries[i].Result;
+            return true;
+        }
+    }
+    return false;
+}
+
+void dukpp03::OverloadCache::insert(const dukpp03::MultiMethodDispatchKey& key, dukpp03::AbstractCallable* overload, const std::pair<int, bool>& result)
+{
+    dukpp03::OverloadCache::Entry entry;
+    entry.Key = key;
+    entry.Overload = overload;
+    entry.Result = result;
+    if (m_entries.size() < DUKPP03_MULTIMETHOD_CACHE_SIZE)
+    {
+        m_entries.push_back(entry);
+    }
+    else
+    {
+        m_entries[m_position] = entry;
+        m_position = (m_position + 1) % DUKPP03_MULTIMETHOD_CACHE_SIZE;
+    }
+}
@@ -0,0 +1,97 @@
+#include "../include/pinnedvalue.h"
+#include "../include/abstractcontext.h"
+#include <stdexcept>
+
+dukpp03::PinnedValue::PinnedValue(dukpp03::AbstractContext* ctx, void* heap_pointer, duk_uarridx_t index, size_t slot)
+: m_context(ctx), m_heap_pointer(heap_pointer), m_index(index), m_slot(slot), m_refcount(1)
+{
+
+}
+
+void dukpp03::PinnedValue::addRef()
+{
+    ++m_refcount;
+}
+
+void dukpp03::PinnedValue::delRef()
+{
+    if (m_refcount.fetch_sub(1) > 1)
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(dukpp03::PinnedValue::mutex());
+        dukpp03::AbstractContext* ctx = m_context.load();
+        if (ctx)
+        {
+            ctx->unpin(this);
+        }
+    }
+    delete this;
+}
+
+bool dukpp03::PinnedValue::push() const
+{
+    dukpp03::AbstractContext* ctx = m_context.load();
+    if (!ctx)
+    {
+        return false;
+    }
+    duk_push_heapptr(ctx->context(), m_heap_pointer);
+    return true;
+}
+
+dukpp03::AbstractContext* dukpp03::PinnedValue::context() const
+{
+    return m_context.load();
+}
+
+void* dukpp03::PinnedValue::heapPointer() const
+{
+    return m_heap_pointer;
+}
+
+duk_uarridx_t dukpp03::PinnedValue::index() const
+{
+    return m_index;
+}
+
+size_t dukpp03::PinnedValue::slot() const
+{
+    return m_slot;
+}
+
+void dukpp03::PinnedValue::setSlot(size_t slot)
+{
+    m_slot = slot;
+}
+
+void dukpp03::PinnedValue::detach()
+{
+    m_context = nullptr;
+    m_heap_pointer = nullptr;
+}
+
+std::mutex& dukpp03::PinnedValue::mutex()
+{
+    static std::mutex m;
+    return m;
+}
+
+// ================================= PRIVATE METHODS =================================
+
+dukpp03::PinnedValue::~PinnedValue()
+{
+    
+}
+
+dukpp03::PinnedValue::PinnedValue(const dukpp03::PinnedValue& p)
+{
+    throw std::logic_error("dukpp03::PinnedValue is non-copyable!");
+}
+
+dukpp03::PinnedValue& dukpp03::PinnedValue::operator=(const dukpp03::PinnedValue& p)
+{
+    throw std::logic_error("dukpp03::PinnedValue is non-copyable!");
+    return *this;
+}
@@ -0,0 +1,167 @@
+#include "../include/scriptcache.h"
+#include "../include/abstractcontext.h"
+#include <stdexcept>
+
+dukpp03::ScriptCache::ScriptCache(dukpp03::AbstractContext* ctx)
+: m_context(ctx),
+m_memory_limit(dukpp03::ScriptCache::DefaultMemoryLimit),
+m_memory_usage(0),
+m_hits(0),
+m_misses(0)
+{
+    
+}
+
+dukpp03::ScriptCache::~ScriptCache()
+{
+    this->clear();
+}
+
+bool dukpp03::ScriptCache::push(const std::string& source, const std::string& filename)
+{
+    if (m_memory_limit == 0)
+    {
+        return false;
+    }
+    std::map<unsigned long long, EntryList::iterator>::iterator it = m_index.find(dukpp03::ScriptCache::hash(source, filename));
+    if (it != m_index.end())
+    {
+        EntryList::iterator entry = it->second;
+        if (entry->Source == source && entry->FileName == filename && entry->Function->push())
+        {
+            m_entries.splice(m_entries.begin(), m_entries, entry);
+            ++m_hits;
+            return true;
+        }
+    }
+    ++m_misses;
+    return false;
+}
+
+void dukpp03::ScriptCache::insert(const std::string& source, const std::string& filename)
+{
+    if (m_memory_limit == 0)
+    {
+        return;
+    }
+    const unsigned long long h = dukpp03::ScriptCache::hash(source, filename);
+    std::map<unsigned long long, EntryList::iterator>::iterator it = m_index.find(h);
+    if (it != m_index.end())
+    {
+        this->erase(it->second);
+    }
+
+    // Compiled function is estimated from length of source, since dumping it only to measure it
+    // would cost as much as the cache saves on small scripts
+    const size_t function_size = source.size() * dukpp03::ScriptCache::CompiledSizeFactor;
+    const size_t size = source.size() + filename.size() + function_size + sizeof(Entry);
+    if (size > m_memory_limit)
+    {
+        return;
+    }
+    this->evict(m_memory_limit - size);
+
+    Entry entry;
+    entry.Hash = h;
+    entry.Source = source;
+    entry.FileName = filename;
+    entry.Function = m_context->pin(-1);
+    entry.Size = size;
+    m_entries.push_front(entry);
+    m_index[h] = m_entries.begin();
+    m_memory_usage += size;
+}
+
+void dukpp03::ScriptCache::clear()
+{
+    while(!m_entries.empty())
+    {
+        this->erase(m_entries.begin());
+    }
+}
+
+void dukpp03::ScriptCache::setMemoryLimit(size_t limit)
+{
+    m_memory_limit = limit;
+    this->evict(limit);
+}
+
+size_t dukpp03::ScriptCache::memoryLimit() const
+{
+    return m_memory_limit;
+}
+
+size_t dukpp03::ScriptCache::memoryUsage() const
+{
+    return m_memory_usage;
+}
+
+size_t dukpp03::ScriptCache::size() const
+{
+    return m_entries.size();
+}
+
+unsigned long long dukpp03::ScriptCache::hits() const
+{
+    return m_hits;
+}
+
+unsigned long long dukpp03::ScriptCache::misses() const
+{
+    return m_misses;
+}
+
+void dukpp03::ScriptCache::resetStatistics()
+{
+    m_hits = 0;
+    m_misses = 0;
+}
+
+unsigned long long dukpp03::ScriptCache::hash(const std::string& source, const std::string& filename)
+{
+    // FNV-1a, file name is separated from source by zero byte
+    unsigned long long result = 14695981039346656037ULL;
+    for(size_t i = 0; i < source.size(); i++)
+    {
+        result ^= static_cast<unsigned char>(source[i]);
+        result *= 1099511628211ULL;
+    }
+    result *= 1099511628211ULL;
+    for(size_t i = 0; i < filename.size(); i++)
+    {
+        result ^= static_cast<unsigned char>(filename[i]);
+        result *= 1099511628211ULL;
+    }
+    return result;
+}
+
+// ================================= PRIVATE METHODS =================================
+
+void dukpp03::ScriptCache::evict(size_t limit)
+{
+    while(!m_entries.empty() && m_memory_usage > limit)
+    {
+        EntryList::iterator it = m_entries.end();
+        --it;
+        this->erase(it);
+    }
+}
+
+void dukpp03::ScriptCache::erase(EntryList::iterator it)
+{
+    m_memory_usage -= it->Size;
+    m_index.erase(it->Hash);
+    it->Function->delRef();
+    m_entries.erase(it);
+}
+
+dukpp03::ScriptCache::ScriptCache(const dukpp03::ScriptCache& o)
+{
+    throw std::logic_error("dukpp03::ScriptCache is non-copyable!");
+}
+
+dukpp03::ScriptCache& dukpp03::ScriptCache::operator=(const dukpp03::ScriptCache& o)
+{
+    throw std::logic_error("dukpp03::ScriptCache is non-copyable!");
+    return *this;
+}
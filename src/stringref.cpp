@@ -0,0 +1,42 @@
+#include "../include/stringref.h"
+#include <cstring>
+
+dukpp03::StringRef::StringRef() : m_data(""), m_size(0)
+{
+
+}
+
+dukpp03::StringRef::StringRef(const char* data) : m_data(data), m_size(strlen(data))
+{
+
+}
+
+dukpp03::StringRef::StringRef(const std::string& s) : m_data(s.c_str()), m_size(s.size())
+{
+
+}
+
+bool dukpp03::StringRef::empty() const
+{
+    return m_size == 0;
+}
+
+char dukpp03::StringRef::operator[](size_t i) const
+{
+    return m_data[i];
+}
+
+std::string dukpp03::StringRef::str() const
+{
+    return std::string(m_data, m_size);
+}
+
+bool dukpp03::StringRef::operator==(const dukpp03::StringRef& o) const
+{
+    return m_size == o.m_size && (m_size == 0 || memcmp(m_data, o.m_data, m_size) == 0);
+}
+
+bool dukpp03::StringRef::operator!=(const dukpp03::StringRef& o) const
+{
+    return !(*this == o);
+}
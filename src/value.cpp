@@ -0,0 +1,315 @@
+#include "../include/value.h"
+
+dukpp03::Value::Value() : m_type(dukpp03::Value::Type::Undefined), m_boolean(false), m_number(0)
+{
+
+}
+
+dukpp03::Value::Value(bool v) : m_type(dukpp03::Value::Type::Boolean), m_boolean(v), m_number(0)
+{
+
+}
+
+dukpp03::Value::Value(double v) : m_type(dukpp03::Value::Type::Number), m_boolean(false), m_number(v)
+{
+
+}
+
+dukpp03::Value::Value(int v) : m_type(dukpp03::Value::Type::Number), m_boolean(false), m_number(v)
+{
+
+}
+
+dukpp03::Value::Value(const std::string& v) : m_type(dukpp03::Value::Type::String), m_boolean(false), m_number(0), m_string(v)
+{
+
+}
+
+dukpp03::Value::Value(const char* v) : m_type(dukpp03::Value::Type::String), m_boolean(false), m_number(0), m_string(v)
+{
+
+}
+
+dukpp03::Value dukpp03::Value::null()
+{
+    dukpp03::Value result;
+    result.m_type = dukpp03::Value::Type::Null;
+    return result;
+}
+
+dukpp03::Value dukpp03::Value::array()
+{
+    dukpp03::Value result;
+    result.m_type = dukpp03::Value::Type::Array;
+    return result;
+}
+
+dukpp03::Value dukpp03::Value::object()
+{
+    dukpp03::Value result;
+    result.m_type = dukpp03::Value::Type::Object;
+    return result;
+}
+
+dukpp03::Value::Type dukpp03::Value::type() const
+{
+    return m_type;
+}
+
+bool dukpp03::Value::isUndefined() const
+{
+    return m_type == dukpp03::Value::Type::Undefined;
+}
+
+bool dukpp03::Value::isNull() const
+{
+    return m_type == dukpp03::Value::Type::Null;
+}
+
+bool dukpp03::Value::asBoolean() const
+{
+    return m_boolean;
+}
+
+double dukpp03::Value::asNumber() const
+{
+    return m_number;
+}
+
+const std::string& dukpp03::Value::asString() const
+{
+    return m_string;
+}
+
+const std::vector<dukpp03::Value>& dukpp03::Value::elements() const
+{
+    return m_elements;
+}
+
+const std::vector<dukpp03::Value::Property>& dukpp03::Value::properties() const
+{
+    return m_properties;
+}
+
+void dukpp03::Value::append(const dukpp03::Value& v)
+{
+    if (m_type != dukpp03::Value::Type::Array)
+    {
+        *this = dukpp03::Value::array();
+    }
+    m_elements.push_back(v);
+}
+
+void dukpp03::Value::set(const std::string& name, const dukpp03::Value& v)
+{
+    if (m_type != dukpp03::Value::Type::Object)
+    {
+        *this = dukpp03::Value::object();
+    }
+    for(size_t i = 0; i < m_properties.size(); i++)
+    {
+        if (m_properties[i].first == name)
+        {
+            m_properties[i].second = v;
+            return;
+        }
+    }
+    m_properties.push_back(dukpp03::Value::Property(name, v));
+}
+
+dukpp03::Maybe<dukpp03::Value> dukpp03::Value::get(const std::string& name) const
+{
+    for(size_t i = 0; i < m_properties.size(); i++)
+    {
+        if (m_properties[i].first == name)
+        {
+            return dukpp03::Maybe<dukpp03::Value>(m_properties[i].second);
+        }
+    }
+    return dukpp03::Maybe<dukpp03::Value>();
+}
+
+size_t dukpp03::Value::size() const
+{
+    if (m_type == dukpp03::Value::Type::Array)
+    {
+        return m_elements.size();
+    }
+    return m_properties.size();
+}
+
+bool dukpp03::Value::operator==(const dukpp03::Value& o) const
+{
+    if (m_type != o.m_type)
+    {
+        return false;
+    }
+    switch(m_type)
+    {
+        case dukpp03::Value::Type::Boolean: return m_boolean == o.m_boolean;
+        case dukpp03::Value::Type::Number: return m_number == o.m_number;
+        case dukpp03::Value::Type::String: return m_string == o.m_string;
+        case dukpp03::Value::Type::Array: return m_elements == o.m_elements;
+        case dukpp03::Value::Type::Object: return m_properties == o.m_properties;
+        default: break;
+    };
+    return true;
+}
+
+bool dukpp03::Value::operator!=(const dukpp03::Value& o) const
+{
+    return !(*this == o);
+}
+
+void dukpp03::Value::push(duk_context* ctx) const
+{
+    switch(m_type)
+    {
+        case dukpp03::Value::Type::Undefined: duk_push_undefined(ctx); break;
+        case dukpp03::Value::Type::Null: duk_push_null(ctx); break;
+        case dukpp03::Value::Type::Boolean: duk_push_boolean(ctx, m_boolean); break;
+        case dukpp03::Value::Type::Number: duk_push_number(ctx, m_number); break;
+        case dukpp03::Value::Type::String: duk_push_lstring(ctx, m_string.c_str(), m_string.size()); break;
+        case dukpp03::Value::Type::Array:
+        {
+            duk_require_stack(ctx, 2);
+            duk_push_array(ctx);
+            for(size_t i = 0; i < m_elements.size(); i++)
+            {
+                m_elements[i].push(ctx);
+                duk_put_prop_index(ctx, -2, static_cast<duk_uarridx_t>(i));
+            }
+            break;
+        }
+        case dukpp03::Value::Type::Object:
+        {
+            duk_require_stack(ctx, 2);
+            duk_push_object(ctx);
+            for(size_t i = 0; i < m_properties.size(); i++)
+            {
+                m_properties[i].second.push(ctx);
+                duk_put_prop_lstring(ctx, -2, m_properties[i].first.c_str(), m_properties[i].first.size());
+            }
+            break;
+        }
+    };
+}
+
+dukpp03::Value dukpp03::Value::fromStack(duk_context* ctx, duk_idx_t pos)
+{
+    dukpp03::Value result;
+    dukpp03::Value::fromStack(ctx, pos, result, nullptr);
+    return result;
+}
+
+bool dukpp03::Value::fromStack(duk_context* ctx, duk_idx_t pos, dukpp03::Value& result, std::string* error)
+{
+    duk_require_stack(ctx, 1);
+    duk_dup(ctx, pos);
+    if (duk_safe_call(ctx, dukpp03::Value::readInProtectedCall, &result, 1, 1) != DUK_EXEC_SUCCESS)
+    {
+        if (error)
+        {
+            *error = duk_safe_to_string(ctx, -1);
+        }
+        duk_pop(ctx);
+        result = dukpp03::Value();
+        return false;
+    }
+    duk_pop(ctx);
+    if (error)
+    {
+        *error = "";
+    }
+    return true;
+}
+
+// ================================= PRIVATE METHODS =================================
+
+duk_ret_t dukpp03::Value::readInProtectedCall(duk_context* ctx, void* udata)
+{
+    *static_cast<dukpp03::Value*>(udata) = dukpp03::Value::fromStack(ctx, -1, 0);
+    return 0;
+}
+
+bool dukpp03::Value::pushOwnDataProperty(duk_context* ctx, duk_idx_t obj)
+{
+    duk_get_prop_desc(ctx, obj, 0);
+    if (!duk_is_object(ctx, -1))
+    {
+        duk_pop(ctx);
+        return false;
+    }
+    // Descriptor must not inherit "value" from Object.prototype, since it could be an accessor too
+    duk_push_undefined(ctx);
+    duk_set_prototype(ctx, -2);
+    if (!duk_get_prop_string(ctx, -1, "value"))
+    {
+        duk_pop_2(ctx);
+        return false;
+    }
+    duk_remove(ctx, -2);
+    return true;
+}
+
+dukpp03::Value dukpp03::Value::fromStack(duk_context* ctx, duk_idx_t pos, int depth)
+{
+    pos = duk_normalize_index(ctx, pos);
+    switch(duk_get_type(ctx, pos))
+    {
+        case DUK_TYPE_NULL: return dukpp03::Value::null();
+        case DUK_TYPE_BOOLEAN: return dukpp03::Value(duk_get_boolean(ctx, pos) != 0);
+        case DUK_TYPE_NUMBER: return dukpp03::Value(static_cast<double>(duk_get_number(ctx, pos)));
+        case DUK_TYPE_STRING:
+        {
+            duk_size_t length = 0;
+            const char* s = duk_get_lstring(ctx, pos, &length);
+            return dukpp03::Value(std::string(s, length));
+        }
+        case DUK_TYPE_OBJECT:
+        {
+            if (depth >= dukpp03::Value::MaximalDepth || duk_is_function(ctx, pos))
+            {
+                return dukpp03::Value();
+            }
+            duk_require_stack(ctx, 4);
+            if (duk_is_array(ctx, pos))
+            {
+                dukpp03::Value result = dukpp03::Value::array();
+                const duk_size_t length = duk_get_length(ctx, pos);
+                result.m_elements.reserve(length);
+                for(duk_size_t i = 0; i < length; i++)
+                {
+                    duk_push_uint(ctx, static_cast<duk_uint_t>(i));
+                    if (dukpp03::Value::pushOwnDataProperty(ctx, pos))
+                    {
+                        result.m_elements.push_back(dukpp03::Value::fromStack(ctx, duk_get_top_index(ctx), depth + 1));
+                        duk_pop(ctx);
+                    }
+                    else
+                    {
+                        result.m_elements.push_back(dukpp03::Value());
+                    }
+                }
+                return result;
+            }
+            dukpp03::Value result = dukpp03::Value::object();
+            duk_enum(ctx, pos, DUK_ENUM_OWN_PROPERTIES_ONLY | DUK_ENUM_NO_PROXY_BEHAVIOR);
+            while(duk_next(ctx, -1, 0))
+            {
+                duk_size_t length = 0;
+                const char* name = duk_get_lstring(ctx, -1, &length);
+                const std::string key(name, length);
+                if (dukpp03::Value::pushOwnDataProperty(ctx, pos))
+                {
+                    result.m_properties.push_back(dukpp03::Value::Property(key, dukpp03::Value::fromStack(ctx, duk_get_top_index(ctx), depth + 1)));
+                    duk_pop(ctx);
+                }
+            }
+            duk_pop(ctx);
+            return result;
+        }
+        default: break;
+    };
+    return dukpp03::Value();
+}
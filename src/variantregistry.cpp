@@ -0,0 +1,137 @@
+#include "../include/variantregistry.h"
+
+/*! Amount of bits, used for index of slot in handle
+ */
+#define DUKPP03_REGISTRY_INDEX_BITS 32
+/*! A maximal generation of slot, so handle fits into 53 bits
+ */
+#define DUKPP03_REGISTRY_MAX_GENERATION ((1U << 21) - 1)
+
+dukpp03::VariantRegistry::VariantRegistry() : m_size(0)
+{
+
+}
+
+dukpp03::VariantRegistry::Handle dukpp03::VariantRegistry::insert(void* v, const void* type)
+{
+    unsigned int index = 0;
+    if (m_free.empty())
+    {
+        index = static_cast<unsigned int>(m_slots.size());
+        dukpp03::VariantRegistry::Slot slot;
+        slot.Variant = nullptr;
+        slot.Type = nullptr;
+        slot.Generation = 1;
+        m_slots.push_back(slot);
+    }
+    else
+    {
+        index = m_free.back();
+        m_free.pop_back();
+    }
+    m_slots[index].Variant = v;
+    m_slots[index].Type = type;
+    ++m_size;
+    return (static_cast<dukpp03::VariantRegistry::Handle>(m_slots[index].Generation) << DUKPP03_REGISTRY_INDEX_BITS) | index;
+}
+
+void* dukpp03::VariantRegistry::find(dukpp03::VariantRegistry::Handle h) const
+{
+    const size_t index = this->slot(h);
+    return (index < m_slots.size()) ? m_slots[index].Variant : nullptr;
+}
+
+const void* dukpp03::VariantRegistry::type(dukpp03::VariantRegistry::Handle h) const
+{
+    const size_t index = this->slot(h);
+    return (index < m_slots.size()) ? m_slots[index].Type : nullptr;
+}
+
+void* dukpp03::VariantRegistry::take(dukpp03::VariantRegistry::Handle h)
+{
+    const size_t index = this->slot(h);
+    if (index == m_slots.size())
+    {
+        return nullptr;
+    }
+    void* result = m_slots[index].Variant;
+    this->release(index);
+    return result;
+}
+
+bool dukpp03::VariantRegistry::contains(void* v) const
+{
+    if (!v)
+    {
+        return false;
+    }
+    for(size_t i = 0; i < m_slots.size(); i++)
+    {
+        if (m_slots[i].Variant == v)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool dukpp03::VariantRegistry::remove(void* v)
+{
+    if (!v)
+    {
+        return false;
+    }
+    for(size_t i = 0; i < m_slots.size(); i++)
+    {
+        if (m_slots[i].Variant == v)
+        {
+            this->release(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t dukpp03::VariantRegistry::size() const
+{
+    return m_size;
+}
+
+void dukpp03::VariantRegistry::clear()
+{
+    m_free.clear();
+    for(size_t i = 0; i < m_slots.size(); i++)
+    {
+        if (m_slots[i].Variant)
+        {
+            this->release(i);
+        }
+        else
+        {
+            m_free.push_back(static_cast<unsigned int>(i));
+        }
+    }
+}
+
+// ================================= PRIVATE METHODS =================================
+
+size_t dukpp03::VariantRegistry::slot(dukpp03::VariantRegistry::Handle h) const
+{
+    const size_t index = static_cast<size_t>(h & 0xFFFFFFFFULL);
+    const unsigned int generation = static_cast<unsigned int>(h >> DUKPP03_REGISTRY_INDEX_BITS);
+    if (index >= m_slots.size() || m_slots[index].Generation != generation || m_slots[index].Variant == nullptr)
+    {
+        return m_slots.size();
+    }
+    return index;
+}
+
+void dukpp03::VariantRegistry::release(size_t index)
+{
+    dukpp03::VariantRegistry::Slot& slot = m_slots[index];
+    slot.Variant = nullptr;
+    slot.Type = nullptr;
+    slot.Generation = (slot.Generation == DUKPP03_REGISTRY_MAX_GENERATION) ? 1 : (slot.Generation + 1);
+    m_free.push_back(static_cast<unsigned int>(index));
+    --m_size;
+}
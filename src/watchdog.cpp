@@ -0,0 +1,126 @@
+#include "../include/watchdog.h"
+#include <stdexcept>
+
+dukpp03::Watchdog::Watchdog() : m_sleep_until(dukpp03::Watchdog::Clock::time_point::max()), m_stopping(false)
+{
+    m_thread = std::thread(&dukpp03::Watchdog::run, this);
+}
+
+dukpp03::Watchdog::~Watchdog()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+}
+
+dukpp03::Watchdog* dukpp03::Watchdog::shared()
+{
+    static dukpp03::Watchdog watchdog;
+    return &watchdog;
+}
+
+void dukpp03::Watchdog::arm(std::atomic<bool>* flag, double time)
+{
+    dukpp03::Watchdog::Deadline deadline;
+    deadline.Flag = flag;
+    deadline.Time = dukpp03::Watchdog::Clock::now() + std::chrono::duration_cast<dukpp03::Watchdog::Clock::duration>(std::chrono::duration<double, std::milli>(time));
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        flag->store(false, std::memory_order_relaxed);
+        bool found = false;
+        for(size_t i = 0; i < m_deadlines.size() && !found; i++)
+        {
+            if (m_deadlines[i].Flag == flag)
+            {
+                m_deadlines[i] = deadline;
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            m_deadlines.push_back(deadline);
+        }
+        // Thread needs to be woken only if it sleeps past new deadline. Otherwise it will
+        // find new deadline, when it wakes up, so repeated short evaluations do not wake it
+        wake = (deadline.Time < m_sleep_until);
+    }
+    if (wake)
+    {
+        m_wake.notify_one();
+    }
+}
+
+void dukpp03::Watchdog::disarm(std::atomic<bool>* flag)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(size_t i = 0; i < m_deadlines.size(); i++)
+    {
+        if (m_deadlines[i].Flag == flag)
+        {
+            m_deadlines[i] = m_deadlines.back();
+            m_deadlines.pop_back();
+            return;
+        }
+    }
+}
+
+size_t dukpp03::Watchdog::armed()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_deadlines.size();
+}
+
+// ================================= PRIVATE METHODS =================================
+
+dukpp03::Watchdog::Watchdog(const dukpp03::Watchdog& o)
+{
+    throw std::logic_error("dukpp03::Watchdog is non-copyable!");
+}
+
+dukpp03::Watchdog& dukpp03::Watchdog::operator=(const dukpp03::Watchdog& o)
+{
+    throw std::logic_error("dukpp03::Watchdog is non-copyable!");
+    return *this;
+}
+
+void dukpp03::Watchdog::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(!m_stopping)
+    {
+        if (m_deadlines.empty())
+        {
+            m_sleep_until = dukpp03::Watchdog::Clock::time_point::max();
+            m_wake.wait(lock);
+            continue;
+        }
+        dukpp03::Watchdog::Clock::time_point now = dukpp03::Watchdog::Clock::now();
+        dukpp03::Watchdog::Clock::time_point nearest = dukpp03::Watchdog::Clock::time_point::max();
+        for(size_t i = 0; i < m_deadlines.size(); )
+        {
+            if (m_deadlines[i].Time <= now)
+            {
+                m_deadlines[i].Flag->store(true, std::memory_order_relaxed);
+                m_deadlines[i] = m_deadlines.back();
+                m_deadlines.pop_back();
+            }
+            else
+            {
+                if (m_deadlines[i].Time < nearest)
+                {
+                    nearest = m_deadlines[i].Time;
+                }
+                ++i;
+            }
+        }
+        if (!m_deadlines.empty())
+        {
+            m_sleep_until = nearest;
+            m_wake.wait_until(lock, nearest);
+        }
+    }
+}
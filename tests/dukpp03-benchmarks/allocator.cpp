@@ -0,0 +1,37 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+void benchmarkAllocator()
+{
+    benchmark::group("Heap allocation: default malloc vs pool allocator");
+
+    const std::string eval_heavy = "var s = ''; for(var i = 0; i < 20; i++) { s += String(i) + ','; } s.split(',').length";
+    const std::string churn = "var list = []; for(var i = 0; i < 1000; i++) { list.push({ id: i, name: 'n' + i, tags: [i, i + 1] }); } list = null;";
+
+    {
+        dukpp03::context::Context ctx;
+        benchmark::run("eval-heavy, malloc", 20000, [&ctx, &eval_heavy](long) {
+            ctx.eval(eval_heavy);
+        });
+        benchmark::run("object churn, malloc", 500, [&ctx, &churn](long) {
+            ctx.eval(churn);
+        });
+        benchmark::run("create context, malloc", 1000, [](long) {
+            dukpp03::context::Context c;
+        });
+    }
+    {
+        dukpp03::PoolAllocator allocator;
+        dukpp03::context::Context ctx(&allocator);
+        benchmark::run("eval-heavy, pool", 20000, [&ctx, &eval_heavy](long) {
+            ctx.eval(eval_heavy);
+        });
+        benchmark::run("object churn, pool", 500, [&ctx, &churn](long) {
+            ctx.eval(churn);
+        });
+        dukpp03::PoolAllocator shared;
+        benchmark::run("create context, pool", 1000, [&shared](long) {
+            dukpp03::context::Context c(&shared);
+        });
+    }
+}
@@ -0,0 +1,60 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+typedef dukpp03::context::Context Context;
+
+static int take_number(int a)
+{
+    return a;
+}
+
+/*! A callable, which reports invalid arguments by throwing dukpp03::ArgumentException,
+    as generated callables did before
+ */
+class ThrowingCallable: public dukpp03::FunctionCallable<Context>
+{
+public:
+    virtual dukpp03::Callable<Context>* clone() override
+    {
+        return new ThrowingCallable();
+    }
+
+    virtual int requiredArguments() override
+    {
+        return 1;
+    }
+
+    virtual int _call(Context* c) override
+    {
+        dukpp03::Maybe<int> a;
+        dukpp03::Callable<Context>::CheckArgument<int>::onStack(c, a, 0, 1);
+        dukpp03::PushValue<int, Context>::perform(c, a.value());
+        return 1;
+    }
+};
+
+void benchmarkArgumentFailure()
+{
+    const long iterations = 200000;
+    benchmark::group("Calling native function with invalid argument");
+    
+    Context ctx;
+    duk_context* c = ctx.context();
+    ctx.registerCallable("throwing", new ThrowingCallable());
+    ctx.registerCallable("returning", mkf::from(take_number));
+
+    // Called outside of eval, context reports errors without longjmp, so throwing callable unwinds C++ stack
+    benchmark::run("throwing ArgumentException", iterations, [c](long) {
+        duk_get_global_string(c, "throwing");
+        duk_push_string(c, "not a number");
+        duk_pcall(c, 1);
+        duk_pop(c);
+    });
+    
+    benchmark::run("returning status", iterations, [c](long) {
+        duk_get_global_string(c, "returning");
+        duk_push_string(c, "not a number");
+        duk_pcall(c, 1);
+        duk_pop(c);
+    });
+}
@@ -0,0 +1,119 @@
+/*! \file benchmark.h
+
+    Defines a simple helpers for measuring and reporting performance of library
+ */
+#pragma once
+#include <boost/timer/timer.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+namespace benchmark
+{
+
+/*! Runs function specified amount of times and prints amount of operations per second
+    \param[in] name a name of benchmark
+    \param[in] iterations amount of iterations
+    \param[in] f a function, which should be called with number of iteration
+    \return amount of operations per second
+ */
+template<
+    typename _Function
+>
+double run(const std::string& name, long iterations, _Function f)
+{
+    boost::timer::cpu_timer timer;
+    for(long i = 0; i < iterations; i++)
+    {
+        f(i);
+    }
+    timer.stop();
+    double seconds = static_cast<double>(timer.elapsed().wall) / 1.0E+9;
+    double ops = (seconds > 0) ? (static_cast<double>(iterations) / seconds) : 0;
+    std::cout << std::left << std::setw(60) << name 
+              << std::right << std::setw(16) << std::fixed << std::setprecision(0) << ops << " ops/sec"
+              << std::setw(12) << std::setprecision(3) << seconds << " s\n";
+    return ops;
+}
+
+/*! Prints a value, derived from results of benchmark, e.g. amount of calls per second
+    \param[in] name a name of value
+    \param[in] value a value
+    \param[in] unit a unit of value
+ */
+inline void report(const std::string& name, double value, const std::string& unit)
+{
+    std::cout << std::left << std::setw(60) << name
+              << std::right << std::setw(16) << std::fixed << std::setprecision(0) << value << " " << unit << "\n";
+}
+
+/*! Prints a header for group of benchmarks
+    \param[in] name a name of group
+ */
+inline void group(const std::string& name)
+{
+    std::cout << "\n[ " << name << " ]\n";
+}
+
+}
+
+/*! Measures pushing native callables on stack
+ */
+void benchmarkPushCallable();
+/*! Measures dispatching calls to overloaded native functions
+ */
+void benchmarkDispatch();
+/*! Measures calling native functions with arguments of invalid type
+ */
+void benchmarkArgumentFailure();
+/*! Measures calling stored callbacks
+ */
+void benchmarkCompiledFunction();
+/*! Measures evaluating the same script with and without script cache
+ */
+void benchmarkScriptCache();
+/*! Measures starting context from sources and from precompiled bundle
+ */
+void benchmarkBundle();
+/*! Measures creating contexts with same bindings by hand and from template
+ */
+void benchmarkContextTemplate();
+/*! Measures handling requests in new contexts and in contexts from pool
+ */
+void benchmarkContextPool();
+/*! Measures throughput of script executor with different amount of worker threads
+ */
+void benchmarkScriptExecutor();
+/*! Measures workloads with default allocation and with pool allocator
+ */
+void benchmarkAllocator();
+/*! Measures checking for timeout via timer of context and via watchdog
+ */
+void benchmarkTimeout();
+/*! Measures pushing small structures, returned from native functions, as variants
+ */
+void benchmarkVariantPool();
+/*! Measures creating and finalizing objects, wrapping variants
+ */
+void benchmarkObjectChurn();
+/*! Measures calling methods of bound objects, unwrapping this and object arguments
+ */
+void benchmarkBoundMethod();
+/*! Measures calling native functions and wrapping values with methods of class binding
+ */
+void benchmarkNativeCall();
+/*! Measures passing strings and characters as arguments of native functions
+ */
+void benchmarkStringArguments();
+/*! Measures passing binary data as strings, buffer views and external buffers
+ */
+void benchmarkBufferArguments();
+/*! Measures passing vectors of numbers as arrays and typed arrays
+ */
+void benchmarkContainers();
+/*! Measures integer arithmetic in scripts and passing 64-bit integers to functions
+ */
+void benchmarkIntegers();
+/*! Measures marshalling structured payloads field by field and as JSON or CBOR
+ */
+void benchmarkSerialization();
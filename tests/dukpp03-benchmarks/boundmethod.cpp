@@ -0,0 +1,57 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+/*! A counter, bound as class
+ */
+struct BoundCounter
+{
+    /*! A value of counter
+     */
+    int Value;
+    /*! Constructs counter with zero value
+     */
+    BoundCounter() : Value(0)
+    {
+
+    }
+    /*! Returns value of counter
+        \return value
+     */
+    int value() const
+    {
+        return Value;
+    }
+    /*! Adds value of other counter to this one
+        \param[in] o other counter
+     */
+    void add(const BoundCounter& o)
+    {
+        Value += o.Value;
+    }
+};
+
+void benchmarkBoundMethod()
+{
+    const long iterations = 20;
+    const double calls = 50000;
+    benchmark::group("Calling methods of bound objects (50000 calls per op)");
+
+    dukpp03::context::Context ctx;
+    ClassBinding* c = new ClassBinding();
+    c->addConstructor<BoundCounter>("BoundCounter");
+    c->addMethod("value", bnd::from(&BoundCounter::value));
+    c->addMethod("add", bnd::from(&BoundCounter::add));
+    ctx.addClassBinding(ctx.typeName<BoundCounter>(), c);
+
+    ctx.eval("function loopThis(n) { var a = new BoundCounter(); var s = 0; for(var i = 0; i < n; i++) { s += a.value(); } return s; }");
+    ctx.eval("function loopArgument(n) { var a = new BoundCounter(); var b = new BoundCounter(); for(var i = 0; i < n; i++) { a.add(b); } return a.value(); }");
+
+    benchmark::run("unwrap this", iterations, [&ctx, calls](long) {
+        ctx.callGlobalFunction("loopThis", calls);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("unwrap this and object argument", iterations, [&ctx, calls](long) {
+        ctx.callGlobalFunction("loopArgument", calls);
+        duk_pop(ctx.context());
+    });
+}
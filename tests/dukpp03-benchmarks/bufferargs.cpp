@@ -0,0 +1,100 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+#include <vector>
+
+/*! A buffer over memory, which is not owned by heap, so pushing it does not allocate
+ */
+class BorrowedBuffer: public dukpp03::ExternalBuffer
+{
+public:
+    /*! Constructs buffer
+        \param[in] data memory block
+        \param[in] size size of memory block
+     */
+    BorrowedBuffer(void* data, size_t size) : m_data(data), m_size(size)
+    {
+
+    }
+    /*! Returns memory block
+        \return memory block
+     */
+    virtual void* data() override
+    {
+        return m_data;
+    }
+    /*! Returns size of memory block in bytes
+        \return size of memory block
+     */
+    virtual size_t size() const override
+    {
+        return m_size;
+    }
+private:
+    /*! A memory block
+     */
+    void* m_data;
+    /*! A size of memory block
+     */
+    size_t m_size;
+};
+
+static const size_t megabyte = 1024 * 1024;
+
+static std::vector<unsigned char> frame(megabyte, 1);
+
+static int last_byte_of_string(const std::string& s)
+{
+    return static_cast<unsigned char>(s[s.size() - 1]);
+}
+
+static int last_byte_of_view(dukpp03::BufferView<unsigned char> v)
+{
+    return v[v.size() - 1];
+}
+
+static std::string frame_as_string()
+{
+    return std::string(frame.begin(), frame.end());
+}
+
+static dukpp03::BufferView<unsigned char> frame_as_copy()
+{
+    return dukpp03::BufferView<unsigned char>(frame.data(), frame.size());
+}
+
+void benchmarkBufferArguments()
+{
+    const long iterations = 500;
+    benchmark::group("Passing 1 MB of binary data between native functions and scripts");
+
+    dukpp03::context::Context ctx;
+    ctx.registerCallable("lastOfString", mkf::from(last_byte_of_string));
+    ctx.registerCallable("lastOfView", mkf::from(last_byte_of_view));
+    ctx.registerCallable("frameAsString", mkf::from(frame_as_string));
+    ctx.registerCallable("frameAsCopy", mkf::from(frame_as_copy));
+    ctx.eval("var bytes = new Uint8Array(1024 * 1024); var text = String.fromCharCode.apply(null, new Uint8Array(1024)); "
+             "while(text.length < bytes.length) { text = text + text; }");
+
+    benchmark::run("argument as const std::string&", iterations, [&ctx](long) {
+        ctx.eval("lastOfString(text)", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("argument as dukpp03::BufferView", iterations, [&ctx](long) {
+        ctx.eval("lastOfView(bytes)", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("result as std::string", iterations, [&ctx](long) {
+        ctx.eval("frameAsString().length", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("result as copy of dukpp03::BufferView", iterations, [&ctx](long) {
+        ctx.eval("frameAsCopy().length", false);
+        duk_pop(ctx.context());
+    });
+    duk_context* c = ctx.context();
+    benchmark::run("result as external buffer", iterations, [&ctx, c](long) {
+        ctx.pushExternalBuffer(new BorrowedBuffer(frame.data(), frame.size()));
+        duk_get_prop_string(c, -1, "length");
+        duk_pop_2(c);
+    });
+}
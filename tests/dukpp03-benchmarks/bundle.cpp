@@ -0,0 +1,46 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+#include <cstdio>
+#include <sstream>
+
+void benchmarkBundle()
+{
+    const long iterations = 500;
+    benchmark::group("Starting context with library of scripts");
+
+    std::vector<dukpp03::Bundle::Source> sources;
+    for(int i = 0; i < 8; i++)
+    {
+        std::ostringstream stream;
+        stream << "var module" << i << " = {};\n";
+        for(int j = 0; j < 16; j++)
+        {
+            stream << "module" << i << ".f" << j << " = function(a, b) { var r = []; for(var k = 0; k < a; k++) { r.push(k * b + " << j << "); } return r.join(','); };\n";
+        }
+        stream << "function init" << i << "() { return module" << i << ".f0(2, 3); }\n";
+        std::ostringstream name;
+        name << "module" << i << ".js";
+        sources.push_back(dukpp03::Bundle::Source(name.str(), stream.str()));
+    }
+    const std::string path = "benchmark.bundle";
+    std::string error;
+    if (!dukpp03::Bundle::write(path, sources, &error))
+    {
+        std::cout << error << "\n";
+        return;
+    }
+
+    benchmark::run("create context and eval sources", iterations, [&sources](long) {
+        dukpp03::context::Context ctx;
+        for(size_t i = 0; i < sources.size(); i++)
+        {
+            ctx.eval(sources[i].second);
+        }
+    });
+
+    benchmark::run("create context and load bundle", iterations, [&path](long) {
+        dukpp03::context::Context ctx;
+        ctx.loadBundle(path);
+    });
+    remove(path.c_str());
+}
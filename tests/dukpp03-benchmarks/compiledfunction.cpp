@@ -0,0 +1,49 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+#include <vector>
+#include <cstring>
+
+typedef dukpp03::context::Context Context;
+
+static compiledfunc callback;
+
+static void set_callback(const compiledfunc& f)
+{
+    callback = f;
+}
+
+void benchmarkCompiledFunction()
+{
+    const long iterations = 200000;
+    benchmark::group("Calling stored callbacks");
+    
+    Context ctx;
+    duk_context* c = ctx.context();
+    ctx.registerCallable("setCallback", mkf::from(set_callback));
+    ctx.eval("setCallback(function(a) { return a + 1; });");
+
+    // A way, callbacks were called before: deserializing bytecode on every call
+    duk_size_t size = 0;
+    callback.pushMeOnStack(&ctx);
+    duk_dump_function(c);
+    void* dumped = duk_get_buffer(c, -1, &size);
+    std::vector<char> bytecode(static_cast<char*>(dumped), static_cast<char*>(dumped) + size);
+    duk_pop(c);
+
+    benchmark::run("loading bytecode on every call", iterations, [c, &bytecode](long i) {
+        void* p = duk_push_fixed_buffer(c, bytecode.size());
+        memcpy(p, &(bytecode[0]), bytecode.size());
+        duk_load_function(c);
+        duk_push_int(c, static_cast<int>(i));
+        duk_pcall(c, 1);
+        duk_pop(c);
+    });
+
+    benchmark::run("CompiledFunction::call", iterations, [&ctx, c](long i) {
+        duk_push_int(c, static_cast<int>(i));
+        callback.call(&ctx);
+        ctx.cleanStack();
+    });
+
+    callback = compiledfunc();
+}
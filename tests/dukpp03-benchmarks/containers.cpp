@@ -0,0 +1,52 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+#include <vector>
+
+static std::vector<double> identity(const std::vector<double>& v)
+{
+    return v;
+}
+
+static double first(const std::vector<double>& v)
+{
+    return v.empty() ? 0 : v[0];
+}
+
+static dukpp03::BufferView<double> identity_as_view(dukpp03::BufferView<double> v)
+{
+    return v;
+}
+
+void benchmarkContainers()
+{
+    const long iterations = 10;
+    benchmark::group("Round-tripping vectors of 1000000 numbers");
+
+    dukpp03::context::Context ctx;
+    ctx.registerCallable("identity", mkf::from(identity));
+    ctx.registerCallable("first", mkf::from(first));
+    ctx.registerCallable("identityAsView", mkf::from(identity_as_view));
+    ctx.eval("var n = 1000000; var plain = new Array(n); var typed = new Float64Array(n); "
+             "for(var i = 0; i < n; i++) { plain[i] = i * 0.5; typed[i] = i * 0.5; }");
+
+    benchmark::run("Array to std::vector<double>", iterations, [&ctx](long) {
+        ctx.eval("first(plain)", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("Float64Array to std::vector<double>", iterations, [&ctx](long) {
+        ctx.eval("first(typed)", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("Array to std::vector<double> and back", iterations, [&ctx](long) {
+        ctx.eval("identity(plain).length", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("Float64Array to std::vector<double> and back", iterations, [&ctx](long) {
+        ctx.eval("identity(typed).length", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("Float64Array to dukpp03::BufferView and back", iterations, [&ctx](long) {
+        ctx.eval("identityAsView(typed).length", false);
+        duk_pop(ctx.context());
+    });
+}
@@ -0,0 +1,44 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+#include "contextpool.h"
+#include <sstream>
+
+static double scale(double a, double b)
+{
+    return a * b;
+}
+
+void benchmarkContextPool()
+{
+    const long iterations = 2000;
+    benchmark::group("Handling request in isolated context");
+
+    std::ostringstream stream;
+    for(int i = 0; i < 32; i++)
+    {
+        stream << "function rule" << i << "(v) { return scale(v, " << i << ") + 1; }\n";
+    }
+    dukpp03::ContextTemplate<dukpp03::context::Context> t;
+    t.registerCallable("scale", mkf::from(scale));
+    t.addScript(stream.str(), "rules.js");
+
+    const std::string request = "var request = { id: 1, values: [1, 2, 3] }; var total = 0; for(var i = 0; i < request.values.length; i++) { total += rule3(request.values[i]); } total";
+
+    benchmark::run("new context per request", iterations, [&t, &request](long) {
+        dukpp03::context::Context* ctx = t.create();
+        ctx->eval(request);
+        delete ctx;
+    });
+
+    dukpp03::ContextPool<dukpp03::context::Context> pool(4, &t);
+    benchmark::run("borrow context from pool", iterations, [&pool, &request](long) {
+        dukpp03::context::Context* ctx = pool.borrow();
+        ctx->eval(request);
+        pool.giveBack(ctx);
+    });
+    dukpp03::ContextPoolMetrics metrics = pool.metrics();
+    std::cout << "average borrow: " << (metrics.TotalBorrowTime / metrics.Borrows * 1e6) << " us, "
+              << "average scrub: " << (metrics.TotalScrubTime / metrics.Returns * 1e6) << " us, "
+              << "max scrub: " << (metrics.MaxScrubTime * 1e6) << " us, "
+              << "exhaustions: " << metrics.Exhaustions << "\n";
+}
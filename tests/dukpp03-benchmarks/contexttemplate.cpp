@@ -0,0 +1,85 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+#include <sstream>
+
+/*! A simple class, bound to contexts in benchmark
+ */
+struct Vector2
+{
+    double X;
+    double Y;
+
+    Vector2() : X(0), Y(0)
+    {
+    }
+
+    Vector2(double x, double y) : X(x), Y(y)
+    {
+    }
+
+    double length2() const
+    {
+        return X * X + Y * Y;
+    }
+};
+
+static double scale(double a, double b)
+{
+    return a * b;
+}
+
+/*! Creates binding for Vector2
+    \return binding
+ */
+static ClassBinding* makeVectorBinding()
+{
+    ClassBinding* c = new ClassBinding();
+    c->addConstructor<Vector2>("Vector2");
+    c->addConstructor<Vector2, double, double>("Vector2");
+    c->addMethod("length2", bnd::from(&Vector2::length2));
+    c->addAccessor("x", getter::from(&Vector2::X), setter::from(&Vector2::X));
+    c->addAccessor("y", getter::from(&Vector2::Y), setter::from(&Vector2::Y));
+    return c;
+}
+
+void benchmarkContextTemplate()
+{
+    const long iterations = 500;
+    benchmark::group("Creating context with bindings and bootstrap scripts");
+
+    std::vector<std::string> scripts;
+    for(int i = 0; i < 4; i++)
+    {
+        std::ostringstream stream;
+        stream << "var helpers" << i << " = {};\n";
+        for(int j = 0; j < 16; j++)
+        {
+            stream << "helpers" << i << ".f" << j << " = function(v) { return scale(v.length2(), " << j << "); };\n";
+        }
+        scripts.push_back(stream.str());
+    }
+
+    benchmark::run("setup by hand", iterations, [&scripts](long) {
+        dukpp03::context::Context ctx;
+        ctx.addClassBinding("Vector2", makeVectorBinding());
+        ctx.registerCallable("scale", mkf::from(scale));
+        ctx.registerGlobal("version", std::string("1.0"));
+        for(size_t i = 0; i < scripts.size(); i++)
+        {
+            ctx.eval(scripts[i]);
+        }
+    });
+
+    dukpp03::ContextTemplate<dukpp03::context::Context> t;
+    t.addClassBinding("Vector2", makeVectorBinding());
+    t.registerCallable("scale", mkf::from(scale));
+    t.registerGlobal("version", std::string("1.0"));
+    for(size_t i = 0; i < scripts.size(); i++)
+    {
+        t.addScript(scripts[i], "helpers.js");
+    }
+    benchmark::run("create from template", iterations, [&t](long) {
+        dukpp03::context::Context* ctx = t.create();
+        delete ctx;
+    });
+}
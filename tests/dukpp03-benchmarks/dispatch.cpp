@@ -0,0 +1,49 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+static int take_string(std::string)
+{
+    return 1;
+}
+
+static int take_number(double)
+{
+    return 2;
+}
+
+static int take_two_numbers(double, double)
+{
+    return 3;
+}
+
+void benchmarkDispatch()
+{
+    const long iterations = 20;
+    const double calls = 50000;
+    benchmark::group("Dispatching overloaded native functions (50000 calls per op)");
+
+    dukpp03::context::Context ctx;
+    dukpp03::MultiMethod<dukpp03::context::Context>* m = new dukpp03::MultiMethod<dukpp03::context::Context>();
+    m->add(mkf::from(take_string));
+    m->add(mkf::from(take_number));
+    m->add(mkf::from(take_two_numbers));
+    ctx.registerCallable("f", m);
+    ctx.registerCallable("single", mkf::from(take_number));
+
+    ctx.eval("function loopSingle(n) { var s = 0; for(var i = 0; i < n; i++) { s += single(i); } return s; }");
+    ctx.eval("function loopOverloaded(n) { var s = 0; for(var i = 0; i < n; i++) { s += f(i); } return s; }");
+    ctx.eval("function loopMixed(n) { var s = 0; for(var i = 0; i < n; i++) { s += f(i) + f('a') + f(i, i); } return s; }");
+
+    benchmark::run("single overload", iterations, [&ctx, calls](long) {
+        ctx.callGlobalFunction("loopSingle", calls);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("three overloads, same shape", iterations, [&ctx, calls](long) {
+        ctx.callGlobalFunction("loopOverloaded", calls);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("three overloads, three shapes (x3 calls)", iterations, [&ctx, calls](long) {
+        ctx.callGlobalFunction("loopMixed", calls);
+        duk_pop(ctx.context());
+    });
+}
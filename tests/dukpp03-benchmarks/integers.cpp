@@ -0,0 +1,43 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+static long long add_long(long long a, long long b)
+{
+    return a + b;
+}
+
+static dukpp03::ExactInt64 add_exact(dukpp03::ExactInt64 a, dukpp03::ExactInt64 b)
+{
+    return dukpp03::ExactInt64(a.value() + b.value());
+}
+
+void benchmarkIntegers()
+{
+    const long iterations = 10;
+    benchmark::group(dukpp03::AbstractContext::usesFastIntegers() ? "Integer arithmetic with fast integers" : "Integer arithmetic without fast integers");
+
+    dukpp03::context::Context ctx;
+    ctx.registerCallable("addLong", mkf::from(add_long));
+    ctx.registerCallable("addExact", mkf::from(add_exact));
+
+    benchmark::run("Script loop with additions and bit operations", iterations, [&ctx](long) {
+        ctx.eval("var s = 0; for(var i = 0; i < 1000000; i++) { s = (s + (i & 255) ^ (i >> 3)) | 0; } s", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("Script loop over array indices", iterations, [&ctx](long) {
+        ctx.eval("var a = new Array(1000); var t = 0; for(var k = 0; k < 1000; k++) { for(var i = 0; i < 1000; i++) { a[i] = i; t += a[i]; } } t", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("1000000 calls with long long arguments", iterations, [&ctx](long) {
+        ctx.eval("var s = 0; for(var i = 0; i < 1000000; i++) { s = addLong(s, i); } s", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("1000000 calls with dukpp03::ExactInt64 arguments", iterations, [&ctx](long) {
+        ctx.eval("var s = 0; for(var i = 0; i < 1000000; i++) { s = addExact(s, i); } s", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("100000 calls with dukpp03::ExactInt64 beyond 2^53", iterations, [&ctx](long) {
+        ctx.eval("var s = '9007199254740993'; for(var i = 0; i < 100000; i++) { s = addExact(s, 1); } s", false);
+        duk_pop(ctx.context());
+    });
+}
@@ -0,0 +1,26 @@
+#include "benchmark.h"
+
+int main(int argc, char** argv)
+{
+    benchmarkPushCallable();
+    benchmarkDispatch();
+    benchmarkArgumentFailure();
+    benchmarkCompiledFunction();
+    benchmarkScriptCache();
+    benchmarkBundle();
+    benchmarkContextTemplate();
+    benchmarkContextPool();
+    benchmarkScriptExecutor();
+    benchmarkAllocator();
+    benchmarkTimeout();
+    benchmarkVariantPool();
+    benchmarkObjectChurn();
+    benchmarkBoundMethod();
+    benchmarkNativeCall();
+    benchmarkStringArguments();
+    benchmarkBufferArguments();
+    benchmarkContainers();
+    benchmarkIntegers();
+    benchmarkSerialization();
+    return 0;
+}
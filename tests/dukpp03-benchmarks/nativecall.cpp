@@ -0,0 +1,81 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+static int native_noop()
+{
+    return 0;
+}
+
+/*! A value with several methods, wrapped by class binding
+ */
+struct WrappedValue
+{
+    /*! A value
+     */
+    int Value;
+    /*! Constructs zero value
+     */
+    WrappedValue() : Value(0)
+    {
+
+    }
+    /*! Returns value
+        \return value
+     */
+    int get() const
+    {
+        return Value;
+    }
+    /*! Sets value
+        \param[in] v value
+     */
+    void set(int v)
+    {
+        Value = v;
+    }
+    /*! Increments value
+     */
+    void increment()
+    {
+        ++Value;
+    }
+    /*! Decrements value
+     */
+    void decrement()
+    {
+        --Value;
+    }
+};
+
+void benchmarkNativeCall()
+{
+    const long iterations = 20;
+    const double calls = 100000;
+    benchmark::group("Native call dispatch and wrapping (100000 calls or 10000 objects per op)");
+
+    dukpp03::context::Context ctx;
+    ctx.registerCallable("noop", mkf::from(native_noop));
+    ClassBinding* c = new ClassBinding();
+    c->addMethod("get", bnd::from(&WrappedValue::get));
+    c->addMethod("set", bnd::from(&WrappedValue::set));
+    c->addMethod("increment", bnd::from(&WrappedValue::increment));
+    c->addMethod("decrement", bnd::from(&WrappedValue::decrement));
+    ctx.addClassBinding(ctx.typeName<WrappedValue>(), c);
+
+    ctx.eval("function loopNoop(n) { for(var i = 0; i < n; i++) { noop(); } }");
+
+    const double ops = benchmark::run("call native no-op function", iterations, [&ctx, calls](long) {
+        ctx.callGlobalFunction("loopNoop", calls);
+        duk_pop(ctx.context());
+    });
+    benchmark::report("  native calls", ops * calls, "calls/sec");
+    duk_context* d = ctx.context();
+    WrappedValue value;
+    benchmark::run("wrap value with 4 methods", iterations, [&ctx, d, &value](long) {
+        for(int i = 0; i < 10000; i++)
+        {
+            dukpp03::PushValue<WrappedValue, dukpp03::context::Context>::perform(&ctx, value);
+            duk_pop(d);
+        }
+    });
+}
@@ -0,0 +1,40 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+/*! A small value type, pushed as variant
+ */
+struct ChurnValue
+{
+    /*! A value
+     */
+    int Value;
+};
+
+void benchmarkObjectChurn()
+{
+    benchmark::group("Object churn: push and finalize variants (100000 objects per op)");
+
+    dukpp03::context::Context ctx;
+    duk_context* c = ctx.context();
+    ChurnValue value;
+    value.Value = 1;
+
+    benchmark::run("push, pop, finalize", 20, [&ctx, c, &value](long) {
+        for(int i = 0; i < 100000; i++)
+        {
+            dukpp03::PushValue<ChurnValue, dukpp03::context::Context>::perform(&ctx, value);
+            duk_pop(c);
+        }
+    });
+    duk_require_stack(c, 1000);
+    benchmark::run("1000 live objects, then finalize", 20, [&ctx, c, &value](long) {
+        for(int i = 0; i < 100; i++)
+        {
+            for(int j = 0; j < 1000; j++)
+            {
+                dukpp03::PushValue<ChurnValue, dukpp03::context::Context>::perform(&ctx, value);
+            }
+            duk_pop_n(c, 1000);
+        }
+    });
+}
@@ -0,0 +1,45 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+static int noop()
+{
+    return 0;
+}
+
+static duk_ret_t noop_native(duk_context*)
+{
+    return 0;
+}
+
+void benchmarkPushCallable()
+{
+    const long iterations = 200000;
+    benchmark::group("Pushing native callables");
+    
+    dukpp03::context::Context ctx;
+    dukpp03::Callable<dukpp03::context::Context>* f = mkf::from(noop);
+    duk_context* c = ctx.context();
+    
+    // A wiring, which was used before, evaluating new Function() for each push
+    benchmark::run("pushCallable, evaluating \"new Function()\"", iterations, [c](long) {
+        duk_push_c_function(c, noop_native, DUK_VARARGS);
+        duk_peval_string(c, "new Function()");
+        duk_dup(c, -1);
+        duk_put_prop_string(c, -3, "prototype");
+        duk_set_prototype(c, -2);
+        duk_pop(c);
+    });
+    duk_gc(c, 0);
+    
+    benchmark::run("pushCallable", iterations, [&ctx, c, f](long) {
+        ctx.pushCallable(f, false);
+        duk_pop(c);
+    });
+    duk_gc(c, 0);
+
+    benchmark::run("registerNativeFunction", iterations, [&ctx](long) {
+        ctx.registerNativeFunction("noop", noop_native, 0);
+    });
+    
+    delete f;
+}
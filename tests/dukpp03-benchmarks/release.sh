@@ -0,0 +1,2 @@
+cmake -G "Unix Makefiles" -DCMAKE_BUILD_TYPE=Release
+make
\ No newline at end of file
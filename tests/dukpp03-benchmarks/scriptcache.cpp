@@ -0,0 +1,24 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+void benchmarkScriptCache()
+{
+    const long iterations = 50000;
+    benchmark::group("Evaluating the same script with file name");
+
+    const std::string source = "var total = 0; for(var i = 0; i < 4; i++) { total += rule(i * 2, i + 1); } total > 10;";
+    const std::string filename = "rule.js";
+
+    dukpp03::context::Context ctx;
+    ctx.eval("function rule(a, b) { return a * b - 1; }");
+    ctx.scriptCache().setMemoryLimit(0);
+    benchmark::run("eval without cache", iterations, [&ctx, &source, &filename](long) {
+        ctx.eval(source, filename);
+    });
+
+    ctx.scriptCache().setMemoryLimit(dukpp03::ScriptCache::DefaultMemoryLimit);
+    benchmark::run("eval with cache", iterations, [&ctx, &source, &filename](long) {
+        ctx.eval(source, filename);
+    });
+    std::cout << "hits: " << ctx.scriptCache().hits() << ", misses: " << ctx.scriptCache().misses() << "\n";
+}
@@ -0,0 +1,46 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+#include "scriptexecutor.h"
+#include <thread>
+#include <sstream>
+
+void benchmarkScriptExecutor()
+{
+    const long iterations = 10;
+    const int tasks = 400;
+    benchmark::group("Running independent scripts on worker threads (400 tasks per op)");
+
+    dukpp03::ContextTemplate<dukpp03::context::Context> t;
+    t.addScript("function work(n) { var s = 0; for(var i = 0; i < n; i++) { s += (i * 7) % 13; } return s; }", "work.js");
+
+    size_t max_threads = std::thread::hardware_concurrency();
+    if (max_threads == 0)
+    {
+        max_threads = 1;
+    }
+    std::vector<size_t> counts;
+    for(size_t threads = 1; threads < max_threads; threads *= 2)
+    {
+        counts.push_back(threads);
+    }
+    counts.push_back(max_threads);
+    for(size_t i = 0; i < counts.size(); i++)
+    {
+        dukpp03::ScriptExecutor<dukpp03::context::Context> executor(counts[i], &t);
+        std::ostringstream name;
+        name << counts[i] << " thread(s)";
+        benchmark::run(name.str(), iterations, [&executor, tasks](long) {
+            std::vector<dukpp03::Value> args(1, dukpp03::Value(5000));
+            std::vector< std::future<dukpp03::ScriptResult> > results;
+            for(int j = 0; j < tasks; j++)
+            {
+                results.push_back(executor.submitCall("work", args));
+            }
+            for(int j = 0; j < tasks; j++)
+            {
+                results[j].wait();
+            }
+        });
+        std::cout << "stolen tasks: " << executor.steals() << "\n";
+    }
+}
@@ -0,0 +1,96 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+#include <string>
+#include <vector>
+
+/*! An event, marshalled in benchmark
+ */
+struct Event
+{
+    int Id;
+    std::string Kind;
+    std::string Source;
+    double Value;
+    bool Urgent;
+};
+
+/*! Pushes events field by field
+    \param[in] ctx context
+    \param[in] events events
+ */
+static void push_fields(dukpp03::context::Context& ctx, const std::vector<Event>& events)
+{
+    duk_context* c = ctx.context();
+    duk_push_array(c);
+    for(size_t i = 0; i < events.size(); i++)
+    {
+        duk_push_object(c);
+        dukpp03::PushValue<int, dukpp03::context::Context>::perform(&ctx, events[i].Id);
+        duk_put_prop_string(c, -2, "id");
+        dukpp03::PushValue<std::string, dukpp03::context::Context>::perform(&ctx, events[i].Kind);
+        duk_put_prop_string(c, -2, "kind");
+        dukpp03::PushValue<std::string, dukpp03::context::Context>::perform(&ctx, events[i].Source);
+        duk_put_prop_string(c, -2, "source");
+        dukpp03::PushValue<double, dukpp03::context::Context>::perform(&ctx, events[i].Value);
+        duk_put_prop_string(c, -2, "value");
+        dukpp03::PushValue<bool, dukpp03::context::Context>::perform(&ctx, events[i].Urgent);
+        duk_put_prop_string(c, -2, "urgent");
+        duk_put_prop_index(c, -2, static_cast<duk_uarridx_t>(i));
+    }
+}
+
+void benchmarkSerialization()
+{
+    const long iterations = 2000;
+    benchmark::group("Marshalling payload of 64 events (about 6 KB of JSON)");
+
+    std::vector<Event> events;
+    for(int i = 0; i < 64; i++)
+    {
+        Event e = { i, "measurement", "sensor-" + std::to_string(i), i * 0.25, (i % 3) == 0 };
+        events.push_back(e);
+    }
+
+    dukpp03::context::Context ctx;
+    dukpp03::FieldMap<dukpp03::context::Context, Event> map;
+    map.addField("id", &Event::Id).addField("kind", &Event::Kind).addField("source", &Event::Source)
+       .addField("value", &Event::Value).addField("urgent", &Event::Urgent);
+
+    push_fields(ctx, events);
+    std::string json;
+    ctx.encodeJSON(-1, json);
+    std::vector<unsigned char> cbor;
+    ctx.encodeCBOR(-1, cbor);
+    ctx.cleanStack();
+
+    benchmark::run("Pushing fields one by one", iterations, [&ctx, &events](long) {
+        push_fields(ctx, events);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("Pushing via dukpp03::FieldMap", iterations, [&ctx, &events, &map](long) {
+        duk_push_array(ctx.context());
+        for(size_t i = 0; i < events.size(); i++)
+        {
+            map.push(&ctx, events[i]);
+            duk_put_prop_index(ctx.context(), -2, static_cast<duk_uarridx_t>(i));
+        }
+        duk_pop(ctx.context());
+    });
+    benchmark::run("Decoding JSON text", iterations, [&ctx, &json](long) {
+        ctx.decodeJSON(json.c_str(), json.size());
+        duk_pop(ctx.context());
+    });
+    benchmark::run("Decoding CBOR data", iterations, [&ctx, &cbor](long) {
+        ctx.decodeCBOR(cbor.data(), cbor.size());
+        duk_pop(ctx.context());
+    });
+
+    push_fields(ctx, events);
+    benchmark::run("Encoding as JSON text", iterations, [&ctx, &json](long) {
+        ctx.encodeJSON(-1, json);
+    });
+    benchmark::run("Encoding as CBOR data", iterations, [&ctx, &cbor](long) {
+        ctx.encodeCBOR(-1, cbor);
+    });
+    ctx.cleanStack();
+}
@@ -0,0 +1,61 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+static int string_length(const std::string& s)
+{
+    return static_cast<int>(s.size());
+}
+
+static int string_ref_length(dukpp03::StringRef s)
+{
+    return static_cast<int>(s.size());
+}
+
+#ifdef DUKPP03_HAS_STRING_VIEW
+
+static int string_view_length(std::string_view s)
+{
+    return static_cast<int>(s.size());
+}
+
+#endif
+
+static int character_code(char c)
+{
+    return static_cast<int>(c);
+}
+
+void benchmarkStringArguments()
+{
+    const long iterations = 20;
+    benchmark::group("String arguments of native functions (100000 calls per op)");
+
+    dukpp03::context::Context ctx;
+    ctx.registerCallable("byString", mkf::from(string_length));
+    ctx.registerCallable("byRef", mkf::from(string_ref_length));
+    ctx.registerCallable("byChar", mkf::from(character_code));
+    ctx.eval(
+        "var text = ''; for(var i = 0; i < 64; i++) { text += String.fromCharCode(97 + i % 26); }"
+        "function loopString(f, s, n) { var r = 0; for(var i = 0; i < n; i++) { r += f(s); } return r; }"
+    );
+
+    benchmark::run("64-character string as const std::string&", iterations, [&ctx](long) {
+        ctx.eval("loopString(byString, text, 100000)", false);
+        duk_pop(ctx.context());
+    });
+    benchmark::run("64-character string as dukpp03::StringRef", iterations, [&ctx](long) {
+        ctx.eval("loopString(byRef, text, 100000)", false);
+        duk_pop(ctx.context());
+    });
+#ifdef DUKPP03_HAS_STRING_VIEW
+    ctx.registerCallable("byView", mkf::from(string_view_length));
+    benchmark::run("64-character string as std::string_view", iterations, [&ctx](long) {
+        ctx.eval("loopString(byView, text, 100000)", false);
+        duk_pop(ctx.context());
+    });
+#endif
+    benchmark::run("single character as char", iterations, [&ctx](long) {
+        ctx.eval("loopString(byChar, 'a', 100000)", false);
+        duk_pop(ctx.context());
+    });
+}
@@ -0,0 +1,68 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+/*! Calls timeout check hook of Duktape specified amount of times, like interrupt does
+    \param[in] ctx context
+    \return 1
+ */
+static duk_ret_t benchmarkCheckTimeout(duk_context* ctx)
+{
+    dukpp03::AbstractContext* parent = dukpp03::AbstractContext::getContext(ctx);
+    int count = duk_get_int(ctx, 0);
+    int reached = 0;
+    for(int i = 0; i < count; i++)
+    {
+        reached += dukpp03::____check_timeout(parent);
+    }
+    duk_push_int(ctx, reached);
+    return 1;
+}
+
+void benchmarkTimeout()
+{
+    benchmark::group("Timeout checking: timer of context vs watchdog");
+
+    const std::string loop = "var s = 0; for(var i = 0; i < 300000; i++) { s += i; } s";
+
+    {
+        dukpp03::context::Context ctx;
+        benchmark::run("for loop, timer", 30, [&ctx, &loop](long) {
+            ctx.eval(loop);
+        });
+    }
+    {
+        dukpp03::context::Context ctx;
+        ctx.setWatchdog(dukpp03::Watchdog::shared());
+        benchmark::run("for loop, watchdog", 30, [&ctx, &loop](long) {
+            ctx.eval(loop);
+        });
+    }
+    {
+        dukpp03::context::Context ctx;
+        ctx.registerNativeFunction("check", benchmarkCheckTimeout, 1);
+        benchmark::run("100000 hook calls, timer", 50, [&ctx](long) {
+            ctx.eval("check(100000)");
+        });
+    }
+    {
+        dukpp03::context::Context ctx;
+        ctx.setWatchdog(dukpp03::Watchdog::shared());
+        ctx.registerNativeFunction("check", benchmarkCheckTimeout, 1);
+        benchmark::run("100000 hook calls, watchdog", 50, [&ctx](long) {
+            ctx.eval("check(100000)");
+        });
+    }
+    {
+        dukpp03::context::Context ctx;
+        benchmark::run("short eval, timer", 20000, [&ctx](long) {
+            ctx.eval("1 + 1");
+        });
+    }
+    {
+        dukpp03::context::Context ctx;
+        ctx.setWatchdog(dukpp03::Watchdog::shared());
+        benchmark::run("short eval, watchdog", 20000, [&ctx](long) {
+            ctx.eval("1 + 1");
+        });
+    }
+}
@@ -0,0 +1,36 @@
+#include "benchmark.h"
+#include "../dukpp03/context.h"
+
+/*! A small value type, returned by bound function
+ */
+struct BenchmarkVector
+{
+    /*! X coordinate
+     */
+    double X;
+    /*! Y coordinate
+     */
+    double Y;
+};
+
+static BenchmarkVector make_vector(double x)
+{
+    BenchmarkVector result;
+    result.X = x;
+    result.Y = x + 1;
+    return result;
+}
+
+void benchmarkVariantPool()
+{
+    benchmark::group("Returning small struct from native function (100000 calls per op)");
+
+    dukpp03::context::Context ctx;
+    ctx.registerCallable("makeVector", mkf::from(make_vector));
+    ctx.eval("function loop(n) { var v; for(var i = 0; i < n; i++) { v = makeVector(i); } return 0; }");
+
+    benchmark::run("return struct, 1M calls total", 10, [&ctx](long) {
+        ctx.callGlobalFunction("loop", 100000.0);
+        duk_pop(ctx.context());
+    });
+}
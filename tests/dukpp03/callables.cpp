@@ -5,6 +5,8 @@
 #include "context.h"
 #include "point.h"
 #include <iostream>
+#include <new>
+#include <thread>
 #define _INC_STDIO
 #include "include/3rdparty/tpunit++/tpunit++.hpp"
 #pragma warning(pop)
@@ -67,6 +69,159 @@ Point make()
     return Point(2,3);
 }
 
+int overload_char(char)
+{
+    return 1;
+}
+
+int overload_string(std::string)
+{
+    return 2;
+}
+
+int overload_number(double)
+{
+    return 3;
+}
+
+/*! A value, pushed as variant of other type, than point
+ */
+struct Box
+{
+    int Value;
+};
+
+Box make_box()
+{
+    Box b;
+    b.Value = 7;
+    return b;
+}
+
+int overload_point(Point* p)
+{
+    return p->x();
+}
+
+int overload_box(Box* b)
+{
+    return b->Value * 10;
+}
+
+/*! An overload, which counts checks, whether it could be called
+ */
+class CountedOverload: public dukpp03::Callable<dukpp03::context::Context>
+{
+public:
+    CountedOverload(dukpp03::Callable<dukpp03::context::Context>* c, int* checks) : m_c(c), m_checks(checks)
+    {
+
+    }
+
+    virtual ~CountedOverload() override
+    {
+        delete m_c;
+    }
+
+    virtual dukpp03::Callable<dukpp03::context::Context>* clone() override
+    {
+        return new CountedOverload(m_c->clone(), m_checks);
+    }
+
+    virtual bool canBeCalledAsConstructor() override
+    {
+        return m_c->canBeCalledAsConstructor();
+    }
+
+    virtual bool canBeCalledAsFunction() override
+    {
+        return m_c->canBeCalledAsFunction();
+    }
+
+    virtual int requiredArguments() override
+    {
+        return m_c->requiredArguments();
+    }
+
+    virtual std::pair<int, bool> canBeCalled(dukpp03::context::Context* c) override
+    {
+        ++(*m_checks);
+        return m_c->canBeCalled(c);
+    }
+
+    virtual int call(dukpp03::context::Context* c) override
+    {
+        return m_c->call(c);
+    }
+private:
+    dukpp03::Callable<dukpp03::context::Context>* m_c;
+    int* m_checks;
+};
+
+double sum_vector(const std::vector<double>& v)
+{
+    double result = 0;
+    for(size_t i = 0; i < v.size(); i++)
+    {
+        result += v[i];
+    }
+    return result;
+}
+
+std::vector<int> reverse_vector(std::vector<int> v)
+{
+    return std::vector<int>(v.rbegin(), v.rend());
+}
+
+std::array<int, 3> rotate_array(const std::array<int, 3>& a)
+{
+    std::array<int, 3> result = {{ a[1], a[2], a[0] }};
+    return result;
+}
+
+std::map<std::string, int> double_map(const std::map<std::string, int>& m)
+{
+    std::map<std::string, int> result;
+    for(std::map<std::string, int>::const_iterator it = m.begin(); it != m.end(); ++it)
+    {
+        result[it->first] = it->second * 2;
+    }
+    return result;
+}
+
+long long negate_long(long long v)
+{
+    return -v;
+}
+
+unsigned int next_uint(unsigned int v)
+{
+    return v + 1;
+}
+
+dukpp03::ExactInt64 next_exact(dukpp03::ExactInt64 v)
+{
+    return dukpp03::ExactInt64(v.value() + 1);
+}
+
+dukpp03::ExactUInt64 twice_exact(dukpp03::ExactUInt64 v)
+{
+    return dukpp03::ExactUInt64(v.value() * 2);
+}
+
+std::unordered_map<std::string, std::vector<std::string> > split_map(const std::unordered_map<std::string, std::string>& m)
+{
+    std::unordered_map<std::string, std::vector<std::string> > result;
+    for(std::unordered_map<std::string, std::string>::const_iterator it = m.begin(); it != m.end(); ++it)
+    {
+        for(size_t i = 0; i < it->second.size(); i++)
+        {
+            result[it->first].push_back(std::string(1, it->second[i]));
+        }
+    }
+    return result;
+}
+
 struct CallablesTest : tpunit::TestFixture
 {
 public:
@@ -85,6 +240,9 @@ public:
        TEST(CallablesTest::testCompiledFunction),
        TEST(CallablesTest::testCompiledFunction2),
        TEST(CallablesTest::testCompiledFunction3),
+       TEST(CallablesTest::testCompiledFunctionMaterialization),
+       TEST(CallablesTest::testCompiledFunctionInSeveralContexts),
+       TEST(CallablesTest::testReleasingPinnedValues),
        TEST(CallablesTest::testGetterSetter),
        TEST(CallablesTest::testClassBindings),
        TEST(CallablesTest::testRebindMethods),
@@ -93,6 +251,14 @@ public:
        TEST(CallablesTest::testBetterInheritance),
        TEST(CallablesTest::testNativeFunctionPrototype),
        TEST(CallablesTest::wrapValuePrototype),
+       TEST(CallablesTest::testSharedPrototype),
+       TEST(CallablesTest::testParentBindingInReusedContext),
+       TEST(CallablesTest::testSharedPrototypeAfterReset),
+       TEST(CallablesTest::testSharedPrototypeRemoval),
+       TEST(CallablesTest::testOverloadCache),
+       TEST(CallablesTest::testOverloadCacheForObjects),
+       TEST(CallablesTest::testInvalidArguments),
+       TEST(CallablesTest::testContextTemplate),
 #ifdef TEST_LAMBDA
        TEST(CallablesTest::testLambda),
 #endif 
@@ -104,7 +270,9 @@ public:
        TEST(CallablesTest::testCallGlobal5),
        TEST(CallablesTest::testCallGlobal6),
        TEST(CallablesTest::testCallGlobal7),
-       TEST(CallablesTest::testCallGlobal8)
+       TEST(CallablesTest::testCallGlobal8),
+       TEST(CallablesTest::testContainers),
+       TEST(CallablesTest::testIntegers)
     ) {}
 
      /*! Tests registering functions
@@ -438,6 +606,125 @@ public:
         ASSERT_TRUE(data.exists());
     }
     
+    void testCompiledFunctionMaterialization()
+    {
+        std::string error;  
+        
+        dukpp03::context::Context ctx;
+        ctx.registerCallable("setFunction", mkf::from(set_func));
+
+        bool eval_result = ctx.eval(" var f = function(a) { return a + 1; }; f.tag = 2; setFunction(f); ", true,  &error);
+        if (!eval_result)
+        {
+            std::cout << error << "\n";
+        }
+        ASSERT_TRUE( eval_result );
+        ASSERT_TRUE( func.valid() );
+        // Stored function must be the same live object, not a deserialized copy
+        func.pushMeOnStack(&ctx);
+        duk_get_prop_string(ctx.context(), -1, "tag");
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 2 );
+        ctx.cleanStack();
+
+        compiledfunc copy = func;
+        for(int i = 0; i < 3; i++)
+        {
+            dukpp03::PushValue<int, dukpp03::context::Context>::perform(&ctx, i);
+            ASSERT_TRUE( copy.call(&ctx) == 1 );
+            dukpp03::Maybe<int> result = dukpp03::GetValue<int, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( result.value() == i + 1 );
+            ctx.cleanStack();
+        }
+
+        // Function, taken from stack, is not dumped to bytecode, until it's cloned
+        compiledfunc uncloned = func;
+        delete copy.clone();
+        // After reset cloned function is restored from bytecode, while other one is lost with context
+        ctx.reset();
+        ASSERT_FALSE( uncloned.valid() );
+        dukpp03::PushValue<int, dukpp03::context::Context>::perform(&ctx, 10);
+        ASSERT_TRUE( copy.call(&ctx) == 1 );
+        dukpp03::Maybe<int> result = dukpp03::GetValue<int, dukpp03::context::Context>::perform(&ctx, -1);
+        ASSERT_TRUE( result.exists() );
+        ASSERT_TRUE( result.value() == 11 );
+        ctx.cleanStack();
+    }
+
+    void testCompiledFunctionInSeveralContexts()
+    {
+        std::string error;
+
+        dukpp03::context::Context ctx1;
+        dukpp03::context::Context ctx2;
+        ASSERT_TRUE( ctx1.eval(" var f = function(a) { return a + 1; }; f.tag = 2; f ", false,  &error) );
+        void* live = duk_get_heapptr(ctx1.context(), -1);
+        dukpp03::Maybe<compiledfunc> f = dukpp03::GetValue<compiledfunc, dukpp03::context::Context>::perform(&ctx1, -1);
+        ASSERT_TRUE( f.exists() );
+        ctx1.cleanStack();
+        compiledfunc copy = f.value();
+
+        copy.pushMeOnStack(&ctx2);
+        void* loaded = duk_get_heapptr(ctx2.context(), -1);
+        ctx2.cleanStack();
+        // Each context keeps it's own function, so alternating contexts neither reloads nor loses it
+        for(int i = 0; i < 3; i++)
+        {
+            copy.pushMeOnStack(&ctx1);
+            ASSERT_TRUE( duk_get_heapptr(ctx1.context(), -1) == live );
+            duk_get_prop_string(ctx1.context(), -1, "tag");
+            ASSERT_TRUE( duk_get_int(ctx1.context(), -1) == 2 );
+            ctx1.cleanStack();
+
+            copy.pushMeOnStack(&ctx2);
+            ASSERT_TRUE( duk_get_heapptr(ctx2.context(), -1) == loaded );
+            ctx2.cleanStack();
+        }
+
+        dukpp03::PushValue<int, dukpp03::context::Context>::perform(&ctx2, 4);
+        compiledfunc original = f.value();
+        ASSERT_TRUE( original.call(&ctx2) == 1 );
+        dukpp03::Maybe<int> result = dukpp03::GetValue<int, dukpp03::context::Context>::perform(&ctx2, -1);
+        ASSERT_TRUE( result.exists() );
+        ASSERT_TRUE( result.value() == 5 );
+        ctx2.cleanStack();
+    }
+
+    void testReleasingPinnedValues()
+    {
+        dukpp03::context::Context ctx;
+        duk_context* c = ctx.context();
+        dukpp03::PinnedValue* values[3];
+        for(int i = 0; i < 3; i++)
+        {
+            duk_push_object(c);
+            duk_push_int(c, i);
+            duk_put_prop_string(c, -2, "tag");
+            values[i] = ctx.pin(-1);
+            ctx.cleanStack();
+        }
+        // Releasing handle from other thread must not touch heap and must keep other handles of context valid
+        std::thread releaser([&values]() { values[0]->delRef(); });
+        releaser.join();
+        for(int i = 1; i < 3; i++)
+        {
+            ASSERT_TRUE( values[i]->context() == &ctx );
+            ASSERT_TRUE( values[i]->push() );
+            duk_get_prop_string(c, -1, "tag");
+            ASSERT_TRUE( duk_get_int(c, -1) == i );
+            ctx.cleanStack();
+        }
+        // Released value is removed from heap stash by context on next evaluation
+        std::string error;
+        ASSERT_TRUE( ctx.eval("1", true, &error) );
+        duk_push_heap_stash(c);
+        ASSERT_TRUE( duk_has_prop_index(c, -1, 0) == 0 );
+        ASSERT_TRUE( duk_has_prop_index(c, -1, 1) != 0 );
+        ctx.cleanStack();
+        values[2]->delRef();
+        values[1]->delRef();
+    }
+
     void testGetterSetter()
     {
         std::string error;  
@@ -727,6 +1014,296 @@ public:
         }
     }
 
+    void testSharedPrototype()
+    {
+        std::string error;  
+        
+        dukpp03::context::Context ctx;
+        ClassBinding* c = new ClassBinding();
+        c->addConstructor<Point>("Point");
+        c->addConstructor<Point, int, int>("Point");
+        c->addMethod("x",  bnd::from(&Point::x));
+        c->addMethod("setX",  bnd::from(&Point::setX));
+
+        c->addMethod("y",  bnd::from(&Point::y));
+        c->addMethod("setY",  bnd::from(&Point::setY));
+        
+        c->addAccessor("m_x", getter::from(&Point::m_x), setter::from(&Point::m_x));
+        c->addAccessor("m_y", getter::from(&Point::m_y), setter::from(&Point::m_y));
+        c->setSharedPrototype(true);
+
+        ctx.registerCallable("make", mkf::from(make));
+        ctx.addClassBinding(ctx.typeName<Point>(), c);
+        
+        {
+            bool eval_result = ctx.eval(" var a = new Point(20, 0); a.setX(a.x() + 40); a.m_y = 60; a.m_x + a.y() ", false,  &error);
+            if (!eval_result)
+            {
+                std::cout << error << "\n";
+            }
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<double> result = dukpp03::GetValue<double, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( is_fuzzy_equal(result.value(), 120) );
+        }
+        {
+            bool eval_result = ctx.eval(" var a = new Point(); var b = make(); (Object.getPrototypeOf(a) === Object.getPrototypeOf(b)) && !a.hasOwnProperty('x') && (a.x === b.x) ", false,  &error);
+            if (!eval_result)
+            {
+                std::cout << error << "\n";
+            }
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<bool> result = dukpp03::GetValue<bool, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( result.value() );
+        }
+        {
+            bool eval_result = ctx.eval(" Point.prototype.f = function() { return 120; }; make().f() + (new Point()).f() ", false,  &error);
+            if (!eval_result)
+            {
+                std::cout << error << "\n";
+            }
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<double> result = dukpp03::GetValue<double, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( is_fuzzy_equal(result.value(), 240) );
+        }
+    }
+
+    void testParentBindingInReusedContext()
+    {
+        ClassBinding parent;
+        parent.addMethod("x",  bnd::from(&Point::x));
+        // Contexts are created at the same address, so keys, cached for first one, must not be used for second one
+        alignas(dukpp03::context::Context) unsigned char storage[sizeof(dukpp03::context::Context)];
+        for(int i = 0; i < 2; i++)
+        {
+            dukpp03::context::Context* ctx = new (storage) dukpp03::context::Context();
+            if (i == 1)
+            {
+                ctx->internKey("somethingElse");
+            }
+            ClassBinding* c = new ClassBinding();
+            c->addParentBinding(&parent);
+            ctx->registerCallable("make", mkf::from(make));
+            ctx->addClassBinding(ctx->typeName<Point>(), c);
+            ASSERT_TRUE( ctx->eval("var p = make(); p.x() == 2 && p.somethingElse === undefined", false) );
+            ASSERT_TRUE( duk_get_boolean(ctx->context(), -1) != 0 );
+            ctx->~Context();
+        }
+    }
+
+    void testSharedPrototypeAfterReset()
+    {
+        ClassBinding parent;
+        parent.addMethod("x",  bnd::from(&Point::x));
+        parent.setSharedPrototype(true);
+
+        dukpp03::context::Context ctx;
+        for(int i = 0; i < 2; i++)
+        {
+            // Reset destroys heap with prototype of parent, so it must be created again
+            ClassBinding* c = new ClassBinding();
+            c->addParentBinding(&parent);
+            c->addMethod("y",  bnd::from(&Point::y));
+            ctx.registerCallable("make", mkf::from(make));
+            ctx.addClassBinding(ctx.typeName<Point>(), c);
+            ASSERT_TRUE( ctx.eval("var p = make(); p.x() + p.y()", false) );
+            ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 5 );
+            ctx.cleanStack();
+            ctx.reset();
+        }
+
+        // Methods, added after binding was used, appear in new prototype
+        ClassBinding* c = new ClassBinding();
+        c->addParentBinding(&parent);
+        ctx.registerCallable("make", mkf::from(make));
+        ctx.addClassBinding(ctx.typeName<Point>(), c);
+        ASSERT_TRUE( ctx.eval("make().y === undefined", false) );
+        ASSERT_TRUE( duk_get_boolean(ctx.context(), -1) != 0 );
+        ctx.cleanStack();
+        parent.addMethod("y",  bnd::from(&Point::y));
+        ASSERT_TRUE( ctx.eval("make().y()", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 3 );
+        ctx.cleanStack();
+    }
+
+    static int countSharedPrototypes(dukpp03::context::Context& ctx)
+    {
+        duk_context* c = ctx.context();
+        const std::string prefix = "\1dukpp03::ClassBinding::prototype\1";
+        int result = 0;
+        duk_push_heap_stash(c);
+        duk_enum(c, -1, DUK_ENUM_OWN_PROPERTIES_ONLY);
+        while(duk_next(c, -1, 0))
+        {
+            if (std::string(duk_get_string(c, -1)).compare(0, prefix.size(), prefix) == 0)
+            {
+                ++result;
+            }
+            duk_pop(c);
+        }
+        duk_pop_2(c);
+        return result;
+    }
+
+    void testSharedPrototypeRemoval()
+    {
+        dukpp03::context::Context ctx;
+        ClassBinding* c = new ClassBinding();
+        c->addMethod("x",  bnd::from(&Point::x));
+        c->setSharedPrototype(true);
+        ctx.registerCallable("make", mkf::from(make));
+        ctx.addClassBinding(ctx.typeName<Point>(), c);
+        ASSERT_TRUE( ctx.eval("make().x()", false) );
+        ctx.cleanStack();
+        // Changed binding rebuilds prototype, replacing old one
+        c->addMethod("y",  bnd::from(&Point::y));
+        ASSERT_TRUE( ctx.eval("make().x() + make().y()", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 5 );
+        ctx.cleanStack();
+        c->setPrototypeFunction("Object.prototype");
+        ASSERT_TRUE( ctx.eval("make().y()", false) );
+        ctx.cleanStack();
+        ASSERT_TRUE( countSharedPrototypes(ctx) == 1 );
+
+        ctx.removeClassBinding(ctx.typeName<Point>());
+        ASSERT_TRUE( countSharedPrototypes(ctx) == 0 );
+    }
+
+    void testOverloadCache()
+    {
+        std::string error;  
+        
+        dukpp03::context::Context ctx;
+        dukpp03::MultiMethod<dukpp03::context::Context>* m = new dukpp03::MultiMethod<dukpp03::context::Context>();
+        m->add(mkf::from(overload_char));
+        m->add(mkf::from(overload_string));
+        ctx.registerCallable("f", m);
+
+        dukpp03::MultiMethod<dukpp03::context::Context>* m2 = new dukpp03::MultiMethod<dukpp03::context::Context>();
+        m2->add(mkf::from(overload_string));
+        m2->add(mkf::from(overload_number));
+        ctx.registerCallable("g", m2);
+
+        dukpp03::MultiMethod<dukpp03::context::Context>* m3 = new dukpp03::MultiMethod<dukpp03::context::Context>();
+        m3->add(mkf::from(overload_char));
+        m3->add(mkf::from(overload_string));
+        ctx.registerCallable("h", m3);
+        
+        {
+            // Same shape of call, but different value must still select different overloads
+            bool eval_result = ctx.eval(" var s = 0; for(var i = 0; i < 10; i++) { s += f('a') + f('ab') * 10 + f('b') * 100; } s ", false,  &error);
+            if (!eval_result)
+            {
+                std::cout << error << "\n";
+            }
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<double> result = dukpp03::GetValue<double, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( is_fuzzy_equal(result.value(), 1210) );
+        }
+        {
+            bool eval_result = ctx.eval(" var s = 0; for(var i = 0; i < 10; i++) { s += g('a') + g(1) * 10; } s ", false,  &error);
+            if (!eval_result)
+            {
+                std::cout << error << "\n";
+            }
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<double> result = dukpp03::GetValue<double, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( is_fuzzy_equal(result.value(), 320) );
+        }
+        {
+            // Overload, resolved for longer string first, must not be taken for character
+            bool eval_result = ctx.eval(" var s = 0; for(var i = 0; i < 10; i++) { s += h('ab') * 10 + h('a'); } s ", false,  &error);
+            if (!eval_result)
+            {
+                std::cout << error << "\n";
+            }
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<double> result = dukpp03::GetValue<double, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( is_fuzzy_equal(result.value(), 210) );
+        }
+    }
+
+    void testOverloadCacheForObjects()
+    {
+        std::string error;
+        int checks = 0;
+
+        dukpp03::context::Context ctx;
+        ClassBinding* c = new ClassBinding();
+        c->addConstructor("Point", new CountedOverload(new dukpp03::Constructor2<dukpp03::context::Context, Point, int, int>(), &checks));
+        c->addConstructor("Point", new CountedOverload(new dukpp03::Constructor2<dukpp03::context::Context, Point, std::string, std::string>(), &checks));
+        c->addMethod("set", new CountedOverload(bnd::from(&Point::setX), &checks));
+        c->addMethod("set", new CountedOverload(bnd::from(&Point::setXS), &checks));
+        c->addMethod("x",  bnd::from(&Point::x));
+        ctx.addClassBinding(ctx.typeName<Point>(), c);
+
+        dukpp03::MultiMethod<dukpp03::context::Context>* m = new dukpp03::MultiMethod<dukpp03::context::Context>();
+        m->add(new CountedOverload(mkf::from(overload_point), &checks));
+        m->add(new CountedOverload(mkf::from(overload_box), &checks));
+        ctx.registerCallable("f", m);
+        ctx.registerCallable("box", mkf::from(make_box));
+
+        // Constructor calls and calls on bound objects are resolved once per shape and type of variant
+        const char* script = " var s = 0; for(var i = 0; i < 10; i++) { var p = new Point(1, 2); var q = new Point('3', '4'); p.set(5); q.set('6'); s += p.x() + q.x() + f(p) + f(box()); } s ";
+        bool eval_result = ctx.eval(script, false,  &error);
+        if (!eval_result)
+        {
+            std::cout << error << "\n";
+        }
+        ASSERT_TRUE( eval_result );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 10 * (5 + 6 + 5 + 70) );
+        ctx.cleanStack();
+        ASSERT_TRUE( checks == 3 * 2 * 2 );
+
+        // Plain objects are not described by key, so overloads are checked on every call
+        checks = 0;
+        eval_result = ctx.eval(" var r = 0; for(var i = 0; i < 10; i++) { try { f({}); } catch(e) { r += 1; } } r ", false,  &error);
+        ASSERT_TRUE( eval_result );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 10 );
+        ctx.cleanStack();
+        ASSERT_TRUE( checks == 10 * 2 );
+    }
+
+    void testInvalidArguments()
+    {
+        std::string error;  
+        
+        dukpp03::context::Context ctx;
+        ClassBinding* c = new ClassBinding();
+        c->addConstructor<Point, int, int>("Point");
+        c->addMethod("x",  bnd::from(&Point::x));
+        ctx.addClassBinding(ctx.typeName<Point>(), c);
+        ctx.registerCallable("f", mkf::from(return_number_1));
+        
+        {
+            bool eval_result = ctx.eval(" var r = 0; try { f({}); } catch(e) { if ((e instanceof TypeError) && e.message.indexOf('argument #1') != -1) r += 1; } r ", false,  &error);
+            if (!eval_result)
+            {
+                std::cout << error << "\n";
+            }
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<double> result = dukpp03::GetValue<double, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( is_fuzzy_equal(result.value(), 1) );
+        }
+        {
+            bool eval_result = ctx.eval(" var r = 0; var p = new Point(1, 2); try { p.x.call({}); } catch(e) { if ((e instanceof TypeError) && e.message.indexOf('as this') != -1) r += 1; } r + p.x() ", false,  &error);
+            if (!eval_result)
+            {
+                std::cout << error << "\n";
+            }
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<double> result = dukpp03::GetValue<double, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( is_fuzzy_equal(result.value(), 2) );
+        }
+    }
+
 #ifdef TEST_LAMBDA    
     void testLambda()
     {
@@ -752,6 +1329,49 @@ public:
     }
 #endif
 
+    void testContextTemplate()
+    {
+        std::string error;
+
+        dukpp03::ContextTemplate<dukpp03::context::Context> t;
+        ClassBinding* c = new ClassBinding();
+        c->addConstructor<Point, int, int>("Point");
+        c->addMethod("x",  bnd::from(&Point::x));
+        c->addMethod("setX",  bnd::from(&Point::setX));
+        t.addClassBinding<Point>(c);
+        t.registerCallable("make", mkf::from(make));
+        t.registerGlobal("offset", 3);
+        ASSERT_TRUE( t.addScript("var counter = 0; function shift(p) { counter++; p.setX(p.x() + 3); return p; }", "bootstrap.js", &error) );
+        ASSERT_FALSE( t.addScript("var = ;", "broken.js", &error) );
+        ASSERT_TRUE( t.size() == 4 );
+
+        for(int i = 0; i < 2; i++)
+        {
+            dukpp03::context::Context* ctx = t.create(&error);
+            ASSERT_TRUE( ctx != nullptr );
+            // Each context has own state
+            bool eval_result = ctx->eval(" shift(new Point(1, 2)).x() + shift(make()).x() + counter ", false,  &error);
+            if (!eval_result)
+            {
+                std::cout << error << "\n";
+            }
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<int> result = dukpp03::GetValue<int, dukpp03::context::Context>::perform(ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( result.value() == 4 + 5 + 2 );
+            ctx->cleanStack();
+            ASSERT_TRUE( ctx->getGlobal<int>("offset").value() == 3 );
+
+            ASSERT_TRUE( t.reset(ctx, &error) );
+            eval_result = ctx->eval(" counter ", false,  &error);
+            ASSERT_TRUE( eval_result );
+            result = dukpp03::GetValue<int, dukpp03::context::Context>::perform(ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( result.value() == 0 );
+            delete ctx;
+        }
+    }
+
     void testCallGlobal0()
     {
         std::string error;  
@@ -896,4 +1516,83 @@ public:
         ASSERT_TRUE( result.value() == "12345678" );
     }
 
+    void testContainers()
+    {
+        dukpp03::context::Context ctx;
+        ctx.registerCallable("sum", mkf::from(sum_vector));
+        ctx.registerCallable("reverse", mkf::from(reverse_vector));
+        ctx.registerCallable("rotate", mkf::from(rotate_array));
+        ctx.registerCallable("doubled", mkf::from(double_map));
+        ctx.registerCallable("split", mkf::from(split_map));
+
+        // Typed arrays of the same type are copied at once, other ones are converted element by element
+        ASSERT_TRUE( ctx.eval("sum([1, 2, 3.5]) + sum(new Float64Array([10, 20])) + sum(new Int8Array([-1, 100])) + sum([])", false) );
+        ASSERT_TRUE( duk_get_number(ctx.context(), -1) == 135.5 );
+        ctx.cleanStack();
+
+        ASSERT_TRUE( ctx.eval("var r = reverse(new Int32Array([1, 2, 3])); Array.isArray(r) && r.join(',') == '3,2,1' && reverse([4, 5]).join(',') == '5,4'", false) );
+        ASSERT_TRUE( duk_get_boolean(ctx.context(), -1) != 0 );
+        ctx.cleanStack();
+
+        ASSERT_TRUE( ctx.eval("rotate([1, 2, 3]).join(',')", false) );
+        ASSERT_TRUE( std::string(duk_get_string(ctx.context(), -1)) == "2,3,1" );
+        ctx.cleanStack();
+
+        ASSERT_TRUE( ctx.eval("var m = doubled({ a: 1, b: 2 }); var s = split({ x: 'ab' }); m.a + m.b * 10 + s.x.length * 100 + (s.x[1] == 'b' ? 1000 : 0)", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 1242 );
+        ctx.cleanStack();
+
+        // Invalid elements, wrong length of array and non-arrays are rejected
+        ASSERT_TRUE( ctx.eval("var r = 0; try { sum([1, 'a']); } catch(e) { if (e instanceof TypeError) r += 1; } "
+                              "try { rotate([1, 2]); } catch(e) { if (e instanceof TypeError) r += 1; } "
+                              "try { sum(new ArrayBuffer(8)); } catch(e) { if (e instanceof TypeError) r += 1; } "
+                              "try { doubled({ a: 'b' }); } catch(e) { if (e instanceof TypeError) r += 1; } r", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 4 );
+        ctx.cleanStack();
+    }
+
+    void testIntegers()
+    {
+        dukpp03::context::Context ctx;
+        ctx.registerCallable("negate", mkf::from(negate_long));
+        ctx.registerCallable("nextUInt", mkf::from(next_uint));
+        ctx.registerCallable("nextExact", mkf::from(next_exact));
+        ctx.registerCallable("twiceExact", mkf::from(twice_exact));
+
+        // 64-bit integers are exact up to 2^53, unsigned ones are not wrapped around 2^31
+        ASSERT_TRUE( ctx.eval("negate(1099511627776) == -1099511627776 && negate(-9007199254740991) == 9007199254740991 && nextUInt(4294967294) == 4294967295", false) );
+        ASSERT_TRUE( duk_get_boolean(ctx.context(), -1) != 0 );
+        ctx.cleanStack();
+
+        // Numbers out of range are clamped
+        ASSERT_TRUE( ctx.eval("negate(1e300)", false) );
+        ASSERT_TRUE( duk_get_number(ctx.context(), -1) == -9223372036854775807.0 );
+        ctx.cleanStack();
+
+        // Exact integers beyond 2^53 are passed as decimal strings
+        ASSERT_TRUE( ctx.eval("nextExact(1099511627776) === 1099511627777 && nextExact(9007199254740991) === '9007199254740992' "
+                              "&& nextExact('9223372036854775806') === '9223372036854775807' && nextExact('-9223372036854775808') === '-9223372036854775807'", false) );
+        ASSERT_TRUE( duk_get_boolean(ctx.context(), -1) != 0 );
+        ctx.cleanStack();
+
+        ASSERT_TRUE( ctx.eval("twiceExact('9223372036854775807')", false) );
+        ASSERT_TRUE( std::string(duk_get_string(ctx.context(), -1)) == "18446744073709551614" );
+        ctx.cleanStack();
+
+        dukpp03::PushValue<dukpp03::ExactUInt64, dukpp03::context::Context>::perform(&ctx, dukpp03::ExactUInt64(18446744073709551615ULL));
+        dukpp03::Maybe<dukpp03::ExactUInt64> max = dukpp03::GetValue<dukpp03::ExactUInt64, dukpp03::context::Context>::perform(&ctx, -1);
+        ASSERT_TRUE( max.exists() );
+        ASSERT_TRUE( max.value().value() == 18446744073709551615ULL );
+        ctx.cleanStack();
+
+        // Inexact numbers, malformed strings and values out of range are rejected
+        ASSERT_TRUE( ctx.eval("var r = 0; try { nextExact(1.5); } catch(e) { if (e instanceof TypeError) r += 1; } "
+                              "try { nextExact(1e300); } catch(e) { if (e instanceof TypeError) r += 1; } "
+                              "try { nextExact('12a'); } catch(e) { if (e instanceof TypeError) r += 1; } "
+                              "try { nextExact('9223372036854775808'); } catch(e) { if (e instanceof TypeError) r += 1; } "
+                              "try { twiceExact(-1); } catch(e) { if (e instanceof TypeError) r += 1; } r", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 5 );
+        ctx.cleanStack();
+    }
+
 } _callables_test;
\ No newline at end of file
@@ -5,7 +5,13 @@
 #include "context.h"
 #include "callable.h"
 #include "point.h"
+#include "contextpool.h"
+#include "scriptexecutor.h"
+#include "gcscheduler.h"
 #include <iostream>
+#include <thread>
+#include <chrono>
+#include <new>
 #define _INC_STDIO
 #include "include/3rdparty/tpunit++/tpunit++.hpp"
 #pragma warning(pop)
@@ -186,6 +192,129 @@ public:
     }
 };
 
+/*! Returns length of borrowed string
+    \param[in] s string
+    \return length
+ */
+static int string_ref_length(dukpp03::StringRef s)
+{
+    return static_cast<int>(s.size());
+}
+
+/*! Returns code of character
+    \param[in] c character
+    \return code
+ */
+static int character_code(char c)
+{
+    return static_cast<int>(c);
+}
+
+#ifdef DUKPP03_HAS_STRING_VIEW
+
+/*! Returns whether view contains only letter "a"
+    \param[in] s string
+    \return whether string contains only "a"
+ */
+static bool string_view_is_a(std::string_view s)
+{
+    return s.find_first_not_of('a') == std::string_view::npos;
+}
+
+#endif
+
+/*! Returns sum of elements
+    \param[in] v elements
+    \return sum
+ */
+static double sum_floats(dukpp03::BufferView<float> v)
+{
+    double result = 0;
+    for(size_t i = 0; i < v.size(); i++)
+    {
+        result += v[i];
+    }
+    return result;
+}
+
+/*! Fills bytes with value
+    \param[in] v bytes
+    \param[in] value a value
+ */
+static void fill_bytes(dukpp03::BufferView<unsigned char> v, int value)
+{
+    for(size_t i = 0; i < v.size(); i++)
+    {
+        v[i] = static_cast<unsigned char>(value);
+    }
+}
+
+/*! Makes buffer of integers 0, 1, ..., count - 1
+    \param[in] count amount of integers
+    \return buffer
+ */
+static dukpp03::VectorBuffer<int>* make_integers(int count)
+{
+    dukpp03::VectorBuffer<int>* result = new dukpp03::VectorBuffer<int>(count);
+    for(int i = 0; i < count; i++)
+    {
+        (*result)[i] = i;
+    }
+    return result;
+}
+
+/*! A buffer, which counts it's deletions
+ */
+class CountedBuffer: public dukpp03::VectorBuffer<unsigned char>
+{
+public:
+    /*! An amount of deleted buffers
+     */
+    static int Deleted;
+    /*! Constructs buffer
+        \param[in] count amount of bytes
+     */
+    CountedBuffer(size_t count) : dukpp03::VectorBuffer<unsigned char>(count)
+    {
+
+    }
+    /*! Counts deletion
+     */
+    virtual ~CountedBuffer() override
+    {
+        ++Deleted;
+    }
+};
+
+int CountedBuffer::Deleted = 0;
+
+/*! A nested part of payload
+ */
+struct PayloadHeader
+{
+    int Version;
+    bool Compressed;
+};
+
+/*! A payload, serialized via field map
+ */
+struct Payload
+{
+    PayloadHeader Header;
+    std::string Name;
+    std::vector<double> Values;
+};
+
+dukpp03::JSONText echo_json(const dukpp03::JSONText& text)
+{
+    return text;
+}
+
+dukpp03::CBORData echo_cbor(const dukpp03::CBORData& data)
+{
+    return data;
+}
+
 struct ContextTest : tpunit::TestFixture
 {
 public:
@@ -195,6 +324,9 @@ public:
        TEST(ContextTest::testEvalNormal),
        TEST(ContextTest::testEvalFail),
        TEST(ContextTest::testEvalTimeout),
+       TEST(ContextTest::testWatchdogTimeout),
+       TEST(ContextTest::testCallBudget),
+       TEST(ContextTest::testCancellation),
        TEST(ContextTest::testEvalAndGet),
        TEST(ContextTest::testReset),
        TEST(ContextTest::testThrow),
@@ -205,7 +337,27 @@ public:
        TEST(ContextTest::testPointConstructor),
        TEST(ContextTest::testGlobal),
        TEST(ContextTest::testEvalFilename),
-       TEST(ContextTest::testEvalFilename2)
+       TEST(ContextTest::testEvalFilename2),
+       TEST(ContextTest::testScriptCache),
+       TEST(ContextTest::testBundle),
+       TEST(ContextTest::testContextPool),
+       TEST(ContextTest::testContextPoolRestoresState),
+       TEST(ContextTest::testValue),
+       TEST(ContextTest::testScriptExecutor),
+       TEST(ContextTest::testPoolAllocator),
+       TEST(ContextTest::testMemoryQuota),
+       TEST(ContextTest::testGCScheduler),
+       TEST(ContextTest::testVariantPool),
+       TEST(ContextTest::testVariantRegistry),
+       TEST(ContextTest::testVariantKey),
+       TEST(ContextTest::testInternedKeys),
+       TEST(ContextTest::testCallableTable),
+       TEST(ContextTest::testStringArguments),
+       TEST(ContextTest::testBufferArguments),
+       TEST(ContextTest::testExternalBuffer),
+       TEST(ContextTest::testSerialization),
+       TEST(ContextTest::testFieldMap),
+       TEST(ContextTest::testFieldMapInReusedContext)
     ) {}
 
     /*! Tests getting and setting reference data
@@ -386,6 +538,85 @@ public:
         ASSERT_TRUE( !eval_result );
         ASSERT_TRUE( error.size() != 0 );
     }
+    /*! Test for timeout, tracked by watchdog
+     */
+    void testWatchdogTimeout()
+    {
+        std::string error;
+        dukpp03::Watchdog watchdog;
+        {
+            dukpp03::context::Context ctx;
+            ctx.setWatchdog(&watchdog);
+            ASSERT_TRUE( ctx.watchdog() == &watchdog );
+            ctx.setMaximumExecutionTime(200);
+            bool eval_result = ctx.eval("while(true) {}", true, &error);
+            ASSERT_TRUE( !eval_result );
+            ASSERT_TRUE( error.find("timeout") != std::string::npos );
+            ASSERT_TRUE( watchdog.armed() == 0 );
+            // Flag is cleared for next evaluation
+            eval_result = ctx.eval("var i = 0; for(var j = 0; j < 100000; j++) { i += j; }", true, &error);
+            ASSERT_TRUE( eval_result );
+            ASSERT_TRUE( watchdog.armed() == 0 );
+        }
+    }
+    /*! Test for budgets, applied to calls of functions outside of evaluation
+     */
+    void testCallBudget()
+    {
+        std::string error;
+        dukpp03::context::Context ctx;
+        ASSERT_TRUE( ctx.eval("function spin() { while(true) {} } function sum(a, b) { return a + b; }", true, &error) );
+        duk_context* c = ctx.context();
+
+        ctx.setMaximumInstructions(dukpp03::AbstractContext::InstructionsPerCheck * 4);
+        duk_get_global_string(c, "spin");
+        ASSERT_TRUE( ctx.pcall(0) == DUK_EXEC_ERROR );
+        ASSERT_TRUE( std::string(duk_safe_to_string(c, -1)).find("timeout") != std::string::npos );
+        ctx.cleanStack();
+
+        // Each call gets own budget
+        duk_get_global_string(c, "sum");
+        duk_push_int(c, 2);
+        duk_push_int(c, 3);
+        ASSERT_TRUE( ctx.pcall(2) == DUK_EXEC_SUCCESS );
+        ASSERT_TRUE( duk_get_int(c, -1) == 5 );
+        ctx.cleanStack();
+
+        ctx.setMaximumInstructions(0);
+        ctx.setMaximumExecutionTime(200);
+        duk_get_global_string(c, "spin");
+        ASSERT_TRUE( ctx.pcall(0) == DUK_EXEC_ERROR );
+        ctx.cleanStack();
+
+        // Compiled functions, called from native code, are bounded too
+        ASSERT_TRUE( ctx.eval("spin", false, &error) );
+        dukpp03::Maybe<dukpp03::CompiledFunction<dukpp03::context::Context> > f = dukpp03::GetValue<dukpp03::CompiledFunction<dukpp03::context::Context>, dukpp03::context::Context>::perform(&ctx, -1);
+        ASSERT_TRUE( f.exists() );
+        ctx.cleanStack();
+        ASSERT_TRUE( f.mutableValue().call(&ctx) == DUK_RET_TYPE_ERROR );
+        ctx.cleanStack();
+    }
+    /*! Test for cancelling evaluation from other thread
+     */
+    void testCancellation()
+    {
+        std::string error;
+        dukpp03::CancellationToken token;
+        dukpp03::context::Context ctx;
+        ctx.setCancellationToken(&token);
+        ASSERT_TRUE( ctx.cancellationToken() == &token );
+        std::thread canceller([&token]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            token.cancel();
+        });
+        bool eval_result = ctx.eval("while(true) {}", true, &error);
+        canceller.join();
+        ASSERT_TRUE( !eval_result );
+        ASSERT_TRUE( token.cancelled() );
+
+        token.reset();
+        ASSERT_TRUE( ctx.eval("1 + 1", true, &error) );
+    }
     /*! Test for evaluation and fetching value
      */
     void testEvalAndGet()
@@ -522,5 +753,747 @@ public:
         ASSERT_TRUE( result.exists() );
         ASSERT_TRUE( result.value() == 8 );
     }
+
+    void testScriptCache()
+    {
+        std::string error;
+        dukpp03::context::Context ctx;
+        ctx.eval("var counter = 0;");
+        for(int i = 0; i < 3; i++)
+        {
+            bool eval_result = ctx.eval("counter += 1; counter", "counter.js", false, &error);
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<int> result = dukpp03::GetValue<int, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( result.value() == i + 1 );
+            ctx.cleanStack();
+        }
+        ASSERT_TRUE( ctx.scriptCache().hits() == 2 );
+        ASSERT_TRUE( ctx.scriptCache().misses() == 1 );
+        ASSERT_TRUE( ctx.scriptCache().size() == 1 );
+        // Same source with other file name is other script
+        ASSERT_TRUE( ctx.eval("counter += 1; counter", std::string("counter2.js")) );
+        ASSERT_TRUE( ctx.scriptCache().size() == 2 );
+        ASSERT_TRUE( ctx.scriptCache().misses() == 2 );
+
+        // Memory limit evicts least recently used scripts
+        size_t usage = ctx.scriptCache().memoryUsage();
+        ctx.scriptCache().setMemoryLimit(usage - 1);
+        ASSERT_TRUE( ctx.scriptCache().size() == 1 );
+        ASSERT_TRUE( ctx.scriptCache().memoryUsage() <= usage - 1 );
+
+        ctx.reset();
+        ASSERT_TRUE( ctx.scriptCache().size() == 0 );
+        ASSERT_TRUE( ctx.scriptCache().memoryUsage() == 0 );
+        bool eval_result = ctx.eval("typeof counter", "counter.js", false, &error);
+        ASSERT_TRUE( eval_result );
+        dukpp03::Maybe<std::string> type = dukpp03::GetValue<std::string, dukpp03::context::Context>::perform(&ctx, -1);
+        ASSERT_TRUE( type.exists() );
+        ASSERT_TRUE( type.value() == "undefined" );
+    }
+
+    void testBundle()
+    {
+        std::string error;
+        const std::string path = "bundle_test.bundle";
+        std::vector<dukpp03::Bundle::Source> sources;
+        sources.push_back(dukpp03::Bundle::Source("lib.js", "var a = 5; function f(x) { return x + a; }"));
+        sources.push_back(dukpp03::Bundle::Source("main.js", "var b = f(2);"));
+        ASSERT_TRUE( dukpp03::Bundle::write(path, sources, &error) );
+
+        dukpp03::context::Context ctx;
+        ASSERT_TRUE( ctx.loadBundle(path, &error) );
+        bool eval_result = ctx.eval("b + f(3)", false, &error);
+        ASSERT_TRUE( eval_result );
+        dukpp03::Maybe<int> result = dukpp03::GetValue<int, dukpp03::context::Context>::perform(&ctx, -1);
+        ASSERT_TRUE( result.exists() );
+        ASSERT_TRUE( result.value() == 15 );
+        ctx.cleanStack();
+
+        // Corrupted bundle should be rejected
+        FILE* file = fopen(path.c_str(), "r+b");
+        ASSERT_TRUE( file != nullptr );
+        fseek(file, -1, SEEK_END);
+        int last = fgetc(file);
+        fseek(file, -1, SEEK_END);
+        fputc(last ^ 0xFF, file);
+        fclose(file);
+        dukpp03::context::Context ctx2;
+        ASSERT_FALSE( ctx2.loadBundle(path, &error) );
+        ASSERT_TRUE( error.size() != 0 );
+        ASSERT_FALSE( ctx2.loadBundle("non_existing.bundle", &error) );
+        remove(path.c_str());
+
+        // Errors in source are reported, when writing a bundle
+        sources.push_back(dukpp03::Bundle::Source("broken.js", "var = ;"));
+        ASSERT_FALSE( dukpp03::Bundle::write(path, sources, &error) );
+        ASSERT_TRUE( error.size() != 0 );
+    }
+
+    void testContextPool()
+    {
+        std::string error;
+        dukpp03::ContextTemplate<dukpp03::context::Context> t;
+        ASSERT_TRUE( t.addScript("var base = 10; function get() { return base; }", "base.js", &error) );
+        dukpp03::ContextPool<dukpp03::context::Context> pool(2, &t);
+        ASSERT_TRUE( pool.size() == 2 );
+
+        dukpp03::context::Context* ctx = pool.borrow();
+        ASSERT_TRUE( pool.available() == 1 );
+        ASSERT_TRUE( ctx->eval("base = 20; var leaked = 1; Math = null; delete get; ", true, &error) );
+        ctx->pushObject();
+        pool.giveBack(ctx);
+        ASSERT_TRUE( ctx->getTop() == 0 );
+
+        ctx = pool.borrow();
+        dukpp03::context::Context* other = pool.tryBorrow();
+        ASSERT_TRUE( other != nullptr );
+        ASSERT_TRUE( pool.tryBorrow() == nullptr );
+        pool.giveBack(other);
+        bool eval_result = ctx->eval("get() + (typeof leaked) + Math.abs(-1)", false, &error);
+        ASSERT_TRUE( eval_result );
+        dukpp03::Maybe<std::string> result = dukpp03::GetValue<std::string, dukpp03::context::Context>::perform(ctx, -1);
+        ASSERT_TRUE( result.exists() );
+        ASSERT_TRUE( result.value() == "10undefined1" );
+        pool.giveBack(ctx);
+
+        dukpp03::ContextPoolMetrics metrics = pool.metrics();
+        ASSERT_TRUE( metrics.Borrows == 3 );
+        ASSERT_TRUE( metrics.Returns == 3 );
+        ASSERT_TRUE( metrics.Exhaustions == 1 );
+        ASSERT_TRUE( metrics.FullResets == 0 );
+
+        // Accessors, left by borrower, are not invoked by scrub, and saved attributes are restored
+        ctx = pool.borrow();
+        eval_result = ctx->eval(
+            "Object.defineProperty(this, 'hang', { get: function() { for(;;); }, configurable: true });"
+            "Object.defineProperty(this, 'Math', { get: function() { for(;;); }, configurable: true, enumerable: true });"
+            "base = 20;", true, &error);
+        ASSERT_TRUE( eval_result );
+        pool.giveBack(ctx);
+        ctx = pool.borrow();
+        eval_result = ctx->eval(
+            "var m = Object.getOwnPropertyDescriptor(this, 'Math');"
+            "(typeof hang) + get() + m.enumerable + m.writable + Math.abs(-1)",
+            false, &error);
+        if (!eval_result)
+        {
+            std::cout << error << "\n";
+        }
+        ASSERT_TRUE( eval_result );
+        result = dukpp03::GetValue<std::string, dukpp03::context::Context>::perform(ctx, -1);
+        ASSERT_TRUE( result.exists() );
+        ASSERT_TRUE( result.value() == "undefined10falsetrue1" );
+        pool.giveBack(ctx);
+        ASSERT_TRUE( pool.metrics().FullResets == 0 );
+
+        // Descriptors could not be read without invoking accessors of Object.prototype, so context is reset
+        ctx = pool.borrow();
+        eval_result = ctx->eval("Object.defineProperty(Object.prototype, 'get', { get: function() { for(;;); } });"
+            "Object.defineProperty(this, 'hang', { get: function() { for(;;); }, configurable: true });", true, &error);
+        ASSERT_TRUE( eval_result );
+        pool.giveBack(ctx);
+        ASSERT_TRUE( pool.metrics().FullResets == 1 );
+        ctx = pool.borrow();
+        eval_result = ctx->eval("(typeof hang) + get()", false, &error);
+        ASSERT_TRUE( eval_result );
+        result = dukpp03::GetValue<std::string, dukpp03::context::Context>::perform(ctx, -1);
+        ASSERT_TRUE( result.exists() );
+        ASSERT_TRUE( result.value() == "undefined10" );
+        pool.giveBack(ctx);
+    }
+
+    void testContextPoolRestoresState()
+    {
+        std::string error;
+        dukpp03::ContextTemplate<dukpp03::context::Context> t;
+        ClassBinding* c = new ClassBinding();
+        c->addConstructor<Point, int, int>("Point");
+        c->addMethod("x",  bnd::from(&Point::x));
+        t.addClassBinding<Point>(c);
+        dukpp03::ContextPool<dukpp03::context::Context> pool(1, &t);
+
+        dukpp03::context::Context* ctx = pool.borrow();
+        const size_t callables = ctx->ownedCallableCount();
+        const double time = ctx->maximumExecutionTime();
+        dukpp03::CancellationToken token;
+        ctx->setMaximumInstructions(dukpp03::AbstractContext::InstructionsPerCheck * 4);
+        ctx->setMaximumExecutionTime(time * 2);
+        ctx->setCancellationToken(&token);
+        // Using class bindings does not change state of context outside of heap, so context is scrubbed
+        bool eval_result = ctx->eval("new Point(1, 2).x()", true, &error);
+        if (!eval_result)
+        {
+            std::cout << error << "\n";
+        }
+        ASSERT_TRUE( eval_result );
+        pool.giveBack(ctx);
+        ASSERT_TRUE( pool.metrics().FullResets == 0 );
+        ASSERT_TRUE( ctx->maximumInstructions() == 0 );
+        ASSERT_TRUE( is_fuzzy_equal(ctx->maximumExecutionTime(), time) );
+        ASSERT_TRUE( ctx->cancellationToken() == nullptr );
+
+        // Callables, owned by context, could not be removed, so context is reset
+        ctx = pool.borrow();
+        ctx->registerCallable("code", mkf::from(character_code));
+        pool.giveBack(ctx);
+        ASSERT_TRUE( pool.metrics().FullResets == 1 );
+
+        ctx = pool.borrow();
+        ASSERT_TRUE( ctx->ownedCallableCount() == callables );
+        ASSERT_TRUE( ctx->eval("typeof code", false, &error) );
+        dukpp03::Maybe<std::string> type = dukpp03::GetValue<std::string, dukpp03::context::Context>::perform(ctx, -1);
+        ASSERT_TRUE( type.exists() );
+        ASSERT_TRUE( type.value() == "undefined" );
+        ctx->cleanStack();
+        ASSERT_TRUE( ctx->addClassBinding("Other", new ClassBinding()) );
+        pool.giveBack(ctx);
+        ASSERT_TRUE( pool.metrics().FullResets == 2 );
+
+        ctx = pool.borrow();
+        ASSERT_TRUE( ctx->getClassBinding("Other") == nullptr );
+        ASSERT_TRUE( ctx->eval("new Point(3, 4).x()", false, &error) );
+        dukpp03::Maybe<int> x = dukpp03::GetValue<int, dukpp03::context::Context>::perform(ctx, -1);
+        ASSERT_TRUE( x.exists() );
+        ASSERT_TRUE( x.value() == 3 );
+        pool.giveBack(ctx);
+        ASSERT_TRUE( pool.metrics().FullResets == 2 );
+    }
+
+    void testValue()
+    {
+        std::string error;
+        dukpp03::context::Context ctx;
+        bool eval_result = ctx.eval("({ a: [1, 'x', null, true], b: { c: 2.5 }, f: function() {} })", false, &error);
+        ASSERT_TRUE( eval_result );
+        dukpp03::Value v = dukpp03::GetValue<dukpp03::Value, dukpp03::context::Context>::perform(&ctx, -1).value();
+        ctx.cleanStack();
+        ASSERT_TRUE( v.type() == dukpp03::Value::Type::Object );
+        ASSERT_TRUE( v.size() == 3 );
+        dukpp03::Value a = v.get("a").value();
+        ASSERT_TRUE( a.size() == 4 );
+        ASSERT_TRUE( a.elements()[1].asString() == "x" );
+        ASSERT_TRUE( a.elements()[2].isNull() );
+        ASSERT_TRUE( v.get("b").value().get("c").value().asNumber() == 2.5 );
+        ASSERT_TRUE( v.get("f").value().isUndefined() );
+
+        // Value is pushed into other context unchanged
+        dukpp03::context::Context other;
+        dukpp03::PushValue<dukpp03::Value, dukpp03::context::Context>::perform(&other, v);
+        dukpp03::Value copy = dukpp03::Value::fromStack(other.context(), -1);
+        ASSERT_TRUE( copy == v );
+        other.markTopObjectAsGlobal("v");
+        eval_result = other.eval("v.a[0] + v.b.c", false, &error);
+        ASSERT_TRUE( eval_result );
+        dukpp03::Maybe<double> sum = dukpp03::GetValue<double, dukpp03::context::Context>::perform(&other, -1);
+        ASSERT_TRUE( sum.value() == 3.5 );
+    }
+
+    void testScriptExecutor()
+    {
+        std::string error;
+        dukpp03::ContextTemplate<dukpp03::context::Context> t;
+        ASSERT_TRUE( t.addScript("function add(a, b) { return a + b; }", "add.js", &error) );
+        dukpp03::ScriptExecutor<dukpp03::context::Context> executor(3, &t);
+        ASSERT_TRUE( executor.threadCount() == 3 );
+
+        std::vector< std::future<dukpp03::ScriptResult> > results;
+        for(int i = 0; i < 30; i++)
+        {
+            std::vector<dukpp03::Value> args;
+            args.push_back(dukpp03::Value(i));
+            args.push_back(dukpp03::Value(1));
+            if (i % 2)
+            {
+                results.push_back(executor.submitCall("add", args));
+            }
+            else
+            {
+                results.push_back(executor.submit("(function(a, b) { return [a, add(a, b)]; })", args));
+            }
+        }
+        for(int i = 0; i < 30; i++)
+        {
+            dukpp03::ScriptResult result = results[i].get();
+            ASSERT_TRUE( result.Success );
+            if (i % 2)
+            {
+                ASSERT_TRUE( result.Result.asNumber() == i + 1 );
+            }
+            else
+            {
+                ASSERT_TRUE( result.Result.elements()[1].asNumber() == i + 1 );
+            }
+        }
+        dukpp03::ScriptResult failure = executor.submit("throw new Error('failed')").get();
+        ASSERT_FALSE( failure.Success );
+        ASSERT_TRUE( failure.Error.find("failed") != std::string::npos );
+        failure = executor.submitCall("missing").get();
+        ASSERT_FALSE( failure.Success );
+        ASSERT_TRUE( executor.submit("6 * 7").get().Result.asNumber() == 42 );
+
+        // Reading result must not run getters or traps, which could throw outside of any protected call
+        dukpp03::ScriptResult accessors = executor.submit("({ a: 1, get x() { throw new Error('boom'); }, p: new Proxy({}, { ownKeys: function() { throw new Error('trap'); } }) })").get();
+        ASSERT_TRUE( accessors.Success );
+        ASSERT_TRUE( accessors.Result.get("a").value().asNumber() == 1 );
+        ASSERT_FALSE( accessors.Result.get("x").exists() );
+        ASSERT_TRUE( accessors.Result.get("p").exists() );
+        dukpp03::ScriptResult arrays = executor.submit("var a = [1, 2]; Object.defineProperty(a, 0, { get: function() { throw new Error('boom'); } }); a").get();
+        ASSERT_TRUE( arrays.Success );
+        ASSERT_TRUE( arrays.Result.elements()[0].isUndefined() );
+        ASSERT_TRUE( arrays.Result.elements()[1].asNumber() == 2 );
+    }
     
+    void testPoolAllocator()
+    {
+        std::string error;
+        dukpp03::PoolAllocator allocator;
+        {
+            dukpp03::context::Context ctx(&allocator);
+            ASSERT_TRUE( ctx.allocator() == &allocator );
+            ASSERT_TRUE( allocator.slabCount() != 0 );
+            bool eval_result = ctx.eval("var a = []; for(var i = 0; i < 10000; i++) { a.push({ v: i, s: 'item' + i }); } var big = new Array(100000).join('x'); a.length + big.length", false, &error);
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<int> result = dukpp03::GetValue<int, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( result.exists() );
+            ASSERT_TRUE( result.value() == 10000 + 99999 );
+            ctx.cleanStack();
+
+            ctx.reset();
+            ASSERT_TRUE( ctx.allocator() == &allocator );
+            eval_result = ctx.eval("typeof a", false, &error);
+            ASSERT_TRUE( eval_result );
+            dukpp03::Maybe<std::string> type = dukpp03::GetValue<std::string, dukpp03::context::Context>::perform(&ctx, -1);
+            ASSERT_TRUE( type.value() == "undefined" );
+        }
+        // Pool keeps slabs for reuse after heap is destroyed
+        size_t slabs = allocator.slabCount();
+        {
+            dukpp03::context::Context ctx(&allocator);
+            ASSERT_TRUE( ctx.eval("var o = { x: 1 };", true, &error) );
+        }
+        ASSERT_TRUE( allocator.slabCount() == slabs );
+    }
+
+    void testMemoryQuota()
+    {
+        std::string error;
+        dukpp03::AccountingAllocator allocator;
+        {
+            dukpp03::context::Context ctx(&allocator);
+            size_t baseline = allocator.liveBytes();
+            ASSERT_TRUE( baseline != 0 );
+            ASSERT_TRUE( allocator.liveBlocks() != 0 );
+            ASSERT_TRUE( allocator.peakBytes() >= baseline );
+
+            allocator.setHardLimit(baseline + 512 * 1024);
+            bool eval_result = ctx.eval("var a = []; for(var i = 0; i < 1000000; i++) { a.push({ v: i }); }", true, &error);
+            ASSERT_TRUE( !eval_result );
+            ASSERT_TRUE( error.find("alloc failed") != std::string::npos );
+            ASSERT_TRUE( allocator.failures() != 0 );
+            ASSERT_TRUE( allocator.peakBytes() <= baseline + 512 * 1024 );
+
+            // Context is still usable after failed allocation
+            ASSERT_TRUE( ctx.eval("a = null;", true, &error) );
+            duk_gc(ctx.context(), 0);
+            allocator.setHardLimit(0);
+            allocator.resetPeak();
+            ASSERT_TRUE( allocator.peakBytes() == allocator.liveBytes() );
+
+            // Garbage is collected, when soft limit is exceeded
+            allocator.setSoftLimit(allocator.liveBytes() + 256 * 1024);
+            eval_result = ctx.eval("for(var i = 0; i < 100000; i++) { var o = { v: i, w: [i] }; o.self = o; }", true, &error);
+            ASSERT_TRUE( eval_result );
+            ASSERT_TRUE( allocator.softCollections() != 0 );
+            ASSERT_TRUE( allocator.liveBytes() < allocator.softLimit() + 256 * 1024 );
+        }
+        ASSERT_TRUE( allocator.liveBytes() == 0 );
+        ASSERT_TRUE( allocator.liveBlocks() == 0 );
+        ASSERT_TRUE( allocator.allocations() != 0 );
+    }
+
+    void testGCScheduler()
+    {
+        dukpp03::PauseHistogram histogram;
+        histogram.add(0.5E-6);
+        histogram.add(3E-6);
+        histogram.add(100E-6);
+        ASSERT_TRUE( histogram.count() == 3 );
+        ASSERT_TRUE( histogram.bucket(0) == 1 );
+        ASSERT_TRUE( histogram.bucket(2) == 1 );
+        ASSERT_TRUE( histogram.bucket(7) == 1 );
+        ASSERT_TRUE( histogram.percentile(0.5) == dukpp03::PauseHistogram::bucketBound(2) );
+        ASSERT_TRUE( histogram.percentile(1.0) == 100E-6 );
+        ASSERT_TRUE( histogram.maximum() == 100E-6 );
+
+        std::string error;
+        dukpp03::AccountingAllocator allocator;
+        dukpp03::context::Context ctx(&allocator);
+        dukpp03::GCScheduler scheduler(&ctx, &allocator, 256 * 1024);
+        ASSERT_TRUE( !scheduler.needed() );
+        ASSERT_TRUE( !scheduler.collectIfNeeded() );
+        ASSERT_TRUE( ctx.eval("for(var i = 0; i < 10000; i++) { var o = { v: i }; o.self = o; }", true, &error) );
+        ASSERT_TRUE( scheduler.allocatedSinceCollection() >= 256 * 1024 );
+        ASSERT_TRUE( scheduler.needed() );
+        size_t live = allocator.liveBytes();
+        ASSERT_TRUE( scheduler.collectIfNeeded(true) );
+        ASSERT_TRUE( allocator.liveBytes() < live );
+        ASSERT_TRUE( !scheduler.needed() );
+        ASSERT_TRUE( scheduler.pauses().count() == 1 );
+        ASSERT_TRUE( scheduler.pauses().total() > 0 );
+
+        dukpp03::GCScheduler unconditional(&ctx);
+        ASSERT_TRUE( unconditional.collectIfNeeded() );
+        scheduler.clearPauses();
+        ASSERT_TRUE( scheduler.pauses().count() == 0 );
+    }
+
+    void testVariantPool()
+    {
+        dukpp03::context::Context ctx;
+        duk_context* c = ctx.context();
+        dukpp03::PushValue<Point, dukpp03::context::Context>::perform(&ctx, Point(1, 2));
+        dukpp03::Maybe<Point> p = dukpp03::GetValue<Point, dukpp03::context::Context>::perform(&ctx, -1);
+        ASSERT_TRUE( p.exists() );
+        ASSERT_TRUE( p.value().x() == 1 );
+        ASSERT_TRUE( p.value().y() == 2 );
+        void* first = ctx.variantFromObject(-1);
+        ctx.cleanStack();
+        duk_gc(c, 0);
+
+        // Storage of finalized variant is reused by next one
+        dukpp03::PushValue<Point, dukpp03::context::Context>::perform(&ctx, Point(3, 4));
+        ASSERT_TRUE( ctx.variantFromObject(-1) == first );
+        p = dukpp03::GetValue<Point, dukpp03::context::Context>::perform(&ctx, -1);
+        ASSERT_TRUE( p.value().x() == 3 );
+        ctx.cleanStack();
+    }
+
+    void testVariantRegistry()
+    {
+        int a = 0, b = 0;
+        dukpp03::VariantRegistry registry;
+        dukpp03::VariantRegistry::Handle ha = registry.insert(&a);
+        ASSERT_TRUE( ha != dukpp03::VariantRegistry::InvalidHandle );
+        ASSERT_TRUE( registry.find(ha) == &a );
+        ASSERT_TRUE( registry.find(dukpp03::VariantRegistry::InvalidHandle) == nullptr );
+        ASSERT_TRUE( registry.take(ha) == &a );
+        ASSERT_TRUE( registry.take(ha) == nullptr );
+        // Slot is reused, but stale handle does not match new registration
+        dukpp03::VariantRegistry::Handle hb = registry.insert(&b);
+        ASSERT_TRUE( hb != ha );
+        ASSERT_TRUE( registry.find(ha) == nullptr );
+        ASSERT_TRUE( registry.find(hb) == &b );
+        ASSERT_TRUE( registry.contains(&b) );
+        ASSERT_TRUE( !registry.contains(&a) );
+        ASSERT_TRUE( registry.size() == 1 );
+        registry.clear();
+        ASSERT_TRUE( registry.size() == 0 );
+        ASSERT_TRUE( registry.find(hb) == nullptr );
+
+        dukpp03::context::Context ctx;
+        size_t count = ctx.registeredVariantCount();
+        dukpp03::PushValue<Point, dukpp03::context::Context>::perform(&ctx, Point(1, 2));
+        ASSERT_TRUE( ctx.registeredVariantCount() == count + 1 );
+        ctx.cleanStack();
+        duk_gc(ctx.context(), 0);
+        ASSERT_TRUE( ctx.registeredVariantCount() == count );
+    }
+
+    void testVariantKey()
+    {
+        dukpp03::context::Context ctx;
+        duk_context* c = ctx.context();
+        // Handle of variant is not visible to scripts
+        dukpp03::PushValue<Point, dukpp03::context::Context>::perform(&ctx, Point(1, 2));
+        duk_put_global_string(c, "pt");
+        ASSERT_TRUE( ctx.eval("Object.getOwnPropertyNames(pt).length", false) );
+        ASSERT_TRUE( duk_get_int(c, -1) == 0 );
+        ctx.cleanStack();
+
+        // Key is interned again in new heap
+        ctx.reset();
+        dukpp03::PushValue<Point, dukpp03::context::Context>::perform(&ctx, Point(3, 4));
+        dukpp03::Maybe<Point> p = dukpp03::GetValue<Point, dukpp03::context::Context>::perform(&ctx, -1);
+        ASSERT_TRUE( p.exists() );
+        ASSERT_TRUE( p.value().x() == 3 );
+        ctx.cleanStack();
+    }
+
+    void testInternedKeys()
+    {
+        dukpp03::context::Context ctx;
+        duk_context* c = ctx.context();
+        const size_t count = ctx.keyCount();
+        dukpp03::AbstractContext::PropertyKey key = ctx.internKey("answer");
+        ASSERT_TRUE( ctx.internKey("answer") == key );
+        ASSERT_TRUE( ctx.keyCount() == count + 1 );
+
+        duk_push_object(c);
+        duk_push_int(c, 42);
+        ctx.putProperty(-2, key);
+        duk_put_global_string(c, "keyed");
+        ASSERT_TRUE( ctx.eval("keyed.answer", false) );
+        ASSERT_TRUE( duk_get_int(c, -1) == 42 );
+        ctx.cleanStack();
+
+        // Keys survive reset and are interned in new heap
+        ctx.reset();
+        c = ctx.context();
+        ASSERT_TRUE( ctx.keyCount() == count + 1 );
+        ASSERT_TRUE( ctx.eval("var keyed = { answer: 7 }; keyed", false) );
+        ASSERT_TRUE( ctx.getProperty(c, -1, key) );
+        ASSERT_TRUE( duk_get_int(c, -1) == 7 );
+        ctx.cleanStack();
+    }
+
+    void testCallableTable()
+    {
+        dukpp03::context::Context ctx;
+        const size_t size = ctx.callableTableSize();
+        MockCallable* f = new MockCallable();
+        ctx.registerCallable("f", f);
+        ctx.registerCallable("g", f);
+        ASSERT_TRUE( ctx.callableTableSize() == size + 1 );
+        // Copy of callable is not mistaken for original
+        ctx.registerCallable("h", new MockCallable(*f));
+        ASSERT_TRUE( ctx.callableTableSize() == size + 2 );
+        ASSERT_TRUE( ctx.eval("f() + g() + h()", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 3 );
+        ctx.cleanStack();
+
+        ctx.reset();
+        ASSERT_TRUE( ctx.callableTableSize() == 0 );
+        ctx.registerCallable("f", new MockCallable());
+        ASSERT_TRUE( ctx.eval("f()", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 1 );
+        ctx.cleanStack();
+
+        // Callable, shared between contexts, takes one slot in each of them
+        dukpp03::context::Context other;
+        const size_t other_size = other.callableTableSize();
+        MockCallable shared;
+        for(int i = 0; i < 100; i++)
+        {
+            ctx.registerCallable("s", &shared, false);
+            other.registerCallable("s", &shared, false);
+        }
+        ASSERT_TRUE( ctx.callableTableSize() == 2 );
+        ASSERT_TRUE( other.callableTableSize() == other_size + 1 );
+        ASSERT_TRUE( ctx.eval("s()", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 1 );
+        ctx.cleanStack();
+
+        // Forgotten callable is never called
+        ctx.forgetCallable(&shared);
+        ASSERT_TRUE( ctx.eval("var r = 0; try { s(); } catch(e) { r = 1; } r", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 1 );
+        ctx.cleanStack();
+        ctx.registerCallable("s", &shared, false);
+        ASSERT_TRUE( ctx.callableTableSize() == 3 );
+        ASSERT_TRUE( ctx.eval("s()", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 1 );
+        ctx.cleanStack();
+        other.unregisterGlobal("s");
+        other.forgetCallable(&shared);
+    }
+
+    void testStringArguments()
+    {
+        dukpp03::context::Context ctx;
+        ctx.registerCallable("length", mkf::from(string_ref_length));
+        ctx.registerCallable("code", mkf::from(character_code));
+        ASSERT_TRUE( ctx.eval("length('abc') * 100 + length('a\\u0000b') * 10 + code('a')", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 300 + 30 + 97 );
+        ctx.cleanStack();
+
+        ASSERT_TRUE( ctx.eval("var r = 0; try { code('ab'); } catch(e) { r = 1; } r", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 1 );
+        ctx.cleanStack();
+
+        duk_push_lstring(ctx.context(), "x\0y", 3);
+        dukpp03::Maybe<std::string> s = dukpp03::GetValue<std::string, dukpp03::context::Context>::perform(&ctx, -1);
+        ASSERT_TRUE( s.exists() );
+        ASSERT_TRUE( s.value() == std::string("x\0y", 3) );
+        dukpp03::Maybe<dukpp03::StringRef> ref = dukpp03::GetValue<dukpp03::StringRef, dukpp03::context::Context>::perform(&ctx, -1);
+        ASSERT_TRUE( ref.exists() );
+        ASSERT_TRUE( ref.value() == dukpp03::StringRef(s.value()) );
+        ctx.cleanStack();
+#ifdef DUKPP03_HAS_STRING_VIEW
+        ctx.registerCallable("isA", mkf::from(string_view_is_a));
+        ASSERT_TRUE( ctx.eval("isA('aaa') && !isA('aba')", false) );
+        ASSERT_TRUE( duk_get_boolean(ctx.context(), -1) != 0 );
+        ctx.cleanStack();
+#endif
+    }
+
+    void testBufferArguments()
+    {
+        dukpp03::context::Context ctx;
+        ctx.registerCallable("sum", mkf::from(sum_floats));
+        ctx.registerCallable("fill", mkf::from(fill_bytes));
+        ctx.registerCallable("integers", mkf::from(make_integers));
+        ASSERT_TRUE( ctx.eval("sum(new Float32Array([1, 2, 3.5])) + sum(new Float32Array(0))", false) );
+        ASSERT_TRUE( duk_get_number(ctx.context(), -1) == 6.5 );
+        ctx.cleanStack();
+
+        // Function changes data of script in place
+        ASSERT_TRUE( ctx.eval("var a = new ArrayBuffer(8); var v = new Uint8Array(a, 4, 2); fill(v, 7); var p = Uint8Array.allocPlain(3); fill(p, 5); "
+                              "var b = new Uint8Array(a); b[3] * 1000 + b[4] * 100 + b[5] * 10 + p[2]", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 775 );
+        ctx.cleanStack();
+
+        // Size of data must fit type of elements
+        ASSERT_TRUE( ctx.eval("var r = 0; try { sum(new Uint8Array(3)); } catch(e) { if (e instanceof TypeError) r += 1; } "
+                              "try { sum('abcd'); } catch(e) { if (e instanceof TypeError) r += 1; } r", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 2 );
+        ctx.cleanStack();
+
+        ASSERT_TRUE( ctx.eval("var i = integers(4); (i instanceof Int32Array) && i.length == 4 && i[3] == 3", false) );
+        ASSERT_TRUE( duk_get_boolean(ctx.context(), -1) != 0 );
+        ctx.cleanStack();
+
+        float copied[2] = { 1.5f, 2.0f };
+        dukpp03::PushValue<dukpp03::BufferView<float>, dukpp03::context::Context>::perform(&ctx, dukpp03::BufferView<float>(copied, 2));
+        copied[0] = 0;
+        dukpp03::Maybe<dukpp03::BufferView<float> > view = dukpp03::GetValue<dukpp03::BufferView<float>, dukpp03::context::Context>::perform(&ctx, -1);
+        ASSERT_TRUE( view.exists() );
+        ASSERT_TRUE( view.value().size() == 2 && view.value()[0] == 1.5f );
+        ctx.cleanStack();
+    }
+
+    void testExternalBuffer()
+    {
+        CountedBuffer::Deleted = 0;
+        dukpp03::context::Context ctx;
+        CountedBuffer* buffer = new CountedBuffer(16);
+        ctx.pushExternalBuffer(buffer);
+        duk_put_global_string(ctx.context(), "ext");
+        ASSERT_TRUE( ctx.eval("ext[1] = 42; ext.length", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 16 );
+        ctx.cleanStack();
+        ASSERT_TRUE( (*buffer)[1] == 42 );
+
+        // View, created from ArrayBuffer of dropped view, keeps buffer alive
+        ASSERT_TRUE( ctx.eval("var keep = new DataView(ext.buffer); ext = undefined; Duktape.gc(); Duktape.gc();", true) );
+        ASSERT_TRUE( CountedBuffer::Deleted == 0 );
+        ASSERT_TRUE( ctx.eval("keep.getUint8(1)", false) );
+        ASSERT_TRUE( duk_get_int(ctx.context(), -1) == 42 );
+        ctx.cleanStack();
+        ASSERT_TRUE( ctx.eval("keep = undefined; Duktape.gc(); Duktape.gc();", true) );
+        ASSERT_TRUE( CountedBuffer::Deleted == 1 );
+
+        ctx.pushExternalBuffer(new CountedBuffer(4), DUK_BUFOBJ_ARRAYBUFFER);
+        duk_put_global_string(ctx.context(), "ab");
+        // Buffer, finalized by script, is detached from memory
+        ASSERT_TRUE( ctx.eval("var fin = Duktape.fin(ab); fin(ab); fin(ab); var u = new Uint8Array(ab); u[0] = 5; u[0] == 0", false) );
+        ASSERT_TRUE( duk_get_boolean(ctx.context(), -1) != 0 );
+        ctx.cleanStack();
+        ASSERT_TRUE( CountedBuffer::Deleted == 2 );
+
+        // Heap deletes buffers, which are alive, when it's destroyed
+        ctx.pushExternalBuffer(new CountedBuffer(4));
+        duk_put_global_string(ctx.context(), "last");
+        ctx.reset();
+        ASSERT_TRUE( CountedBuffer::Deleted == 3 );
+    }
+
+    void testSerialization()
+    {
+        dukpp03::context::Context ctx;
+        std::string error;
+        const std::string text = "{\"a\":[1,2.5,\"x\"],\"b\":{\"c\":null,\"d\":true}}";
+        ASSERT_TRUE( ctx.decodeJSON(text.c_str(), text.size(), &error) );
+        std::vector<unsigned char> cbor;
+        ASSERT_TRUE( ctx.encodeCBOR(-1, cbor, &error) );
+        ctx.cleanStack();
+        ASSERT_TRUE( ctx.decodeCBOR(cbor.data(), cbor.size(), &error) );
+        std::string result;
+        ASSERT_TRUE( ctx.encodeJSON(-1, result, &error) );
+        ASSERT_TRUE( result == text );
+        ASSERT_TRUE( duk_get_top(ctx.context()) == 1 );
+        ctx.cleanStack();
+
+        // Malformed payloads and values without JSON representation are errors, which leave stack intact
+        ASSERT_TRUE( !ctx.decodeJSON("{\"a\":", 5, &error) );
+        ASSERT_TRUE( !error.empty() );
+        const unsigned char truncated[] = { 0x82, 0x01 };
+        ASSERT_TRUE( !ctx.decodeCBOR(truncated, 2, &error) );
+        duk_push_undefined(ctx.context());
+        ASSERT_TRUE( !ctx.encodeJSON(-1, result, &error) );
+        ASSERT_TRUE( duk_get_top(ctx.context()) == 1 );
+        ctx.cleanStack();
+
+        // Bound functions could accept and return encoded payloads
+        ctx.registerCallable("echoJSON", mkf::from(echo_json));
+        ctx.registerCallable("echoCBOR", mkf::from(echo_cbor));
+        ASSERT_TRUE( ctx.eval("var r = echoJSON({ x: [1, { y: 'z' }] }); var c = echoCBOR({ b: new Uint8Array([1, 2]) }); "
+                              "r.x[1].y == 'z' && c.b.length == 2 && c.b[1] == 2", false) );
+        ASSERT_TRUE( duk_get_boolean(ctx.context(), -1) != 0 );
+        ctx.cleanStack();
+    }
+
+    void testFieldMap()
+    {
+        dukpp03::context::Context ctx;
+        dukpp03::FieldMap<dukpp03::context::Context, PayloadHeader> header;
+        header.addField("version", &PayloadHeader::Version).addField("compressed", &PayloadHeader::Compressed);
+        dukpp03::FieldMap<dukpp03::context::Context, Payload> map;
+        map.addObject("header", &Payload::Header, header).addField("name", &Payload::Name).addField("values", &Payload::Values);
+
+        Payload p;
+        p.Header.Version = 3;
+        p.Header.Compressed = true;
+        p.Name = "event";
+        p.Values.push_back(0.5);
+        p.Values.push_back(2);
+        std::string text;
+        ASSERT_TRUE( map.encodeJSON(&ctx, p, text) );
+        ASSERT_TRUE( text == "{\"header\":{\"version\":3,\"compressed\":true},\"name\":\"event\",\"values\":[0.5,2]}" );
+
+        Payload q;
+        ASSERT_TRUE( map.decodeJSON(&ctx, "{\"name\":\"x\",\"values\":[],\"header\":{\"version\":7,\"compressed\":false},\"extra\":1}", q) );
+        ASSERT_TRUE( q.Name == "x" && q.Values.empty() && q.Header.Version == 7 && !q.Header.Compressed );
+
+        std::vector<unsigned char> cbor;
+        ASSERT_TRUE( map.encodeCBOR(&ctx, p, cbor) );
+        ASSERT_TRUE( map.decodeCBOR(&ctx, cbor.data(), cbor.size(), q) );
+        ASSERT_TRUE( q.Name == "event" && q.Values.size() == 2 && q.Values[0] == 0.5 && q.Header.Version == 3 && q.Header.Compressed );
+
+        std::string error;
+        ASSERT_TRUE( !map.decodeJSON(&ctx, "{\"name\":1,\"values\":[],\"header\":{\"version\":7,\"compressed\":false}}", q, &error) );
+        ASSERT_TRUE( !error.empty() );
+        ASSERT_TRUE( !map.decodeJSON(&ctx, "{\"name\":\"x\",\"values\":[]}", q) );
+        ASSERT_TRUE( duk_get_top(ctx.context()) == 0 );
+
+        // Map could be used as is for building objects, read by scripts
+        map.push(&ctx, p);
+        duk_put_global_string(ctx.context(), "payload");
+        ASSERT_TRUE( ctx.eval("payload.header.version + payload.values[1]", false) );
+        ASSERT_TRUE( duk_get_number(ctx.context(), -1) == 5 );
+        ctx.cleanStack();
+    }
+
+    void testFieldMapInReusedContext()
+    {
+        dukpp03::FieldMap<dukpp03::context::Context, PayloadHeader> map;
+        map.addField("version", &PayloadHeader::Version);
+        PayloadHeader h;
+        h.Version = 42;
+        // Contexts are created at the same address, so keys, cached for first one, must not be used for second one
+        alignas(dukpp03::context::Context) unsigned char storage[sizeof(dukpp03::context::Context)];
+        for(int i = 0; i < 2; i++)
+        {
+            dukpp03::context::Context* ctx = new (storage) dukpp03::context::Context();
+            if (i == 1)
+            {
+                ctx->internKey("password");
+            }
+            std::string text;
+            ASSERT_TRUE( map.encodeJSON(ctx, h, text) );
+            ASSERT_TRUE( text == "{\"version\":42}" );
+            ctx->~Context();
+        }
+    }
+
 } _context_test;
\ No newline at end of file
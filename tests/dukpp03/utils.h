@@ -6,6 +6,7 @@
 #include <boost/unordered_map.hpp>
 #include <boost/timer/timer.hpp>
 #include <typeinfo>
+#include <new>
 #include <decay.h>
 #include <iostream>
 #include "getaddressoftype.h"
@@ -32,6 +33,25 @@ public:
     {
         return new boost::any(val);
     }
+    /*! Makes variant from value in specified storage
+        \param[in] storage a storage
+        \param[in] val value
+        \return variant
+     */
+    template<
+        typename _UnderlyingValue
+    >
+    static Variant* makeAt(void* storage, _UnderlyingValue val)
+    {
+        return new (storage) boost::any(val);
+    }
+    /*! Destroys variant, made by makeAt, without freeing it's storage
+        \param[in] v variant
+     */
+    static void destroyAt(Variant* v)
+    {
+        v->~any();
+    }
     /*! Fetches underlying value from variant type
         \param[in] v a variant, containing data
         \return an underlying value
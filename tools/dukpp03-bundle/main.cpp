@@ -0,0 +1,37 @@
+/*! \file main.cpp
+    
+    A tool, which compiles scripts into bundle, which could be loaded via dukpp03::AbstractContext::loadBundle.
+    Usage: dukpp03-bundle <output> <script1.js> [script2.js ...]
+ */
+#include "bundle.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <output> <script1.js> [script2.js ...]\n";
+        return 1;
+    }
+    std::vector<dukpp03::Bundle::Source> sources;
+    for(int i = 2; i < argc; i++)
+    {
+        std::ifstream in(argv[i], std::ios::in | std::ios::binary);
+        if (!in.good())
+        {
+            std::cerr << "Cannot open file " << argv[i] << "\n";
+            return 1;
+        }
+        std::string source((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        sources.push_back(dukpp03::Bundle::Source(argv[i], source));
+    }
+    std::string error;
+    if (!dukpp03::Bundle::write(argv[1], sources, &error))
+    {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    return 0;
+}